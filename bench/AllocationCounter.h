@@ -0,0 +1,11 @@
+#ifndef ALLOCATION_COUNTER_H
+#define ALLOCATION_COUNTER_H
+
+#include <cstdint>
+
+// Number of global operator new calls made by the process so far. mot_bench
+// replaces operator new to keep this count, so allocation-free hot paths
+// (Tracker::update, decoding, NMS) can be checked by the benchmarks.
+uint64_t allocationCount();
+
+#endif // ALLOCATION_COUNTER_H
@@ -0,0 +1,168 @@
+#include "BenchHarness.h"
+#include "AllocationCounter.h"
+#include <algorithm>
+#include <ctime>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+#include <thread>
+
+void BenchState::start() {
+    pausedNs = 0.0;
+    pausedAllocations = 0;
+    startAllocations = allocationCount();
+    startTime = Clock::now();
+}
+
+void BenchState::pause() {
+    pauseTime = Clock::now();
+    pauseAllocations = allocationCount();
+}
+
+void BenchState::resume() {
+    pausedAllocations += allocationCount() - pauseAllocations;
+    pausedNs += std::chrono::duration<double, std::nano>(Clock::now() - pauseTime).count();
+}
+
+void BenchState::finish(double& elapsedNs, uint64_t& allocations) {
+    Clock::time_point end = Clock::now();
+    allocations = allocationCount() - startAllocations - pausedAllocations;
+    elapsedNs = std::chrono::duration<double, std::nano>(end - startTime).count() - pausedNs;
+}
+
+static std::string formatValue(double value) {
+    std::ostringstream ss;
+    ss << value;
+    return ss.str();
+}
+
+std::string BenchResult::label() const {
+    std::string text = name;
+    for (const auto& param : params) {
+        text += "/" + param.first + ":" + formatValue(param.second);
+    }
+    return text;
+}
+
+bool BenchHarness::enabled(const std::string& name, const Params& params) const {
+    if (options.filter.empty()) {
+        return true;
+    }
+    BenchResult probe;
+    probe.name = name;
+    probe.params = params;
+    return probe.label().find(options.filter) != std::string::npos;
+}
+
+void BenchHarness::run(const std::string& name, const Params& params, double itemsPerOp,
+                       const Body& body) {
+    if (!enabled(name, params)) {
+        return;
+    }
+
+    BenchResult result;
+    result.name = name;
+    result.params = params;
+    result.itemsPerOp = itemsPerOp;
+    result.repetitions = std::max(1, options.repetitions);
+
+    // Calibrate: grow the iteration count until one repetition is long enough
+    const double targetNs = options.minTimeMs * 1e6 / result.repetitions;
+    int64_t iterations = 1;
+    double elapsedNs = 0.0;
+    uint64_t allocations = 0;
+    while (true) {
+        BenchState state(iterations);
+        state.start();
+        body(state);
+        state.finish(elapsedNs, allocations);
+        if (elapsedNs >= targetNs || iterations >= (int64_t(1) << 40)) {
+            break;
+        }
+        double grow = elapsedNs > 0.0 ? 1.4 * targetNs / elapsedNs : 10.0;
+        iterations = std::max(iterations + 1,
+                              static_cast<int64_t>(iterations * std::min(grow, 10.0)));
+    }
+    result.iterations = iterations;
+
+    std::vector<double> perOpNs;
+    uint64_t totalAllocations = 0;
+    for (int r = 0; r < result.repetitions; ++r) {
+        BenchState state(iterations);
+        state.start();
+        body(state);
+        state.finish(elapsedNs, allocations);
+        perOpNs.push_back(elapsedNs / iterations);
+        totalAllocations += allocations;
+    }
+
+    std::sort(perOpNs.begin(), perOpNs.end());
+    double sum = 0.0;
+    for (double ns : perOpNs) {
+        sum += ns;
+    }
+    size_t mid = perOpNs.size() / 2;
+    result.meanNs = sum / perOpNs.size();
+    result.medianNs = perOpNs.size() % 2 ? perOpNs[mid] : 0.5 * (perOpNs[mid - 1] + perOpNs[mid]);
+    result.minNs = perOpNs.front();
+    result.maxNs = perOpNs.back();
+    result.allocationsPerOp = static_cast<double>(totalAllocations) /
+                              (static_cast<double>(iterations) * result.repetitions);
+
+    std::cerr << std::left << std::setw(56) << result.label() << std::right
+              << std::setw(14) << std::fixed << std::setprecision(1) << result.medianNs << " ns/op"
+              << std::setw(10) << std::setprecision(2) << result.allocationsPerOp << " allocs/op"
+              << std::defaultfloat << std::endl;
+
+    results.push_back(result);
+}
+
+static std::string jsonString(const std::string& text) {
+    std::string quoted = "\"";
+    for (char c : text) {
+        if (c == '"' || c == '\\') {
+            quoted += '\\';
+        }
+        quoted += c;
+    }
+    return quoted + "\"";
+}
+
+void BenchHarness::writeJson(std::ostream& out) const {
+    char date[32];
+    std::time_t now = std::time(nullptr);
+    std::strftime(date, sizeof(date), "%Y-%m-%dT%H:%M:%SZ", std::gmtime(&now));
+
+    out << std::setprecision(9);
+    out << "{\n  \"context\": {\n";
+    out << "    \"date\": " << jsonString(date) << ",\n";
+#if defined(__VERSION__)
+    out << "    \"compiler\": " << jsonString(__VERSION__) << ",\n";
+#endif
+#ifdef NDEBUG
+    out << "    \"build_type\": \"release\",\n";
+#else
+    out << "    \"build_type\": \"debug\",\n";
+#endif
+    out << "    \"hardware_threads\": " << std::thread::hardware_concurrency() << ",\n";
+    out << "    \"min_time_ms\": " << options.minTimeMs << ",\n";
+    out << "    \"repetitions\": " << options.repetitions << "\n  },\n";
+
+    out << "  \"benchmarks\": [";
+    for (size_t i = 0; i < results.size(); ++i) {
+        const BenchResult& r = results[i];
+        out << (i ? ",\n" : "\n") << "    {\"name\": " << jsonString(r.name)
+            << ", \"label\": " << jsonString(r.label()) << ", \"params\": {";
+        for (size_t k = 0; k < r.params.size(); ++k) {
+            out << (k ? ", " : "") << jsonString(r.params[k].first) << ": " << r.params[k].second;
+        }
+        out << "}, \"iterations\": " << r.iterations
+            << ", \"repetitions\": " << r.repetitions
+            << ", \"ns_per_op\": {\"mean\": " << r.meanNs << ", \"median\": " << r.medianNs
+            << ", \"min\": " << r.minNs << ", \"max\": " << r.maxNs << "}"
+            << ", \"items_per_op\": " << r.itemsPerOp
+            << ", \"items_per_second\": " << (r.medianNs > 0.0 ? r.itemsPerOp * 1e9 / r.medianNs : 0.0)
+            << ", \"allocations_per_op\": " << r.allocationsPerOp << "}";
+    }
+    out << "\n  ]\n}\n";
+}
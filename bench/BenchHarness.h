@@ -0,0 +1,91 @@
+#ifndef BENCH_HARNESS_H
+#define BENCH_HARNESS_H
+
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <ostream>
+#include <string>
+#include <utility>
+#include <vector>
+
+// Minimal micro-benchmark runner for mot_bench.
+//
+// A benchmark body runs its operation state.iterations() times. The harness
+// first grows the iteration count until one run takes minTimeMs /
+// repetitions, then times `repetitions` runs of that size and reports the
+// per-operation mean, median, min and max over the runs. Work that must not
+// be measured (regenerating inputs, rebuilding a tracker) goes between
+// state.pause() and state.resume(); heap allocations are not counted there
+// either.
+class BenchState {
+public:
+    explicit BenchState(int64_t iterations) : count(iterations) {}
+
+    int64_t iterations() const { return count; }
+
+    void pause();
+    void resume();
+
+private:
+    friend class BenchHarness;
+    using Clock = std::chrono::steady_clock;
+
+    int64_t count;
+    Clock::time_point startTime;
+    Clock::time_point pauseTime;
+    uint64_t startAllocations = 0;
+    uint64_t pauseAllocations = 0;
+    double pausedNs = 0.0;
+    uint64_t pausedAllocations = 0;
+
+    void start();
+
+    // Measured time and allocations since start(), excluding pauses
+    void finish(double& elapsedNs, uint64_t& allocations);
+};
+
+struct BenchResult {
+    std::string name;
+    std::vector<std::pair<std::string, double>> params;
+    int64_t iterations = 0;         // per repetition
+    int repetitions = 0;
+    double meanNs = 0.0;            // per operation
+    double medianNs = 0.0;
+    double minNs = 0.0;
+    double maxNs = 0.0;
+    double allocationsPerOp = 0.0;
+    double itemsPerOp = 1.0;        // e.g. detections or filters per operation
+
+    std::string label() const;      // "name/key:value/..."
+};
+
+class BenchHarness {
+public:
+    using Params = std::vector<std::pair<std::string, double>>;
+    using Body = std::function<void(BenchState&)>;
+
+    struct Options {
+        std::string filter;           // substring of the label; empty = all
+        double minTimeMs = 200.0;     // total measured time per benchmark
+        int repetitions = 5;
+    };
+
+    explicit BenchHarness(const Options& options) : options(options) {}
+
+    // False if the filter excludes the benchmark; callers can skip setup
+    bool enabled(const std::string& name, const Params& params) const;
+
+    void run(const std::string& name, const Params& params, double itemsPerOp, const Body& body);
+
+    const std::vector<BenchResult>& getResults() const { return results; }
+
+    // One JSON document: {"context": {...}, "benchmarks": [...]}
+    void writeJson(std::ostream& out) const;
+
+private:
+    Options options;
+    std::vector<BenchResult> results;
+};
+
+#endif // BENCH_HARNESS_H
@@ -0,0 +1,88 @@
+#include "SyntheticScene.h"
+#include <algorithm>
+#include <cmath>
+
+// Canvas area per object (~one 1080p frame per 50 objects)
+static const double AREA_PER_OBJECT = 1920.0 * 1080.0 / 50.0;
+
+SyntheticScene::SyntheticScene(const Options& options)
+    : options(options), rng(options.seed) {
+    int count = std::max(0, options.objects);
+    double area = std::max(1.0, count * AREA_PER_OBJECT);
+    int width = std::max(640, static_cast<int>(std::sqrt(area * 16.0 / 9.0)));
+    int height = std::max(360, static_cast<int>(area / width));
+    canvas = cv::Size(width, height);
+
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_int_distribution<int> size(30, 90);
+    std::uniform_int_distribution<int> classId(0, std::max(1, options.classes) - 1);
+    objects.resize(count);
+    for (Object& object : objects) {
+        object.width = size(rng);
+        object.height = size(rng) + object.width / 2;
+        object.x = unit(rng) * (width - object.width);
+        object.y = unit(rng) * (height - object.height);
+        float angle = unit(rng) * 6.2831853f;
+        object.vx = options.speed * std::cos(angle);
+        object.vy = options.speed * std::sin(angle);
+        object.classId = classId(rng);
+        object.occludedFor = 0;
+    }
+}
+
+void SyntheticScene::next(std::vector<Detection>& detections) {
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::normal_distribution<float> noise(0.0f, std::max(options.jitter, 1e-6f));
+    detections.clear();
+
+    for (Object& object : objects) {
+        if (options.motion == Motion::RandomWalk) {
+            object.vx += 0.2f * options.speed * (unit(rng) - 0.5f);
+            object.vy += 0.2f * options.speed * (unit(rng) - 0.5f);
+            float speed = std::sqrt(object.vx * object.vx + object.vy * object.vy);
+            if (speed > 2.0f * options.speed && speed > 0.0f) {
+                object.vx *= 2.0f * options.speed / speed;
+                object.vy *= 2.0f * options.speed / speed;
+            }
+        }
+        object.x += object.vx;
+        object.y += object.vy;
+        if (object.x < 0.0f || object.x > canvas.width - object.width) {
+            object.vx = -object.vx;
+            object.x = std::min(std::max(object.x, 0.0f), static_cast<float>(canvas.width - object.width));
+        }
+        if (object.y < 0.0f || object.y > canvas.height - object.height) {
+            object.vy = -object.vy;
+            object.y = std::min(std::max(object.y, 0.0f), static_cast<float>(canvas.height - object.height));
+        }
+
+        if (object.occludedFor > 0) {
+            object.occludedFor--;
+            continue;
+        }
+        if (options.occlusion > 0.0f && unit(rng) < options.occlusion) {
+            object.occludedFor = options.occlusionFrames;
+            continue;
+        }
+
+        cv::Rect box(static_cast<int>(object.x + noise(rng)), static_cast<int>(object.y + noise(rng)),
+                     object.width, object.height);
+        detections.emplace_back(box, 0.5f + 0.5f * unit(rng), object.classId);
+    }
+
+    int clutter = static_cast<int>(options.clutter * objects.size() + unit(rng));
+    std::uniform_int_distribution<int> classId(0, std::max(1, options.classes) - 1);
+    for (int i = 0; i < clutter; ++i) {
+        cv::Rect box(static_cast<int>(unit(rng) * canvas.width), static_cast<int>(unit(rng) * canvas.height),
+                     40, 60);
+        detections.emplace_back(box, 0.5f * unit(rng) + 0.5f, classId(rng));
+    }
+}
+
+std::vector<std::vector<Detection>> SyntheticScene::generate(int frames) {
+    std::vector<std::vector<Detection>> sequence(std::max(0, frames));
+    for (auto& detections : sequence) {
+        next(detections);
+    }
+    return sequence;
+}
@@ -0,0 +1,56 @@
+#ifndef SYNTHETIC_SCENE_H
+#define SYNTHETIC_SCENE_H
+
+#include <opencv2/opencv.hpp>
+#include <random>
+#include <vector>
+#include "Detection.h"
+
+// Deterministic detection stream for benchmarking the tracker without a
+// model or video. Objects move inside a canvas sized to keep the density
+// (and so the amount of overlap) the same for any object count; detections
+// are the true boxes plus jitter, minus occluded objects, plus clutter.
+class SyntheticScene {
+public:
+    enum class Motion {
+        Linear,        // constant velocity, bouncing off the borders
+        RandomWalk     // velocity changes a little every frame
+    };
+
+    struct Options {
+        int objects = 100;
+        Motion motion = Motion::Linear;
+        float speed = 4.0f;             // pixels per frame
+        float jitter = 1.0f;            // detection noise, pixels
+        float occlusion = 0.0f;         // chance per frame that an object starts an occlusion
+        int occlusionFrames = 10;       // length of an occlusion
+        float clutter = 0.0f;           // false positives per frame, as a fraction of objects
+        int classes = 1;
+        unsigned seed = 1;
+    };
+
+    explicit SyntheticScene(const Options& options);
+
+    // Detections of the next frame (reuses the vector's storage)
+    void next(std::vector<Detection>& detections);
+
+    // Pre-generates frames
+    std::vector<std::vector<Detection>> generate(int frames);
+
+    cv::Size getCanvasSize() const { return canvas; }
+
+private:
+    struct Object {
+        float x, y, vx, vy;
+        int width, height;
+        int classId;
+        int occludedFor;
+    };
+
+    Options options;
+    cv::Size canvas;
+    std::vector<Object> objects;
+    std::mt19937 rng;
+};
+
+#endif // SYNTHETIC_SCENE_H
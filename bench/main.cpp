@@ -0,0 +1,912 @@
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <cmath>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <limits>
+#include <memory>
+#include <random>
+#include <sstream>
+#include <string>
+#include <vector>
+#include "AllocationCounter.h"
+#include "BenchHarness.h"
+#include "SyntheticScene.h"
+#include "Tracker.h"
+#include "HungarianAlgorithm.h"
+#include "KalmanFilter.h"
+#include "SparseAssociator.h"
+#include "NonMaxSuppressor.h"
+#include "YOLODetector.h"
+#include "Metrics.h"
+
+// Frames in a pre-generated tracker sequence, and frames run before timing
+// so the tracker has reached its steady-state track count
+static const int SEQUENCE_FRAMES = 300;
+static const int WARMUP_FRAMES = 30;
+
+// YOLOv4-tiny output heads for a 416x416 input: 13x13 and 26x26 cells, 3
+// anchors each, 80 COCO classes
+static const int TINY_HEAD_ROWS[] = {13 * 13 * 3, 26 * 26 * 3};
+static const int COCO_CLASSES = 80;
+
+// Tracker scenes: linear motion, and a random walk with occlusions and clutter
+struct Scenario {
+    SyntheticScene::Motion motion;
+    float occlusion;
+    float clutter;
+};
+static const Scenario TRACKER_SCENARIOS[] = {
+    {SyntheticScene::Motion::Linear, 0.0f, 0.0f},
+    {SyntheticScene::Motion::RandomWalk, 0.02f, 0.05f},
+};
+
+struct BenchConfig {
+    int maxObjects = 5000;
+    int maxAssignment = 1000;
+    std::string classesPath = "models/coco.names";
+    std::string tensorsPath;     // recorded detector outputs (optional)
+    std::string modelPath;       // network for detector/forward (optional)
+    std::string modelConfigPath; // Darknet .cfg, if the model needs one
+    std::vector<std::string> backends = {"opencv"};
+    std::vector<int> intraOpThreads = {1};
+    int interOpThreads = 1;
+};
+
+static std::vector<std::string> splitList(const std::string& text) {
+    std::vector<std::string> items;
+    std::stringstream stream(text);
+    std::string item;
+    while (std::getline(stream, item, ',')) {
+        if (!item.empty()) {
+            items.push_back(item);
+        }
+    }
+    return items;
+}
+
+static std::vector<int> objectCounts(int maxObjects) {
+    std::vector<int> counts;
+    for (int n : {10, 100, 500, 1000, 2000, 5000}) {
+        if (n <= maxObjects) {
+            counts.push_back(n);
+        }
+    }
+    return counts;
+}
+
+static BenchHarness::Params scenarioParams(int objects, const Scenario& scenario) {
+    return {{"objects", objects},
+            {"random_walk", scenario.motion == SyntheticScene::Motion::RandomWalk ? 1 : 0},
+            {"occlusion", scenario.occlusion},
+            {"clutter", scenario.clutter}};
+}
+
+static std::vector<std::vector<Detection>> scenarioFrames(int objects, const Scenario& scenario) {
+    SyntheticScene::Options options;
+    options.objects = objects;
+    options.motion = scenario.motion;
+    options.occlusion = scenario.occlusion;
+    options.clutter = scenario.clutter;
+    SyntheticScene scene(options);
+    return scene.generate(SEQUENCE_FRAMES);
+}
+
+static void benchTracker(BenchHarness& harness, const BenchConfig& config) {
+    for (int objects : objectCounts(config.maxObjects)) {
+        for (const Scenario& scenario : TRACKER_SCENARIOS) {
+            BenchHarness::Params params = scenarioParams(objects, scenario);
+            if (!harness.enabled("tracker/update", params)) {
+                continue;
+            }
+            const std::vector<std::vector<Detection>> frames = scenarioFrames(objects, scenario);
+
+            // One operation = one Tracker::update on the next frame. When the
+            // sequence runs out the tracker is rebuilt and warmed up untimed.
+            harness.run("tracker/update", params, objects, [&](BenchState& state) {
+                std::unique_ptr<Tracker> tracker;
+                size_t frame = frames.size();
+                for (int64_t i = 0; i < state.iterations(); ++i) {
+                    if (frame == frames.size()) {
+                        state.pause();
+                        tracker.reset(new Tracker());
+                        for (frame = 0; frame < WARMUP_FRAMES; ++frame) {
+                            tracker->update(frames[frame]);
+                        }
+                        state.resume();
+                    }
+                    tracker->update(frames[frame++]);
+                }
+            });
+        }
+
+        // Detector-free frames: Kalman propagation only
+        BenchHarness::Params params = {{"objects", objects}};
+        if (harness.enabled("tracker/propagate", params)) {
+            SyntheticScene::Options options;
+            options.objects = objects;
+            SyntheticScene scene(options);
+            const std::vector<std::vector<Detection>> frames = scene.generate(WARMUP_FRAMES);
+
+            harness.run("tracker/propagate", params, objects, [&](BenchState& state) {
+                state.pause();
+                Tracker tracker;
+                for (const auto& detections : frames) {
+                    tracker.update(detections);
+                }
+                state.resume();
+                for (int64_t i = 0; i < state.iterations(); ++i) {
+                    tracker.propagate();
+                }
+            });
+        }
+    }
+}
+
+static void benchHungarian(BenchHarness& harness, const BenchConfig& config) {
+    for (int n : {10, 50, 100, 250, 500, 1000}) {
+        if (n > config.maxAssignment) {
+            continue;
+        }
+        for (int warm = 0; warm <= 1; ++warm) {
+            BenchHarness::Params params = {{"n", n}, {"warm", warm}};
+            if (!harness.enabled("hungarian/solve", params)) {
+                continue;
+            }
+
+            // Two slightly different random matrices: warm starts alternate
+            // between them like consecutive frames
+            std::mt19937 rng(n);
+            std::uniform_real_distribution<float> uniform(0.0f, 1.0f);
+            std::normal_distribution<float> noise(0.0f, 0.02f);
+            std::vector<float> costs[2];
+            costs[0].resize(static_cast<size_t>(n) * n);
+            costs[1].resize(costs[0].size());
+            for (size_t k = 0; k < costs[0].size(); ++k) {
+                costs[0][k] = uniform(rng);
+                costs[1][k] = std::max(0.0f, costs[0][k] + noise(rng));
+            }
+
+            HungarianAlgorithm solver;
+            std::vector<int> assignment(n, -1);
+            std::vector<float> duals(n, 0.0f);
+            solver.solve(costs[0].data(), n, n, assignment.data(), duals.data());
+
+            harness.run("hungarian/solve", params, 1, [&](BenchState& state) {
+                for (int64_t i = 0; i < state.iterations(); ++i) {
+                    solver.solve(costs[(i + 1) & 1].data(), n, n, assignment.data(), duals.data(),
+                                 warm != 0);
+                }
+            });
+        }
+    }
+}
+
+template <typename Filter>
+static void benchKalmanBatch(BenchHarness& harness, const std::string& model, int count) {
+    std::vector<float> means(static_cast<size_t>(count) * Filter::MEAN_SIZE);
+    std::vector<float> covs(static_cast<size_t>(count) * Filter::COV_SIZE);
+    std::vector<float> measurements(static_cast<size_t>(count) * 4);
+    std::vector<int> slots(count);
+    for (int i = 0; i < count; ++i) {
+        Filter::bboxToMeasurement(cv::Rect(10 * (i % 100), 10 * (i / 100), 40, 80),
+                                  measurements.data() + 4 * i);
+        slots[i] = i;
+    }
+    auto reset = [&]() {
+        for (int i = 0; i < count; ++i) {
+            Filter::initState(means.data() + i * Filter::MEAN_SIZE,
+                              covs.data() + i * Filter::COV_SIZE, measurements.data() + 4 * i);
+        }
+    };
+
+    BenchHarness::Params params = {{"filters", count}};
+    harness.run("kalman/" + model + "/predict_batch", params, count, [&](BenchState& state) {
+        state.pause();
+        reset();
+        state.resume();
+        for (int64_t i = 0; i < state.iterations(); ++i) {
+            Filter::predictBatch(means.data(), covs.data(), count, 1e-2f);
+        }
+    });
+    harness.run("kalman/" + model + "/update_batch", params, count, [&](BenchState& state) {
+        state.pause();
+        reset();
+        state.resume();
+        for (int64_t i = 0; i < state.iterations(); ++i) {
+            Filter::updateBatch(means.data(), covs.data(), slots.data(), measurements.data(),
+                                count, 1e-1f);
+        }
+    });
+}
+
+static void benchKalman(BenchHarness& harness, const BenchConfig& config) {
+    for (int count : {100, 1000, 5000}) {
+        if (count > config.maxObjects) {
+            continue;
+        }
+        benchKalmanBatch<KalmanFilter>(harness, "cv", count);
+        benchKalmanBatch<ConstantAccelerationKalmanFilter>(harness, "ca", count);
+    }
+
+    // Object-per-track interface: predict + update of one filter
+    const int count = 1000;
+    std::vector<KalmanFilter> filters(count);
+    std::vector<cv::Rect> boxes(count);
+    for (int i = 0; i < count; ++i) {
+        boxes[i] = cv::Rect(10 * (i % 100), 10 * (i / 100), 40, 80);
+        filters[i].init(boxes[i]);
+    }
+    harness.run("kalman/cv/predict_update", {{"filters", count}}, count, [&](BenchState& state) {
+        for (int64_t i = 0; i < state.iterations(); ++i) {
+            for (int k = 0; k < count; ++k) {
+                filters[k].predict();
+                filters[k].update(boxes[k]);
+            }
+        }
+    });
+}
+
+static void benchAssociation(BenchHarness& harness, const BenchConfig& config) {
+    for (int objects : objectCounts(config.maxObjects)) {
+        SyntheticScene::Options options;
+        options.objects = objects;
+        SyntheticScene scene(options);
+        std::vector<std::vector<Detection>> frames = scene.generate(2);
+
+        // Tracks sit on frame 0, detections come from frame 1
+        const std::vector<Detection>& detections = frames[1];
+        std::vector<cv::Rect> trackBoxes;
+        std::vector<int> trackClassIds;
+        for (const Detection& detection : frames[0]) {
+            trackBoxes.push_back(detection.bbox);
+            trackClassIds.push_back(detection.classId);
+        }
+        const int numTracks = static_cast<int>(trackBoxes.size());
+        const int numDetections = static_cast<int>(detections.size());
+
+        // Full IoU cost matrix, as built by the original dense tracker
+        if (objects <= 2000) {
+            std::vector<float> cost(static_cast<size_t>(numTracks) * numDetections);
+            harness.run("association/dense_cost_matrix", {{"objects", objects}},
+                        static_cast<double>(numTracks) * numDetections, [&](BenchState& state) {
+                for (int64_t i = 0; i < state.iterations(); ++i) {
+                    float* row = cost.data();
+                    for (int t = 0; t < numTracks; ++t, row += numDetections) {
+                        for (int d = 0; d < numDetections; ++d) {
+                            row[d] = 1.0f - SparseAssociator::calculateIoU(trackBoxes[t],
+                                                                           detections[d].bbox);
+                        }
+                    }
+                }
+            });
+        }
+
+        SparseAssociator associator;
+        std::vector<SparseAssociator::Candidate> candidates;
+        harness.run("association/gating", {{"objects", objects}}, numTracks, [&](BenchState& state) {
+            for (int64_t i = 0; i < state.iterations(); ++i) {
+                associator.findCandidates(trackBoxes.data(), trackClassIds.data(), numTracks,
+                                          detections, 0.7f, candidates);
+            }
+        });
+
+        std::vector<float> duals(numTracks, 0.0f);
+        std::vector<int> matchedTracks, matchedDetections, unmatchedTracks, unmatchedDetections;
+        harness.run("association/associate", {{"objects", objects}}, numTracks, [&](BenchState& state) {
+            for (int64_t i = 0; i < state.iterations(); ++i) {
+                associator.associate(trackBoxes.data(), trackClassIds.data(), numTracks,
+                                     duals.data(), detections, 0.7f,
+                                     matchedTracks, matchedDetections,
+                                     unmatchedTracks, unmatchedDetections);
+            }
+        });
+
+        // Cold vs. warm solves over a moving scene. Tracks sit on frame t in
+        // a fixed order, so their duals carry over; detections come from
+        // frame t + 1 shuffled, as NMS order is not stable between frames.
+        const std::vector<std::vector<Detection>> sequence = scene.generate(SEQUENCE_FRAMES);
+        std::vector<std::vector<cv::Rect>> sequenceBoxes(sequence.size());
+        std::vector<std::vector<int>> sequenceClassIds(sequence.size());
+        std::vector<std::vector<Detection>> shuffled(sequence);
+        std::mt19937 rng(objects);
+        size_t maxTracks = 0;
+        for (size_t f = 0; f < sequence.size(); ++f) {
+            maxTracks = std::max(maxTracks, sequence[f].size());
+            for (const Detection& detection : sequence[f]) {
+                sequenceBoxes[f].push_back(detection.bbox);
+                sequenceClassIds[f].push_back(detection.classId);
+            }
+            std::shuffle(shuffled[f].begin(), shuffled[f].end(), rng);
+        }
+        for (int warm = 0; warm <= 1; ++warm) {
+            std::vector<float> sequenceDuals(maxTracks, 0.0f);
+            size_t frame = 0;
+            harness.run("association/sequence", {{"objects", objects}, {"warm", warm}}, objects,
+                        [&](BenchState& state) {
+                for (int64_t i = 0; i < state.iterations(); ++i) {
+                    size_t nextFrame = (frame + 1) % sequence.size();
+                    associator.associate(sequenceBoxes[frame].data(), sequenceClassIds[frame].data(),
+                                         static_cast<int>(sequenceBoxes[frame].size()),
+                                         warm ? sequenceDuals.data() : nullptr, shuffled[nextFrame],
+                                         0.7f, matchedTracks, matchedDetections,
+                                         unmatchedTracks, unmatchedDetections);
+                    frame = nextFrame;
+                }
+            });
+        }
+    }
+}
+
+// NMS candidates clustered around objects, like raw detector output
+static void nmsCandidates(int count, std::vector<cv::Rect>& boxes, std::vector<float>& scores,
+                          std::vector<int>& classIds) {
+    std::mt19937 rng(count);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    const int objects = std::max(1, count / 20);
+    for (int i = 0; i < count; ++i) {
+        int object = i % objects;
+        int x = (object * 97) % 1800;
+        int y = (object * 61) % 1000;
+        boxes.emplace_back(x + static_cast<int>(8 * unit(rng)), y + static_cast<int>(8 * unit(rng)),
+                           40 + static_cast<int>(10 * unit(rng)), 80 + static_cast<int>(10 * unit(rng)));
+        scores.push_back(0.5f + 0.5f * unit(rng));
+        classIds.push_back(object % 4);
+    }
+}
+
+static void benchNms(BenchHarness& harness) {
+    for (int count : {1000, 20000}) {
+        std::vector<cv::Rect> boxes;
+        std::vector<float> scores;
+        std::vector<int> classIds;
+        nmsCandidates(count, boxes, scores, classIds);
+
+        for (int grid = 0; grid <= 1; ++grid) {
+            NonMaxSuppressor::Options options;
+            options.useGrid = grid != 0;
+            NonMaxSuppressor nms(options);
+            std::vector<int> keep;
+            harness.run("nms/run", {{"candidates", count}, {"grid", grid}}, count,
+                        [&](BenchState& state) {
+                for (int64_t i = 0; i < state.iterations(); ++i) {
+                    nms.run(boxes.data(), scores.data(), classIds.data(), count, 0.5f, 0.4f, keep);
+                }
+            });
+        }
+    }
+}
+
+// Cost of one stage timer, with metrics off (the default) and on
+static void benchMetrics(BenchHarness& harness) {
+    for (int enabled = 0; enabled <= 1; ++enabled) {
+        Metrics::global().setEnabled(enabled != 0);
+        harness.run("metrics/scoped_timer", {{"enabled", enabled}}, 1, [&](BenchState& state) {
+            for (int64_t i = 0; i < state.iterations(); ++i) {
+                ScopedTimer timer(Metrics::Stage::Predict);
+            }
+        });
+    }
+    Metrics::global().setEnabled(false);
+}
+
+// Random YOLOv4-tiny style outputs: a fraction of the rows carries an object
+static std::vector<cv::Mat> syntheticOutputs(float objectRate, unsigned seed) {
+    std::mt19937 rng(seed);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    std::uniform_int_distribution<int> classId(0, COCO_CLASSES - 1);
+    std::vector<cv::Mat> outputs;
+    for (int rows : TINY_HEAD_ROWS) {
+        cv::Mat out(rows, 5 + COCO_CLASSES, CV_32F);
+        for (int r = 0; r < rows; ++r) {
+            float* row = out.ptr<float>(r);
+            row[0] = unit(rng);
+            row[1] = unit(rng);
+            row[2] = 0.05f + 0.2f * unit(rng);
+            row[3] = 0.05f + 0.3f * unit(rng);
+            bool object = unit(rng) < objectRate;
+            row[4] = object ? 0.6f + 0.4f * unit(rng) : 0.3f * unit(rng);
+            for (int c = 0; c < COCO_CLASSES; ++c) {
+                row[5 + c] = row[4] * 0.1f * unit(rng);
+            }
+            if (object) {
+                row[5 + classId(rng)] = row[4] * (0.8f + 0.2f * unit(rng));
+            }
+        }
+        outputs.push_back(out);
+    }
+    return outputs;
+}
+
+static bool loadOutputs(const std::string& path, std::vector<cv::Mat>& outputs, cv::Size& frameSize) {
+    cv::FileStorage fs(path, cv::FileStorage::READ);
+    if (!fs.isOpened()) {
+        std::cerr << "Error: Could not open tensor file: " << path << std::endl;
+        return false;
+    }
+    fs["frame_width"] >> frameSize.width;
+    fs["frame_height"] >> frameSize.height;
+    cv::FileNode node = fs["outputs"];
+    for (cv::FileNodeIterator it = node.begin(); it != node.end(); ++it) {
+        cv::Mat out;
+        (*it) >> out;
+        outputs.push_back(out);
+    }
+    return !outputs.empty() && frameSize.area() > 0;
+}
+
+static void benchDetectorDecode(BenchHarness& harness, const BenchConfig& config) {
+    if (!harness.enabled("detector/decode", {}) && !harness.enabled("detector/decode_recorded", {})) {
+        return;
+    }
+    YOLODetector detector(config.classesPath);
+
+    if (!config.tensorsPath.empty()) {
+        std::vector<cv::Mat> outputs;
+        cv::Size frameSize;
+        if (loadOutputs(config.tensorsPath, outputs, frameSize)) {
+            std::vector<Detection> detections;
+            harness.run("detector/decode_recorded", {}, 1, [&](BenchState& state) {
+                for (int64_t i = 0; i < state.iterations(); ++i) {
+                    detector.decode(outputs, frameSize, 0.5f, 0.4f, detections);
+                }
+            });
+        }
+    }
+
+    for (float rate : {0.01f, 0.1f}) {
+        if (!harness.enabled("detector/decode", {{"object_rate", rate}})) {
+            continue;
+        }
+        std::vector<cv::Mat> outputs = syntheticOutputs(rate, 7);
+        std::vector<Detection> detections;
+        harness.run("detector/decode", {{"object_rate", rate}}, 1, [&](BenchState& state) {
+            for (int64_t i = 0; i < state.iterations(); ++i) {
+                detector.decode(outputs, cv::Size(1920, 1080), 0.5f, 0.4f, detections);
+            }
+        });
+    }
+}
+
+// Optimal total of a rows x cols assignment by exhaustive search. Every row
+// is assigned unless there are more rows than columns.
+static float bruteForceAssignment(const float* cost, int rows, int cols, int row,
+                                  int unassignedLeft, std::vector<char>& used) {
+    if (row == rows) {
+        return 0.0f;
+    }
+    float best = std::numeric_limits<float>::max();
+    for (int j = 0; j < cols; ++j) {
+        if (!used[j]) {
+            used[j] = 1;
+            best = std::min(best, cost[row * cols + j] +
+                                      bruteForceAssignment(cost, rows, cols, row + 1, unassignedLeft, used));
+            used[j] = 0;
+        }
+    }
+    if (unassignedLeft > 0) {
+        best = std::min(best, bruteForceAssignment(cost, rows, cols, row + 1, unassignedLeft - 1, used));
+    }
+    return best;
+}
+
+// The JV solver against brute force on small random rectangular problems:
+// cold starts, arbitrary warm starts, and a long run of warm starts where
+// rows keep their duals across frames with a changing set of partners, as
+// tracks do. Returns false on a suboptimal solve or unbounded duals.
+static bool checkAssignment() {
+    std::mt19937 rng(5);
+    std::uniform_real_distribution<float> unit(0.0f, 1.0f);
+    HungarianAlgorithm solver;
+    std::vector<float> cost;
+    std::vector<float> duals;
+    std::vector<int> assignment;
+    std::vector<char> used;
+    const float tolerance = 1e-4f;
+
+    auto optimal = [&](int rows, int cols, float total) {
+        used.assign(cols, 0);
+        return total <= bruteForceAssignment(cost.data(), rows, cols, 0, std::max(0, rows - cols), used) +
+                            tolerance;
+    };
+
+    for (int trial = 0; trial < 3000; ++trial) {
+        int rows = 1 + static_cast<int>(rng() % 6);
+        int cols = 1 + static_cast<int>(rng() % 6);
+        bool warm = trial % 2 == 1;
+        cost.resize(rows * cols);
+        for (float& c : cost) {
+            c = unit(rng);
+        }
+        duals.resize(rows);
+        assignment.resize(rows);
+        for (int r = 0; r < rows; ++r) {
+            duals[r] = warm ? 4.0f * unit(rng) - 2.0f : 0.0f;
+            assignment[r] = warm ? static_cast<int>(rng() % (cols + 1)) - 1 : -1;
+        }
+        float total = solver.solve(cost.data(), rows, cols, assignment.data(), duals.data(), warm);
+        if (!optimal(rows, cols, total)) {
+            std::cerr << "Error: assignment solver is suboptimal on a " << rows << "x" << cols
+                      << (warm ? " warm" : " cold") << " start" << std::endl;
+            return false;
+        }
+    }
+
+    const int tracks = 12;
+    std::vector<float> trackDuals(tracks, 0.0f);
+    std::vector<int> trackHints(tracks, -1);
+    std::vector<int> ids(tracks);
+    float largestDual = 0.0f;
+    for (int frame = 0; frame < 100000; ++frame) {
+        int rows = 1 + static_cast<int>(rng() % 6);
+        int cols = 1 + static_cast<int>(rng() % 6);
+        for (int i = 0; i < tracks; ++i) {
+            ids[i] = i;
+        }
+        std::shuffle(ids.begin(), ids.end(), rng);
+        cost.resize(rows * cols);
+        for (float& c : cost) {
+            c = unit(rng);
+        }
+        duals.resize(rows);
+        assignment.resize(rows);
+        for (int r = 0; r < rows; ++r) {
+            duals[r] = trackDuals[ids[r]];
+            assignment[r] = trackHints[ids[r]] < cols ? trackHints[ids[r]] : -1;
+        }
+        float total = solver.solve(cost.data(), rows, cols, assignment.data(), duals.data(), true);
+        for (int r = 0; r < rows; ++r) {
+            trackDuals[ids[r]] = duals[r];
+            trackHints[ids[r]] = assignment[r];
+            largestDual = std::max(largestDual, std::fabs(duals[r]));
+        }
+        if (frame % 10 == 0 && !optimal(rows, cols, total)) {
+            std::cerr << "Error: warm-started assignment is suboptimal after " << frame
+                      << " frames" << std::endl;
+            return false;
+        }
+    }
+    // Costs are in [0, 1]; re-centred duals stay within a few units
+    if (largestDual > 100.0f) {
+        std::cerr << "Error: warm-start duals drift (|u| = " << largestDual << ")" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static bool sameDetections(const std::vector<Detection>& a, const std::vector<Detection>& b) {
+    if (a.size() != b.size()) {
+        return false;
+    }
+    for (size_t i = 0; i < a.size(); ++i) {
+        if (a[i].bbox != b[i].bbox || a[i].classId != b[i].classId ||
+            a[i].confidence != b[i].confidence) {
+            return false;
+        }
+    }
+    return true;
+}
+
+// Batched decoding must match decoding each image alone, for both batch
+// layouts: rows stacked in a 2-D output, and the 3-D [N, rows, 5 + C]
+// output of OpenCV's Region layer. Returns false on a mismatch.
+static bool checkBatchDecode(const BenchConfig& config) {
+    YOLODetector detector(config.classesPath);
+    const std::vector<cv::Mat> images[] = {syntheticOutputs(0.05f, 11), syntheticOutputs(0.05f, 12)};
+    const cv::Size frameSizes[] = {cv::Size(1920, 1080), cv::Size(1280, 720)};
+
+    std::vector<std::vector<Detection>> expected;
+    for (int b = 0; b < 2; ++b) {
+        expected.push_back(detector.decode(images[b], frameSizes[b], 0.5f, 0.4f));
+    }
+
+    std::vector<cv::Mat> stacked;
+    std::vector<cv::Mat> planar;
+    for (size_t head = 0; head < images[0].size(); ++head) {
+        const int rows = images[0][head].rows;
+        const int cols = images[0][head].cols;
+        const size_t bytes = static_cast<size_t>(rows) * cols * sizeof(float);
+        cv::Mat rowsOut(2 * rows, cols, CV_32F);
+        int sizes[] = {2, rows, cols};
+        cv::Mat planeOut(3, sizes, CV_32F);
+        for (int b = 0; b < 2; ++b) {
+            std::memcpy(rowsOut.ptr<float>(b * rows), images[b][head].ptr<float>(), bytes);
+            std::memcpy(planeOut.ptr<float>(b), images[b][head].ptr<float>(), bytes);
+        }
+        stacked.push_back(rowsOut);
+        planar.push_back(planeOut);
+    }
+
+    std::vector<cv::Size> sizes(frameSizes, frameSizes + 2);
+    bool ok = true;
+    for (const std::vector<cv::Mat>* outputs : {&stacked, &planar}) {
+        std::vector<std::vector<Detection>> batched = detector.decodeBatch(*outputs, sizes, 0.5f, 0.4f);
+        for (int b = 0; b < 2; ++b) {
+            if (!sameDetections(batched[b], expected[b])) {
+                std::cerr << "Error: batched decode (" << (outputs == &planar ? "3-D" : "2-D")
+                          << " output) differs from single-image decode for image " << b
+                          << std::endl;
+                ok = false;
+            }
+        }
+    }
+    return ok;
+}
+
+// Steady-state allocation check (--check-allocations). Reused buffers grow
+// to the largest problem seen so far, so each hot path is first warmed up on
+// the same inputs it is then measured on; after that a single allocation
+// fails the check. The tracker replays its sequence in a loop, which brings
+// back the same association components every pass.
+static const int CHECK_WARMUP_PASSES = 3;
+static const int CHECK_PASSES = 2;
+static const int CHECK_CALLS = 100;
+
+static bool expectNoAllocations(const std::string& name, const BenchHarness::Params& params,
+                                uint64_t allocations, int64_t ops) {
+    BenchResult result;
+    result.name = name;
+    result.params = params;
+    const std::string label = result.label();
+    std::cerr << label << ": " << allocations << " allocations in " << ops << " ops" << std::endl;
+    if (allocations > 0) {
+        std::cerr << "Error: " << label << " allocates in steady state" << std::endl;
+        return false;
+    }
+    return true;
+}
+
+static bool checkAllocations(const BenchConfig& config) {
+    bool ok = true;
+
+    for (int objects : objectCounts(config.maxObjects)) {
+        for (const Scenario& scenario : TRACKER_SCENARIOS) {
+            const std::vector<std::vector<Detection>> frames = scenarioFrames(objects, scenario);
+            Tracker tracker;
+            for (int pass = 0; pass < CHECK_WARMUP_PASSES; ++pass) {
+                for (const auto& detections : frames) {
+                    tracker.update(detections);
+                }
+            }
+            uint64_t before = allocationCount();
+            for (int pass = 0; pass < CHECK_PASSES; ++pass) {
+                for (const auto& detections : frames) {
+                    tracker.update(detections);
+                }
+            }
+            ok &= expectNoAllocations("tracker/update", scenarioParams(objects, scenario),
+                                      allocationCount() - before,
+                                      static_cast<int64_t>(CHECK_PASSES) * frames.size());
+
+            // Coasting only shrinks the track set, so the warm tracker needs
+            // no further warm-up
+            before = allocationCount();
+            for (int i = 0; i < CHECK_CALLS; ++i) {
+                tracker.propagate();
+            }
+            ok &= expectNoAllocations("tracker/propagate", scenarioParams(objects, scenario),
+                                      allocationCount() - before, CHECK_CALLS);
+        }
+    }
+
+    for (int count : {1000, 20000}) {
+        std::vector<cv::Rect> boxes;
+        std::vector<float> scores;
+        std::vector<int> classIds;
+        nmsCandidates(count, boxes, scores, classIds);
+        for (int grid = 0; grid <= 1; ++grid) {
+            NonMaxSuppressor::Options options;
+            options.useGrid = grid != 0;
+            NonMaxSuppressor nms(options);
+            std::vector<int> keep;
+            for (int i = 0; i < CHECK_WARMUP_PASSES; ++i) {
+                nms.run(boxes.data(), scores.data(), classIds.data(), count, 0.5f, 0.4f, keep);
+            }
+            uint64_t before = allocationCount();
+            for (int i = 0; i < CHECK_CALLS; ++i) {
+                nms.run(boxes.data(), scores.data(), classIds.data(), count, 0.5f, 0.4f, keep);
+            }
+            ok &= expectNoAllocations("nms/run", {{"candidates", count}, {"grid", grid}},
+                                      allocationCount() - before, CHECK_CALLS);
+        }
+    }
+
+    struct DecodeInput {
+        std::string name;
+        BenchHarness::Params params;
+        std::vector<cv::Mat> outputs;
+        cv::Size frameSize;
+    };
+    std::vector<DecodeInput> decodeInputs;
+    for (float rate : {0.01f, 0.1f}) {
+        decodeInputs.push_back({"detector/decode", {{"object_rate", rate}},
+                                syntheticOutputs(rate, 7), cv::Size(1920, 1080)});
+    }
+    DecodeInput recorded = {"detector/decode_recorded", {}, {}, cv::Size()};
+    if (!config.tensorsPath.empty() && loadOutputs(config.tensorsPath, recorded.outputs, recorded.frameSize)) {
+        decodeInputs.push_back(recorded);
+    }
+
+    YOLODetector detector(config.classesPath);
+    for (const DecodeInput& input : decodeInputs) {
+        std::vector<Detection> detections;
+        for (int i = 0; i < CHECK_WARMUP_PASSES; ++i) {
+            detector.decode(input.outputs, input.frameSize, 0.5f, 0.4f, detections);
+        }
+        uint64_t before = allocationCount();
+        for (int i = 0; i < CHECK_CALLS; ++i) {
+            detector.decode(input.outputs, input.frameSize, 0.5f, 0.4f, detections);
+        }
+        ok &= expectNoAllocations(input.name, input.params, allocationCount() - before, CHECK_CALLS);
+    }
+    return ok;
+}
+
+// Forward pass alone, per backend and thread count, on a synthetic 1080p
+// frame; compares inference runtimes on the same model
+static void benchDetectorForward(BenchHarness& harness, const BenchConfig& config) {
+    if (config.modelPath.empty()) {
+        return;
+    }
+    cv::Mat frame(1080, 1920, CV_8UC3);
+    cv::randu(frame, cv::Scalar::all(0), cv::Scalar::all(255));
+
+    for (const std::string& name : config.backends) {
+        std::string benchName = "detector/forward/" + name;
+        for (int threads : config.intraOpThreads) {
+            BenchHarness::Params params = {{"input_size", 416},
+                                           {"intra_threads", static_cast<double>(threads)},
+                                           {"inter_threads", static_cast<double>(config.interOpThreads)}};
+            if (!harness.enabled(benchName, params)) {
+                continue;
+            }
+            InferenceBackend::Options backendOptions;
+            backendOptions.name = name;
+            backendOptions.intraOpThreads = threads;
+            backendOptions.interOpThreads = config.interOpThreads;
+            YOLODetector detector(config.modelPath, config.modelConfigPath, config.classesPath, 1,
+                                  backendOptions);
+            if (!detector.isLoaded()) {
+                continue;
+            }
+            detector.setInputSize(416);
+            params[0].second = detector.getInputSize();
+            harness.run(benchName, params, 1, [&](BenchState& state) {
+                for (int64_t i = 0; i < state.iterations(); ++i) {
+                    detector.detect(frame);
+                }
+            });
+        }
+    }
+    cv::setNumThreads(1);
+}
+
+// Runs the detector on the first frame of a video and saves the raw outputs
+// for --tensors
+static int recordTensors(const std::string& videoPath, const std::string& modelPath,
+                         const std::string& configPath, const std::string& classesPath,
+                         const std::string& outputPath) {
+    cv::VideoCapture cap(videoPath);
+    cv::Mat frame;
+    if (!cap.isOpened() || !cap.read(frame)) {
+        std::cerr << "Error: Could not read a frame from: " << videoPath << std::endl;
+        return 1;
+    }
+    YOLODetector detector(modelPath, configPath, classesPath);
+    if (!detector.isLoaded()) {
+        std::cerr << "Error: Failed to load YOLO model!" << std::endl;
+        return 1;
+    }
+    detector.detect(frame);
+
+    cv::FileStorage fs(outputPath, cv::FileStorage::WRITE);
+    if (!fs.isOpened()) {
+        std::cerr << "Error: Could not write tensor file: " << outputPath << std::endl;
+        return 1;
+    }
+    fs << "frame_width" << frame.cols << "frame_height" << frame.rows;
+    fs << "outputs" << "[";
+    for (const cv::Mat& out : detector.getLastOutputs()) {
+        fs << out;
+    }
+    fs << "]";
+    std::cout << "Saved " << detector.getLastOutputs().size() << " output tensors to "
+              << outputPath << std::endl;
+    return 0;
+}
+
+static void printUsage() {
+    std::cerr << "Usage: mot_bench [--filter <text>] [--json <file>] [--min-time <ms>]\n"
+              << "                 [--repetitions <n>] [--max-objects <n>] [--max-assignment <n>]\n"
+              << "                 [--classes <coco.names>] [--tensors <outputs.yml>]\n"
+              << "                 [--model <weights|onnx> [--model-config <cfg>]]\n"
+              << "                 [--backends <opencv,onnxruntime>] [--threads <1,4,...>]\n"
+              << "                 [--inter-threads <n>]\n"
+              << "       mot_bench --check-allocations [--max-objects <n>] [--tensors <outputs.yml>]\n"
+              << "       mot_bench --record-tensors <video> <weights> <cfg> <classes> <outputs.yml>\n";
+}
+
+int main(int argc, char** argv) {
+    BenchHarness::Options options;
+    BenchConfig config;
+    std::string jsonPath;
+    bool allocationCheck = false;
+
+    for (int i = 1; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--record-tensors" && i + 5 < argc) {
+            return recordTensors(argv[i + 1], argv[i + 2], argv[i + 3], argv[i + 4], argv[i + 5]);
+        } else if (arg == "--check-allocations") {
+            allocationCheck = true;
+        } else if (arg == "--filter" && hasValue) {
+            options.filter = argv[++i];
+        } else if (arg == "--json" && hasValue) {
+            jsonPath = argv[++i];
+        } else if (arg == "--min-time" && hasValue) {
+            options.minTimeMs = std::atof(argv[++i]);
+        } else if (arg == "--repetitions" && hasValue) {
+            options.repetitions = std::atoi(argv[++i]);
+        } else if (arg == "--max-objects" && hasValue) {
+            config.maxObjects = std::atoi(argv[++i]);
+        } else if (arg == "--max-assignment" && hasValue) {
+            config.maxAssignment = std::atoi(argv[++i]);
+        } else if (arg == "--classes" && hasValue) {
+            config.classesPath = argv[++i];
+        } else if (arg == "--tensors" && hasValue) {
+            config.tensorsPath = argv[++i];
+        } else if (arg == "--model" && hasValue) {
+            config.modelPath = argv[++i];
+        } else if (arg == "--model-config" && hasValue) {
+            config.modelConfigPath = argv[++i];
+        } else if (arg == "--backends" && hasValue) {
+            config.backends = splitList(argv[++i]);
+        } else if (arg == "--threads" && hasValue) {
+            config.intraOpThreads.clear();
+            for (const std::string& item : splitList(argv[++i])) {
+                config.intraOpThreads.push_back(std::atoi(item.c_str()));
+            }
+        } else if (arg == "--inter-threads" && hasValue) {
+            config.interOpThreads = std::atoi(argv[++i]);
+        } else {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    // Single-threaded kernels; keep OpenCV's pool out of the measurements
+    cv::setNumThreads(1);
+
+    // Correctness checks that the timings below rely on
+    if (!checkAssignment() || !checkBatchDecode(config)) {
+        return 1;
+    }
+    if (allocationCheck) {
+        return checkAllocations(config) ? 0 : 1;
+    }
+
+    BenchHarness harness(options);
+    benchTracker(harness, config);
+    benchHungarian(harness, config);
+    benchKalman(harness, config);
+    benchAssociation(harness, config);
+    benchNms(harness);
+    benchMetrics(harness);
+    benchDetectorDecode(harness, config);
+    benchDetectorForward(harness, config);
+
+    if (jsonPath.empty()) {
+        harness.writeJson(std::cout);
+    } else {
+        std::ofstream out(jsonPath);
+        if (!out.is_open()) {
+            std::cerr << "Error: Could not write " << jsonPath << std::endl;
+            return 1;
+        }
+        harness.writeJson(out);
+        std::cerr << "Results written to " << jsonPath << std::endl;
+    }
+    return 0;
+}
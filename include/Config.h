@@ -0,0 +1,37 @@
+#ifndef CONFIG_H
+#define CONFIG_H
+
+#include <map>
+#include <string>
+#include <vector>
+
+// Reader for the INI-style config.txt:
+//   [Section]
+//   key = value      # trailing comment
+// Values are looked up as (section, key); missing keys return the default.
+class Config {
+public:
+    Config() = default;
+
+    // Returns false if the file could not be opened
+    bool load(const std::string& path);
+
+    bool has(const std::string& section, const std::string& key) const;
+    std::string getString(const std::string& section, const std::string& key,
+                          const std::string& defaultValue = "") const;
+    int getInt(const std::string& section, const std::string& key, int defaultValue) const;
+    float getFloat(const std::string& section, const std::string& key, float defaultValue) const;
+    bool getBool(const std::string& section, const std::string& key, bool defaultValue) const;
+
+    // Parses "[0, 2, 5]" (brackets optional); "[]" yields an empty list
+    std::vector<int> getIntList(const std::string& section, const std::string& key) const;
+    std::vector<float> getFloatList(const std::string& section, const std::string& key) const;
+
+private:
+    std::map<std::string, std::string> values;
+
+    static std::string makeKey(const std::string& section, const std::string& key);
+    static std::string trim(const std::string& text);
+};
+
+#endif // CONFIG_H
@@ -4,16 +4,17 @@
 #include <opencv2/opencv.hpp>
 #include <vector>
 
+// Detections carry only the class id; the name is looked up in the
+// detector's class table (YOLODetector::getClassName) when needed
 struct Detection {
     cv::Rect bbox;
     float confidence;
     int classId;
-    std::string className;
     
     Detection() : confidence(0.0f), classId(-1) {}
     
-    Detection(const cv::Rect& box, float conf, int cls, const std::string& name = "")
-        : bbox(box), confidence(conf), classId(cls), className(name) {}
+    Detection(const cv::Rect& box, float conf, int cls)
+        : bbox(box), confidence(conf), classId(cls) {}
 };
 
 #endif // DETECTION_H
@@ -0,0 +1,125 @@
+#ifndef DETECTION_CACHE_H
+#define DETECTION_CACHE_H
+
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <vector>
+#include "Detection.h"
+
+// Per-frame detection lists that can be replayed into the tracker without
+// decoding video or running the network
+class DetectionSequence {
+public:
+    virtual ~DetectionSequence() = default;
+
+    virtual int getFrameCount() const = 0;
+
+    // Detections of frame index (0-based). Returns false if the detector did
+    // not run on that frame (detection stride), leaving detections empty.
+    virtual bool getFrame(int index, std::vector<Detection>& detections) const = 0;
+};
+
+// On-disk detection cache (".motd"), written once per video/model/settings
+// combination and memory-mapped for replay. Host byte order throughout:
+//
+//   header   "MOTD", version, key, frameCount, identityLength,
+//            recordCount, tableOffset                          (40 bytes)
+//   identity identityLength bytes (the text the key was hashed from)
+//   records  recordCount x {x, y, w, h, confidence, classId}   (24 bytes each)
+//   table    frameCount x {first record, count (-1 = not detected)}
+//
+// The table is written last and the header rewritten on finish(), so a
+// file from an interrupted run has tableOffset 0 and is rejected.
+class DetectionCache : public DetectionSequence {
+public:
+    static const uint32_t VERSION = 1;
+
+    DetectionCache() = default;
+    ~DetectionCache() override;
+
+    DetectionCache(const DetectionCache&) = delete;
+    DetectionCache& operator=(const DetectionCache&) = delete;
+
+    // Maps a complete cache file. expectedKey != 0 also requires a key match.
+    bool open(const std::string& path, uint64_t expectedKey = 0);
+    void close();
+    bool isOpen() const { return data != nullptr; }
+
+    int getFrameCount() const override { return frameCount; }
+    bool getFrame(int index, std::vector<Detection>& detections) const override;
+
+    uint64_t getKey() const { return key; }
+    const std::string& getIdentity() const { return identity; }
+
+    // 64-bit FNV-1a of an identity string
+    static uint64_t hashIdentity(const std::string& identity);
+
+    // "path:size:mtime" of a file, or just the path if it cannot be read;
+    // changes whenever the file is replaced or rewritten
+    static std::string fileFingerprint(const std::string& path);
+
+    // "<directory>/<video stem>-<key as hex>.motd"
+    static std::string cachePath(const std::string& directory, const std::string& videoPath,
+                                 uint64_t key);
+
+private:
+    struct Record;
+    struct FrameEntry;
+
+    const unsigned char* data = nullptr;
+    size_t size = 0;
+    std::vector<unsigned char> fallback;     // whole file, where mmap is unavailable
+
+    uint64_t key = 0;
+    int frameCount = 0;
+    std::string identity;
+    const Record* records = nullptr;
+    uint64_t recordCount = 0;
+    const FrameEntry* table = nullptr;
+};
+
+// Streams detections into a new cache file. Frames must be appended in
+// order starting at 0; finish() completes the file. A writer destroyed
+// without finish() deletes its partial file.
+class DetectionCacheWriter {
+public:
+    DetectionCacheWriter(const std::string& path, uint64_t key, const std::string& identity);
+    ~DetectionCacheWriter();
+
+    DetectionCacheWriter(const DetectionCacheWriter&) = delete;
+    DetectionCacheWriter& operator=(const DetectionCacheWriter&) = delete;
+
+    bool isOpen() const { return file.is_open(); }
+
+    // detected = false records a frame the detector skipped
+    void append(bool detected, const std::vector<Detection>& detections);
+
+    bool finish();
+
+private:
+    std::string path;
+    uint64_t key;
+    std::string identity;
+    std::ofstream file;
+    std::vector<int64_t> frameTable;         // first, count pairs
+    uint64_t recordCount = 0;
+    bool finished = false;
+};
+
+// MOTChallenge detection file (det.txt): one line per detection,
+// "frame,id,x,y,w,h,confidence,..." with 1-based frames. Every frame up to
+// the last one listed counts as detected. Boxes get classId 0 (person).
+class MotDetectionFile : public DetectionSequence {
+public:
+    // Keeps detections with confidence >= minConfidence
+    bool load(const std::string& path, float minConfidence = -1e30f);
+
+    int getFrameCount() const override { return static_cast<int>(frames.size()); }
+    bool getFrame(int index, std::vector<Detection>& detections) const override;
+
+private:
+    std::vector<std::vector<Detection>> frames;
+};
+
+#endif // DETECTION_CACHE_H
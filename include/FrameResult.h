@@ -0,0 +1,27 @@
+#ifndef FRAME_RESULT_H
+#define FRAME_RESULT_H
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+// Copy of one track's output data, taken on the tracking thread so the
+// output stage never touches Tracker state
+struct TrackRecord {
+    int id = 0;
+    int classId = -1;
+    cv::Rect bbox;
+    std::string className;
+    std::vector<cv::Point> trajectory;     // only filled if a consumer draws it
+};
+
+// One processed frame as seen by the output stage. The image is shared with
+// the pipeline, not copied: consumers must not draw on it in place.
+struct FrameResult {
+    int index = 0;                         // 0-based frame number
+    cv::Mat frame;
+    std::vector<TrackRecord> tracks;
+    double fps = 0.0;                      // pipeline throughput, for overlays
+};
+
+#endif // FRAME_RESULT_H
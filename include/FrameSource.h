@@ -0,0 +1,148 @@
+#ifndef FRAME_SOURCE_H
+#define FRAME_SOURCE_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Where decoded frames come from. FrameSource::open() picks the
+// implementation from the source string:
+//
+//   shm:<name>        SharedMemoryFrameSource (SharedMemoryRing.h), frames
+//                     published by a local producer process
+//   *.y4m             Y4M file, memory-mapped
+//   *.bgr, *.raw      headerless BGR24 file, memory-mapped; the frame size
+//                     comes from Options
+//   digits            camera index (cv::VideoCapture)
+//   anything else     file or URL (cv::VideoCapture)
+//
+// Raw BGR and shared-memory frames are cv::Mat headers over the mapping: no
+// codec decode and no copy. Such frames must be treated as read-only and
+// must not outlive their source. Y4M frames skip the codec but still need
+// one YUV to BGR conversion.
+class FrameSource {
+public:
+    struct Options {
+        int rawWidth = 0;            // raw BGR files
+        int rawHeight = 0;
+        double rawFps = 0.0;
+        int holdFrames = 32;         // blocking shared-memory rings: frames the consumer may hold at once
+    };
+
+    virtual ~FrameSource() = default;
+
+    // Returns the next frame, or false at the end of the source
+    virtual bool read(cv::Mat& frame) = 0;
+
+    virtual bool isOpened() const = 0;
+    virtual cv::Size getFrameSize() const = 0;
+    virtual double getFps() const = 0;          // 0 if unknown
+
+    // Live sources (cameras, streams, shared memory) cannot be replayed, so
+    // their detections are never cached
+    virtual bool isLive() const { return false; }
+
+    // Frames skipped because the consumer fell behind a live producer
+    virtual int64_t getDropped() const { return 0; }
+
+    // Makes a read() that is waiting for a producer return false; may be
+    // called from another thread
+    virtual void interrupt() {}
+
+    // Opens a source as described above; check isOpened() on the result
+    static std::unique_ptr<FrameSource> open(const std::string& source, const Options& options);
+    static std::unique_ptr<FrameSource> open(const std::string& source) {
+        return open(source, Options());
+    }
+};
+
+// Codec-based source: video files, URLs and cameras through cv::VideoCapture
+class VideoCaptureSource : public FrameSource {
+public:
+    explicit VideoCaptureSource(const std::string& source);
+
+    bool read(cv::Mat& frame) override { return capture.read(frame); }
+    bool isOpened() const override { return capture.isOpened(); }
+    cv::Size getFrameSize() const override;
+    double getFps() const override;
+    bool isLive() const override { return live; }
+
+private:
+    // get() is not const in every OpenCV version
+    mutable cv::VideoCapture capture;
+    bool live = false;
+};
+
+// Private memory mapping of a whole file (POSIX mmap; read into memory
+// where mmap is unavailable)
+class MappedFile {
+public:
+    MappedFile() = default;
+    ~MappedFile();
+
+    MappedFile(const MappedFile&) = delete;
+    MappedFile& operator=(const MappedFile&) = delete;
+
+    bool open(const std::string& path);
+    void close();
+
+    // Copy-on-write: writes through a frame never reach the file
+    unsigned char* data() const { return begin; }
+    size_t size() const { return length; }
+
+private:
+    unsigned char* begin = nullptr;
+    size_t length = 0;
+    std::vector<unsigned char> fallback;
+};
+
+// Headerless BGR24 file: frame i is the i-th block of width * height * 3
+// bytes. Frames are zero-copy views of the mapping.
+class RawVideoSource : public FrameSource {
+public:
+    RawVideoSource(const std::string& path, int width, int height, double fps);
+
+    bool read(cv::Mat& frame) override;
+    bool isOpened() const override { return file.data() != nullptr && frameBytes > 0; }
+    cv::Size getFrameSize() const override { return size; }
+    double getFps() const override { return fps; }
+
+private:
+    MappedFile file;
+    cv::Size size;
+    double fps;
+    size_t frameBytes = 0;
+    size_t offset = 0;
+};
+
+// YUV4MPEG2 (.y4m) file: "YUV4MPEG2 W.. H.. F..:.. C..\n" followed by
+// "FRAME[ params]\n" + planar image per frame. Skips the codec entirely;
+// 4:2:0 and mono frames are converted to BGR in one pass from the mapping.
+class Y4mVideoSource : public FrameSource {
+public:
+    explicit Y4mVideoSource(const std::string& path);
+
+    bool read(cv::Mat& frame) override;
+    bool isOpened() const override { return file.data() != nullptr && frameBytes > 0; }
+    cv::Size getFrameSize() const override { return size; }
+    double getFps() const override { return fps; }
+
+private:
+    enum class Chroma {
+        Yuv420,
+        Mono
+    };
+
+    MappedFile file;
+    cv::Size size;
+    double fps = 0.0;
+    Chroma chroma = Chroma::Yuv420;
+    size_t frameBytes = 0;
+    size_t offset = 0;             // start of the next FRAME marker
+
+    bool parseHeader();
+};
+
+#endif // FRAME_SOURCE_H
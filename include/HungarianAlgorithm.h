@@ -4,15 +4,57 @@
 #include <vector>
 #include <limits>
 
+// Exact rectangular linear assignment solver (Jonker-Volgenant style
+// shortest augmenting paths, O(n^3) worst case).
+//
+// A rows x cols problem is solved as a square n = max(rows, cols) problem
+// whose padding entries all cost the same, which has the same optimal
+// assignment. Workspace is kept in the instance and reused between calls.
+//
+// Warm start: rows usually stand for the same objects from one frame to the
+// next (tracks), so the previous frame's row duals can be passed back in,
+// together with a row -> column hint per row (e.g. its cheapest column; a
+// column hinted twice goes to the first row). Column duals are rebuilt from
+// the row duals so the start is always dual feasible. Hinted pairs that are
+// tight are kept, and remaining free columns are paired with the row at
+// their reduced minimum. Only rows left free are augmented.
 class HungarianAlgorithm {
 public:
     // Solve the assignment problem
     // costMatrix: 2D cost matrix (rows = tracks, cols = detections)
     // Returns: vector of assignments (track index -> detection index, -1 if unassigned)
     static std::vector<int> solve(const std::vector<std::vector<float>>& costMatrix);
-    
+
+    // Solve on a row-major rows x cols cost buffer.
+    // assignment (rows entries): output row -> column, -1 if unassigned.
+    //   With warmStart it is also read as the hint for each row (-1 = none).
+    // rowDuals (rows entries, optional): with warmStart read as the initial
+    //   row potentials; always overwritten with the final ones, shifted so
+    //   the smallest is 0 (keeps warm-started duals bounded over time).
+    // Returns the total cost of the assigned pairs.
+    float solve(const float* cost, int rows, int cols, int* assignment,
+                float* rowDuals = nullptr, bool warmStart = false);
+
+    // Number of augmenting paths run by the last solve() (0 = warm start
+    // already optimal)
+    int getLastAugmentations() const { return lastAugmentations; }
+
 private:
     static const float INF;
+
+    // Workspace, 1-based as in the classic formulation (index 0 is the root)
+    std::vector<float> u;        // row potentials
+    std::vector<float> v;        // column potentials
+    std::vector<int> colMatch;   // row matched to column j (0 = free)
+    std::vector<int> rowMatch;   // column matched to row i (0 = free)
+    std::vector<int> way;        // predecessor column on the search tree
+    std::vector<float> minv;     // tentative reduced distance per column
+    std::vector<char> used;      // column already on the search tree
+    std::vector<int> colArgmin;  // row attaining the reduced column minimum
+
+    int lastAugmentations = 0;
+
+    void augment(const float* cost, int rows, int cols, int n, int row);
 };
 
 #endif // HUNGARIAN_ALGORITHM_H
@@ -0,0 +1,83 @@
+#ifndef INFERENCE_BACKEND_H
+#define INFERENCE_BACKEND_H
+
+#include <opencv2/opencv.hpp>
+#include <opencv2/dnn.hpp>
+#include <memory>
+#include <string>
+#include <vector>
+
+// Runtime that executes the detector network. YOLODetector owns the model
+// side: input tensor, output decoding, NMS, tiling. A backend only turns an
+// NCHW float blob into the raw outputs, so runtimes can be swapped and
+// benchmarked without touching the tracker.
+//
+// Outputs use the Darknet region layout for every backend: one 2-D CV_32F
+// matrix per output layer, one row per candidate,
+// [cx, cy, w, h, objectness, class scores...], coordinates relative to the
+// input and scores already multiplied by objectness. The images of a batch
+// are stacked along the rows.
+class InferenceBackend {
+public:
+    struct Options {
+        std::string name = "opencv";    // opencv, onnxruntime
+        int intraOpThreads = 0;         // threads inside one operator (0 = runtime default)
+        int interOpThreads = 0;         // operators run concurrently (0 = runtime default)
+    };
+
+    // Input dimensions fixed by the model; 0 = any
+    struct InputShape {
+        int batch = 0;
+        int height = 0;
+        int width = 0;
+    };
+
+    virtual ~InferenceBackend() = default;
+
+    virtual bool isLoaded() const = 0;
+    virtual const char* getName() const = 0;
+    virtual InputShape getInputShape() const { return InputShape(); }
+
+    // Runs the network on blob (N x 3 x H x W); outputs are reused between calls
+    virtual void forward(const cv::Mat& blob, std::vector<cv::Mat>& outputs) = 0;
+
+    // Replaces the network with an INT8 version whose activation ranges are
+    // calibrated on the given input tensor. Inputs and outputs stay float.
+    // Returns false, keeping the FP32 network, if the backend cannot.
+    virtual bool quantize(const cv::Mat& calibration) { return false; }
+
+    // Backend for options.name; check isLoaded() on the result. Returns null
+    // for an unknown or unavailable backend.
+    static std::unique_ptr<InferenceBackend> create(const std::string& modelPath,
+                                                    const std::string& configPath,
+                                                    const Options& options);
+
+    // Names accepted by create() in this build
+    static std::vector<std::string> available();
+};
+
+// OpenCV DNN on the CPU. Reads Darknet (.weights + .cfg) and the other
+// formats cv::dnn::readNet() supports, including ONNX. OpenCV runs layers
+// one after another, so interOpThreads has no effect; intraOpThreads sets
+// OpenCV's thread pool, which is process-wide.
+class OpenCvBackend : public InferenceBackend {
+public:
+    OpenCvBackend(const std::string& modelPath, const std::string& configPath, const Options& options);
+
+    bool isLoaded() const override { return !net.empty(); }
+    const char* getName() const override { return "opencv"; }
+    void forward(const cv::Mat& blob, std::vector<cv::Mat>& outputs) override;
+
+    // cv::dnn::Net::quantize(), per-channel weights (OpenCV 4.6 or newer)
+    bool quantize(const cv::Mat& calibration) override;
+
+    cv::dnn::Net& getNet() { return net; }
+
+private:
+    cv::dnn::Net net;
+    std::vector<cv::String> outputNames;
+
+    void findOutputs();
+};
+
+#endif // INFERENCE_BACKEND_H
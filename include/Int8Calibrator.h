@@ -0,0 +1,97 @@
+#ifndef INT8_CALIBRATOR_H
+#define INT8_CALIBRATOR_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <ostream>
+#include <string>
+#include <vector>
+#include "Detection.h"
+#include "YOLODetector.h"
+
+// INT8 inference for YOLODetector. The network is calibrated on a folder of
+// representative frames from the target cameras and then quantized (see
+// InferenceBackend::quantize). The same frames measure what INT8 costs:
+// FP32 and INT8 detections are matched per frame, and the timings of both
+// are recorded.
+//
+// OpenCV cannot save a quantized network, so the cache (".motq") holds what
+// determines it: the calibration tensor, stored as 8-bit pixels, together
+// with the report. A cached startup skips reading the folder and the FP32
+// comparison pass, and only redoes the quantization itself. Host byte order:
+//
+//   header  "MOTQ", version, key, frames, height, width, report   (56 bytes)
+//   tensor  frames x 3 x height x width bytes (pixel values, 0-255)
+class Int8Calibrator {
+public:
+    static const uint32_t VERSION = 1;
+
+    struct Options {
+        bool enabled = false;
+        std::string calibrationDir;    // jpg/png/bmp frames from the target cameras
+        int maxFrames = 16;            // frames used, evenly spaced through the sorted folder
+        std::string cacheDir;          // calibration cache directory ("" = no cache)
+        float matchIoU = 0.5f;         // an INT8 box must overlap its FP32 box this much
+    };
+
+    struct Report {
+        int frames = 0;
+        int fp32Detections = 0;
+        int int8Detections = 0;
+        int matched = 0;                    // same class and IoU >= matchIoU
+        float meanIoU = 0.0f;               // over matched pairs
+        float meanConfidenceDelta = 0.0f;   // INT8 - FP32, over matched pairs
+        float fp32Ms = 0.0f;                // detect() per frame
+        float int8Ms = 0.0f;
+
+        float recall() const { return fp32Detections > 0 ? static_cast<float>(matched) / fp32Detections : 1.0f; }
+        float precision() const { return int8Detections > 0 ? static_cast<float>(matched) / int8Detections : 1.0f; }
+    };
+
+    // baseIdentity describes the model and detection settings (files, input
+    // size, thresholds, ...); the cache is reused only while it and the
+    // calibration files are unchanged
+    Int8Calibrator(const Options& options, const std::string& baseIdentity);
+
+    // Quantizes the detector, whose input size, letterbox and class filter
+    // must already be set. The first call builds the calibration (from the
+    // cache or the folder) and the report; later calls, for more detector
+    // workers, reuse it. Returns false, leaving the detector in FP32, if
+    // there are no calibration frames or the backend cannot quantize.
+    bool apply(YOLODetector& detector, float confThreshold, float nmsThreshold);
+
+    const Report& getReport() const { return report; }
+    bool isCached() const { return cached; }    // calibration was read from the cache
+
+    // Text accounted for by the cache key (calibration files and options)
+    const std::string& getIdentity() const { return identity; }
+
+    void printReport(std::ostream& out) const;
+
+private:
+    Options options;
+    std::string identity;
+    uint64_t key = 0;
+    std::string cachePath;
+    std::vector<std::string> files;
+    cv::Mat calibration;               // N x 3 x H x W float input tensor
+    Report report;
+    bool calibrated = false;
+    bool cached = false;
+
+    // Calibration frames, evenly spaced through the sorted folder
+    std::vector<std::string> listFrames() const;
+
+    // Builds the calibration tensor and the FP32 half of the report
+    bool calibrate(YOLODetector& detector, float confThreshold, float nmsThreshold,
+                   std::vector<cv::Mat>& frames, std::vector<std::vector<Detection>>& reference);
+
+    // Matches INT8 detections to the FP32 reference of each frame
+    void compare(const std::vector<std::vector<Detection>>& reference,
+                 const std::vector<std::vector<Detection>>& int8);
+
+    bool loadCache(const cv::Size& inputSize);
+    void saveCache() const;
+};
+
+#endif // INT8_CALIBRATOR_H
@@ -3,21 +3,72 @@
 
 #include <opencv2/opencv.hpp>
 
-class KalmanFilter {
+// Allocation-free Kalman filter for box tracking with fixed-size state.
+//
+// The measurement is MeasDim coordinates ([cx, cy, w, h] for boxes) and the
+// state holds ORDER = StateDim / MeasDim derivatives of each coordinate:
+//   ORDER 2: [x, y, w, h, vx, vy, vw, vh]             (constant velocity)
+//   ORDER 3: [..., ax, ay, aw, ah]                     (constant acceleration)
+//
+// F and H act on every coordinate independently, and Q, R and the initial P
+// are diagonal, so the covariance stays block diagonal: one ORDER x ORDER
+// block per coordinate. The filter stores only those blocks and replaces the
+// generic 8x8 GEMMs with a few multiply-adds per coordinate.
+//
+// Storage layout (MeasDim-wide rows, so the coordinate loop is contiguous):
+//   mean[k * MeasDim + c]                 derivative k of coordinate c
+//   cov[(k * ORDER + l) * MeasDim + c]    covariance of derivatives k, l of c
+template <int StateDim, int MeasDim>
+class FixedKalmanFilter {
 public:
-    KalmanFilter();
-    
+    static_assert(StateDim % MeasDim == 0, "StateDim must be a multiple of MeasDim");
+
+    static constexpr int ORDER = StateDim / MeasDim;
+    static constexpr int MEAN_SIZE = StateDim;
+    static constexpr int COV_SIZE = ORDER * ORDER * MeasDim;
+
+    explicit FixedKalmanFilter(float processNoise = 1e-2f, float measurementNoise = 1e-1f);
+
     void init(const cv::Rect& bbox);
     cv::Rect predict();
     void update(const cv::Rect& bbox);
-    
+
+    // Box of the current state estimate (no side effects)
+    cv::Rect getBbox() const;
+
+    const float* getMean() const { return mean; }
+    const float* getCovariance() const { return cov; }
+
+    // Kernels on caller-owned storage of MEAN_SIZE / COV_SIZE floats
+    static void initState(float* mean, float* cov, const float* measurement);
+    static void predictState(float* mean, float* cov, float processNoise);
+    static void updateState(float* mean, float* cov, const float* measurement,
+                            float measurementNoise);
+
+    // Batched kernels over contiguous arrays of filters (count * MEAN_SIZE
+    // means, count * COV_SIZE covariances). updateBatch corrects the filters
+    // listed in slots with count * MeasDim packed measurements.
+    static void predictBatch(float* means, float* covs, int count, float processNoise);
+    static void updateBatch(float* means, float* covs, const int* slots,
+                            const float* measurements, int count, float measurementNoise);
+
+    // Box <-> measurement conversion (MeasDim == 4)
+    static void bboxToMeasurement(const cv::Rect& bbox, float* measurement);
+    static cv::Rect stateToBbox(const float* mean);
+
 private:
-    cv::KalmanFilter kf;
+    float mean[MEAN_SIZE];
+    float cov[COV_SIZE];
+    float processNoise;
+    float measurementNoise;
     bool initialized;
-    
-    // Convert bbox to state vector [x, y, w, h, vx, vy, vw, vh]
-    cv::Mat bboxToState(const cv::Rect& bbox) const;
-    cv::Rect stateToBbox(const cv::Mat& state) const;
 };
 
+// Default model: constant velocity, state [x, y, w, h, vx, vy, vw, vh]
+using KalmanFilter = FixedKalmanFilter<8, 4>;
+using ConstantAccelerationKalmanFilter = FixedKalmanFilter<12, 4>;
+
+extern template class FixedKalmanFilter<8, 4>;
+extern template class FixedKalmanFilter<12, 4>;
+
 #endif // KALMAN_FILTER_H
@@ -0,0 +1,62 @@
+#ifndef LATENCY_CONTROLLER_H
+#define LATENCY_CONTROLLER_H
+
+#include <vector>
+
+// Keeps per-frame latency within a budget by trading detection quality for
+// speed at run time.
+//
+// The controller walks a ladder of levels, best first. The input size
+// shrinks first (608 -> 416 -> 320) at the smallest stride, then the stride
+// grows at the smallest size. Latency samples are averaged over a window of
+// frames:
+//  - If the mean exceeds the budget, the controller steps one level down.
+//  - It steps up only if the mean, scaled by the cost of the better level,
+//    would stay below upgradeHeadroom * budget, and only after cooldown
+//    frames at the current level.
+// Detector cost is modeled as input area / stride. A level that just
+// failed therefore has to show clear headroom before it is tried again,
+// so the controller does not flap.
+class LatencyController {
+public:
+    struct Level {
+        int inputSize;
+        int stride;
+    };
+
+    struct Options {
+        bool enabled = false;
+        float budgetMs = 33.0f;
+        std::vector<int> inputSizes = {608, 416, 320};
+        std::vector<int> strides = {1, 2, 3};
+        int window = 30;                // frames per decision
+        float upgradeHeadroom = 0.8f;   // predicted latency must stay below this share of the budget
+        int cooldown = 90;              // frames at a level before stepping up
+    };
+
+    // Starts at the ladder level closest in cost to the configured input
+    // size and stride
+    LatencyController(const Options& options, int inputSize, int stride);
+
+    bool isEnabled() const { return options.enabled; }
+
+    // Adds one frame's latency. Returns true if the level changed; the new
+    // one is getLevel().
+    bool record(double milliseconds);
+
+    const Level& getLevel() const { return ladder[level]; }
+    int getChanges() const { return changes; }
+
+private:
+    Options options;
+    std::vector<Level> ladder;
+    int level = 0;
+    int changes = 0;
+    int framesAtLevel = 0;
+    int samples = 0;
+    double sum = 0.0;
+
+    static double cost(const Level& level);
+};
+
+#endif // LATENCY_CONTROLLER_H
@@ -0,0 +1,209 @@
+#ifndef METRICS_H
+#define METRICS_H
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <ostream>
+#include <string>
+#include <thread>
+
+// Lock-free histogram of non-negative integer samples (nanoseconds, or
+// counts per frame). Log-linear buckets: exact below 16, then 8 buckets per
+// power of two (12.5% resolution) up to 2^64. Recording is a few relaxed
+// atomic adds, so any number of threads can record concurrently; readers
+// see a consistent-enough snapshot without stopping writers.
+class Histogram {
+public:
+    static const int SUB_BUCKET_BITS = 3;
+    static const int LINEAR_LIMIT = 16;
+    static const int BUCKET_COUNT = LINEAR_LIMIT + (64 - 4) * (1 << SUB_BUCKET_BITS);
+
+    struct Summary {
+        uint64_t count = 0;
+        uint64_t sum = 0;
+        uint64_t max = 0;
+        uint64_t p50 = 0;
+        uint64_t p95 = 0;
+        uint64_t p99 = 0;
+        double mean() const { return count ? static_cast<double>(sum) / count : 0.0; }
+    };
+
+    Histogram();
+
+    void record(uint64_t value);
+    void reset();
+
+    // Percentiles are bucket upper bounds, clamped to the largest sample
+    Summary summarize() const;
+
+    static int bucketOf(uint64_t value);
+    static uint64_t bucketUpperBound(int bucket);
+
+private:
+    std::atomic<uint64_t> buckets[BUCKET_COUNT];
+    std::atomic<uint64_t> count;
+    std::atomic<uint64_t> sum;
+    std::atomic<uint64_t> max;
+};
+
+// Process-wide pipeline metrics: one latency histogram per stage, per-frame
+// value histograms, and monotonic counters. Timers and counters are no-ops
+// (one relaxed load) until setEnabled(true).
+class Metrics {
+public:
+    enum class Stage {
+        Decode,           // reading a frame from the source
+        MotionGate,       // motion analysis before the detector
+        Preprocess,       // frame -> input tensor
+        Forward,          // network forward pass
+        OutputDecode,     // raw outputs -> candidate boxes
+        Nms,
+        Predict,          // Kalman prediction / propagation
+        CostMatrix,       // gating: admissible pairs and their IoU cost
+        Assignment,       // components and assignment solves
+        TrackManagement,  // updates, births, deaths, confirmed list
+        Render,           // drawing annotations
+        Encode,           // video encoding
+        Write,            // text and binary result logs
+        EndToEnd,         // decode start -> handed to the output sinks
+        Count
+    };
+
+    enum class Value {
+        DetectionsPerFrame,
+        TracksPerFrame,
+        Count
+    };
+
+    enum class Counter {
+        Frames,           // frames that went through the tracker
+        Detections,
+        Births,           // tracks created
+        Deaths,           // tracks removed
+        DroppedFrames,    // frames skipped by a saturated stage or sink
+        MotionSkippedFrames,  // detector frames skipped by the motion gate
+        RegionFrames,     // detector frames that saw only motion regions
+        Count
+    };
+
+    static Metrics& global();
+
+    void setEnabled(bool enabled) { active.store(enabled, std::memory_order_relaxed); }
+    bool isEnabled() const { return active.load(std::memory_order_relaxed); }
+
+    void recordLatency(Stage stage, uint64_t nanoseconds) {
+        if (isEnabled()) {
+            latencies[static_cast<int>(stage)].record(nanoseconds);
+        }
+    }
+    void recordValue(Value value, uint64_t sample) {
+        if (isEnabled()) {
+            values[static_cast<int>(value)].record(sample);
+        }
+    }
+    void add(Counter counter, uint64_t amount = 1) {
+        if (isEnabled()) {
+            counters[static_cast<int>(counter)].fetch_add(amount, std::memory_order_relaxed);
+        }
+    }
+
+    const Histogram& getLatency(Stage stage) const { return latencies[static_cast<int>(stage)]; }
+    const Histogram& getValue(Value value) const { return values[static_cast<int>(value)]; }
+    uint64_t getCounter(Counter counter) const {
+        return counters[static_cast<int>(counter)].load(std::memory_order_relaxed);
+    }
+
+    static const char* stageName(Stage stage);
+    static const char* valueName(Value value);
+    static const char* counterName(Counter counter);
+
+    // Snapshot exports. Latencies are in milliseconds in JSON and in seconds
+    // (Prometheus convention) in the text format.
+    void writeJson(std::ostream& out) const;
+    void writePrometheus(std::ostream& out) const;
+
+    // Human-readable per-stage table (stages with samples only)
+    void printSummary(std::ostream& out) const;
+    
+    // Clears all samples and counters, e.g. between sweep configurations.
+    // Samples recorded concurrently may survive the reset.
+    void reset();
+
+private:
+    Metrics();
+
+    std::atomic<bool> active;
+    std::chrono::steady_clock::time_point created;
+    Histogram latencies[static_cast<int>(Stage::Count)];
+    Histogram values[static_cast<int>(Value::Count)];
+    std::atomic<uint64_t> counters[static_cast<int>(Counter::Count)];
+};
+
+// Records the time from construction to stop() (or destruction) as one
+// sample of a stage. Reads the clock only while metrics are enabled.
+class ScopedTimer {
+public:
+    explicit ScopedTimer(Metrics::Stage stage)
+        : stage(stage), running(Metrics::global().isEnabled()) {
+        if (running) {
+            start = std::chrono::steady_clock::now();
+        }
+    }
+    ~ScopedTimer() { stop(); }
+
+    ScopedTimer(const ScopedTimer&) = delete;
+    ScopedTimer& operator=(const ScopedTimer&) = delete;
+
+    void stop() {
+        if (running) {
+            running = false;
+            auto elapsed = std::chrono::steady_clock::now() - start;
+            Metrics::global().recordLatency(stage, static_cast<uint64_t>(
+                std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()));
+        }
+    }
+
+private:
+    Metrics::Stage stage;
+    bool running;
+    std::chrono::steady_clock::time_point start;
+};
+
+// Background thread that rewrites a metrics file every interval, as JSON or
+// in the Prometheus text exposition format (for node_exporter's textfile
+// collector). Each export goes to "<path>.tmp" and is renamed over the
+// target, so readers never see a partial file. A final export is written
+// on stop().
+class MetricsExporter {
+public:
+    enum class Format {
+        Json,
+        Prometheus
+    };
+
+    MetricsExporter(const std::string& path, Format format, double intervalSeconds);
+    ~MetricsExporter();
+
+    MetricsExporter(const MetricsExporter&) = delete;
+    MetricsExporter& operator=(const MetricsExporter&) = delete;
+
+    void stop();
+    bool exportNow();
+
+    static Format parseFormat(const std::string& name);
+
+private:
+    std::string path;
+    Format format;
+    std::chrono::milliseconds interval;
+
+    std::mutex mutex;
+    std::condition_variable wake;
+    bool stopping = false;
+    std::thread worker;
+};
+
+#endif // METRICS_H
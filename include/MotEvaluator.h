@@ -0,0 +1,96 @@
+#ifndef MOT_EVALUATOR_H
+#define MOT_EVALUATOR_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <string>
+#include <unordered_map>
+#include <vector>
+#include "HungarianAlgorithm.h"
+#include "Track.h"
+
+// Scores tracker output against MOTChallenge ground truth (gt.txt) with the
+// CLEAR MOT and identity metrics, following the MOTChallenge devkit:
+//  - a hypothesis can match a ground-truth box at IoU >= 0.5
+//  - correspondences from earlier frames are kept while still valid; the
+//    rest are assigned by minimum total (1 - IoU)
+//  - a ground-truth object matched to a different id than at its previous
+//    match counts as an ID switch
+//  - hypotheses that match ignored boxes (consider flag 0, or a class that
+//    is not evaluated, such as distractors) are discarded
+// IDF1 uses the best one-to-one matching of ground-truth and hypothesis
+// identities over the whole sequence. Only frames passed to addFrame() are
+// scored.
+class MotEvaluator {
+public:
+    struct Summary {
+        int frames = 0;
+        int groundTruth = 0;         // evaluated ground-truth boxes
+        int hypotheses = 0;          // tracker boxes, after discarding ignored matches
+        int matches = 0;
+        int falsePositives = 0;
+        int misses = 0;
+        int idSwitches = 0;
+        double mota = 0.0;
+        double motp = 0.0;           // mean IoU of the matches
+        double idf1 = 0.0;
+        double idPrecision = 0.0;
+        double idRecall = 0.0;
+    };
+
+    // Loads gt.txt ("frame,id,x,y,w,h,consider,class,visibility", 1-based
+    // frames). Rows whose class column is present and not in evaluatedClasses
+    // (MOTChallenge: 1 = pedestrian) are ignored. Returns false if the file
+    // cannot be read.
+    bool loadGroundTruth(const std::string& path, const std::vector<int>& evaluatedClasses = {1});
+
+    int getFrameCount() const { return static_cast<int>(groundTruth.size()); }
+
+    // Tracker output for a frame (0-based index, gt.txt frame - 1). Frames
+    // must be added in increasing order.
+    void addFrame(int frameIndex, const std::vector<Track>& tracks);
+
+    Summary summarize() const;
+
+    // Forgets all tracker output; the ground truth stays loaded
+    void reset();
+
+private:
+    struct Box {
+        int id;
+        cv::Rect bbox;
+        bool ignored;
+    };
+
+    static constexpr float MIN_IOU = 0.5f;
+
+    std::vector<std::vector<Box>> groundTruth;   // by frame index
+
+    // CLEAR MOT state
+    Summary totals;
+    double iouSum = 0.0;
+    std::unordered_map<int, int> lastMatch;      // ground-truth id -> hypothesis id
+
+    // Identity state: frames in which each (ground truth, hypothesis) id
+    // pair overlaps
+    std::unordered_map<uint64_t, int> pairFrames;
+
+    // Per-frame scratch
+    std::vector<Box> hypotheses;
+    std::vector<int> truthMatch;
+    std::vector<char> hypothesisUsed;
+    std::vector<int> rowIndex;
+    std::vector<int> columnIndex;
+    std::vector<float> cost;
+    std::vector<int> assignment;
+    HungarianAlgorithm solver;
+
+    // Assigns rows to columns by minimum total (1 - IoU) among pairs with
+    // IoU >= MIN_IOU; assignment[r] is the matched column or -1
+    void matchBoxes(const std::vector<const cv::Rect*>& rows,
+                    const std::vector<const cv::Rect*>& columns);
+
+    static float iou(const cv::Rect& a, const cv::Rect& b);
+};
+
+#endif // MOT_EVALUATOR_H
@@ -0,0 +1,86 @@
+#ifndef MOTION_GATE_H
+#define MOTION_GATE_H
+
+#include <opencv2/opencv.hpp>
+#include <cstdint>
+#include <vector>
+
+// Decides, before the detector runs, how much of a frame it needs to see.
+// Meant for fixed cameras, whose scenes are mostly static.
+//
+// Each frame is shrunk to analysisWidth, converted to gray and compared
+// with a running-average background. Changed pixels form motion regions.
+// They are joined with the tracker's latest boxes, grown by a margin and
+// merged until no two overlap. Then:
+//  - Skip: nothing moved. The detector is not run and tracks are propagated.
+//  - Regions: run the detector only on the regions
+//    (YOLODetector::detectRegions).
+//  - FullFrame: the regions cover too much of the frame, the background is
+//    new, or a periodic refresh is due. The last one finds objects that
+//    entered while the gate was not looking, or that never moved.
+class MotionGate {
+public:
+    struct Options {
+        bool enabled = false;
+        int analysisWidth = 160;          // pixels; height follows the aspect ratio
+        int pixelThreshold = 25;          // gray-level change counted as motion
+        float minArea = 0.001f;           // smallest motion region, fraction of the frame
+        float backgroundRate = 0.05f;     // background update weight per analyzed frame
+        float margin = 0.25f;             // regions grow by this fraction of their size per side
+        float maxCoverage = 0.5f;         // above this fraction of the frame: full frame
+        int maxRegions = 8;               // more regions than this: full frame
+        int refreshInterval = 150;        // full frame at least every N analyzed frames (0 = never)
+    };
+
+    enum class Decision {
+        Skip,
+        Regions,
+        FullFrame
+    };
+
+    struct Stats {
+        int64_t skipped = 0;
+        int64_t regions = 0;
+        int64_t fullFrames = 0;
+    };
+
+    MotionGate() = default;
+    explicit MotionGate(const Options& options) : options(options) {}
+
+    bool isEnabled() const { return options.enabled; }
+
+    // Analyzes a frame the detector is due to see and updates the
+    // background. trackBoxes are the tracker's latest boxes, in frame
+    // pixels. With force set, the frame is never skipped: if nothing moved,
+    // the tracked boxes alone are detected. For Regions, regions receives
+    // disjoint rectangles inside the frame.
+    Decision analyze(const cv::Mat& frame, const std::vector<cv::Rect>& trackBoxes, bool force,
+                     std::vector<cv::Rect>& regions);
+
+    // Forgets the background; the next frame is a full frame
+    void reset();
+
+    const Stats& getStats() const { return stats; }
+
+private:
+    Options options;
+    Stats stats;
+    int sinceRefresh = 0;
+
+    // Scratch and state at analysis resolution
+    cv::Mat small;
+    cv::Mat gray;
+    cv::Mat background;                   // CV_32F running average
+    cv::Mat background8u;
+    cv::Mat difference;
+    cv::Mat mask;
+    std::vector<std::vector<cv::Point>> contours;
+
+    Decision record(Decision decision);
+
+    // Grows each box by margin, clips it to the frame and merges
+    // overlapping boxes until all are disjoint
+    void mergeRegions(std::vector<cv::Rect>& regions, const cv::Size& frameSize) const;
+};
+
+#endif // MOTION_GATE_H
@@ -0,0 +1,76 @@
+#ifndef NON_MAX_SUPPRESSOR_H
+#define NON_MAX_SUPPRESSOR_H
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+
+// Greedy non-maximum suppression over candidate arrays, returning the
+// indices of the kept candidates (boxes are never copied).
+//
+// Candidates above the score threshold are sorted by score (optionally only
+// the top K, by partial sort) and visited in that order. Each one is tested
+// only against the boxes already kept and dropped at the first overlap, and
+// the pass stops once maxDetections boxes are kept.
+//
+// PerClass suppresses only within a class, in one pass over all classes:
+// boxes of different classes never overlap, as if each class had been
+// shifted into its own region of the plane (the "batched offset" trick).
+// ClassAgnostic suppresses across classes, like a single cv::dnn::NMSBoxes
+// call.
+//
+// With useGrid, kept boxes are bucketed in a uniform grid and a candidate
+// only visits the kept boxes in the cells it covers. That helps in dense
+// scenes where thousands of boxes survive.
+class NonMaxSuppressor {
+public:
+    enum class Mode {
+        PerClass,
+        ClassAgnostic
+    };
+
+    struct Options {
+        Mode mode = Mode::PerClass;
+        int topK = 0;              // candidates considered (0 = all)
+        int maxDetections = 0;     // boxes kept (0 = no limit)
+        bool useGrid = false;
+    };
+
+    NonMaxSuppressor() = default;
+    explicit NonMaxSuppressor(const Options& options) : options(options) {}
+
+    void setOptions(const Options& options) { this->options = options; }
+    const Options& getOptions() const { return options; }
+
+    // Keeps candidates with score > scoreThreshold that overlap no
+    // higher-scoring kept box by IoU > iouThreshold. classIds may be null in
+    // ClassAgnostic mode. keep receives indices in descending score order.
+    void run(const cv::Rect* boxes, const float* scores, const int* classIds, int count,
+             float scoreThreshold, float iouThreshold, std::vector<int>& keep);
+
+    static Mode parseMode(const std::string& name);
+
+private:
+    Options options;
+
+    // Scratch buffers, reused across calls
+    std::vector<int> order;
+    std::vector<int> areas;
+
+    // Grid of kept boxes: per-cell singly linked lists
+    std::vector<int> cellHead;
+    std::vector<int> entryNext;
+    std::vector<int> entryBox;
+    std::vector<int> visitStamp;
+
+    void sortCandidates(const float* scores, int count, float scoreThreshold);
+    bool overlapsKept(const cv::Rect* boxes, const int* classIds, int candidate,
+                      const std::vector<int>& keep, float iouThreshold) const;
+    void runGrid(const cv::Rect* boxes, const int* classIds, float iouThreshold,
+                 std::vector<int>& keep);
+
+    bool suppresses(const cv::Rect* boxes, const int* classIds, int kept, int candidate,
+                    float iouThreshold) const;
+};
+
+#endif // NON_MAX_SUPPRESSOR_H
@@ -0,0 +1,49 @@
+#ifndef ONNX_RUNTIME_BACKEND_H
+#define ONNX_RUNTIME_BACKEND_H
+
+#include <onnxruntime_cxx_api.h>
+#include <memory>
+#include <string>
+#include <vector>
+#include "InferenceBackend.h"
+
+// ONNX Runtime on the CPU execution provider. Built only with
+// -DMOT_WITH_ONNXRUNTIME=ON.
+//
+// Two output layouts are accepted and converted to region rows:
+//  - region outputs, [N, rows, 5 + classes] or [rows, 5 + classes], as
+//    exported with the Darknet head;
+//  - a boxes / confs pair, [N, rows, 1, 4] corner boxes (x1, y1, x2, y2,
+//    relative) and [N, rows, classes] scores. Objectness becomes the best
+//    class score.
+// A model exported with a fixed batch size gets padded batches. A fixed
+// input size overrides the configured input size. quantize() is not
+// supported; for INT8, load a statically quantized (QDQ) ONNX model.
+class OnnxRuntimeBackend : public InferenceBackend {
+public:
+    OnnxRuntimeBackend(const std::string& modelPath, const Options& options);
+
+    bool isLoaded() const override { return session != nullptr; }
+    const char* getName() const override { return "onnxruntime"; }
+    InputShape getInputShape() const override { return inputShape; }
+    void forward(const cv::Mat& blob, std::vector<cv::Mat>& outputs) override;
+
+private:
+    std::unique_ptr<Ort::Session> session;
+    Ort::MemoryInfo memoryInfo;
+    std::string inputName;
+    std::vector<std::string> outputNames;
+    InputShape inputShape;
+
+    // Batch padded up to a fixed model batch size
+    std::vector<float> padded;
+
+    // Region rows of an output tensor of `images` images (first `keep` kept)
+    static void toRegion(const Ort::Value& value, int images, int keep, cv::Mat& output);
+
+    // Region rows from a boxes / confs pair
+    static void toRegion(const Ort::Value& boxes, const Ort::Value& confs, int images, int keep,
+                         cv::Mat& output);
+};
+
+#endif // ONNX_RUNTIME_BACKEND_H
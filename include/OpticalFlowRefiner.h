@@ -0,0 +1,40 @@
+#ifndef OPTICAL_FLOW_REFINER_H
+#define OPTICAL_FLOW_REFINER_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+
+// Cheap box refinement for frames where the detector is skipped.
+// Tracks a small grid of points inside each box from the previous frame to
+// the current one with pyramidal Lucas-Kanade and shifts the box by the
+// median point motion.
+class OpticalFlowRefiner {
+public:
+    explicit OpticalFlowRefiner(int gridSize = 4, float maxError = 20.0f);
+
+    // Pushes a new (BGR) frame; the previous one becomes the flow source
+    void setFrame(const cv::Mat& frame);
+
+    // True once two frames are available
+    bool isReady() const { return !previousGray.empty() && !currentGray.empty(); }
+
+    // Box on the current frame for a box on the previous frame.
+    // Returns false if too few points could be tracked.
+    bool refine(const cv::Rect& previous, cv::Rect& refined);
+
+private:
+    int gridSize;
+    float maxError;
+    cv::Mat previousGray;
+    cv::Mat currentGray;
+
+    // Scratch buffers reused across calls
+    std::vector<cv::Point2f> previousPoints;
+    std::vector<cv::Point2f> currentPoints;
+    std::vector<uchar> status;
+    std::vector<float> errors;
+    std::vector<float> dxs;
+    std::vector<float> dys;
+};
+
+#endif // OPTICAL_FLOW_REFINER_H
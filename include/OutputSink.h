@@ -0,0 +1,130 @@
+#ifndef OUTPUT_SINK_H
+#define OUTPUT_SINK_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <cstdint>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <vector>
+#include "BoundedQueue.h"
+#include "FrameResult.h"
+
+// Destination for tracking results (files, encoders, ...).
+// write() is called once per frame, in frame order, from a single thread;
+// close() flushes and releases the output and is safe to call twice.
+class OutputSink {
+public:
+    virtual ~OutputSink() = default;
+
+    virtual void write(const FrameResult& result) = 0;
+    virtual void close() = 0;
+
+    // True if the sink draws trajectories, so producers can skip copying them
+    virtual bool wantsTrajectories() const { return false; }
+};
+
+// Sink whose work runs on its own thread behind a bounded queue, so slow
+// disks or encoders never stall the tracking pipeline. With dropWhenFull a
+// full queue drops the frame (counted in getDropped()); otherwise write()
+// waits, which is what lossless logs need. Sinks that never look at the
+// image pass keepFrame = false so queued frames do not pin decoded images.
+//
+// Derived classes call start() at the end of their constructor and close()
+// in their destructor, before their own members are destroyed.
+class AsyncSink : public OutputSink {
+public:
+    AsyncSink(size_t queueCapacity, bool dropWhenFull, bool keepFrame);
+    ~AsyncSink() override;
+
+    void write(const FrameResult& result) override;
+    void close() override;
+
+    int getDropped() const { return dropped; }
+
+protected:
+    void start();
+
+    // Called on the sink thread for every queued frame, then once at the end
+    virtual void consume(const FrameResult& result) = 0;
+    virtual void finish() {}
+
+private:
+    BoundedQueue<FrameResult> queue;
+    bool dropWhenFull;
+    bool keepFrame;
+    std::atomic<int> dropped{0};
+    std::thread worker;
+};
+
+// MOTChallenge text format, one line per track and frame:
+// <frame>,<id>,<x>,<y>,<w>,<h>,1,-1,-1,-1 with 1-based frame numbers
+class MotTextSink : public AsyncSink {
+public:
+    explicit MotTextSink(const std::string& path);
+    ~MotTextSink() override;
+
+    bool isOpen() const { return file.is_open(); }
+
+protected:
+    void consume(const FrameResult& result) override;
+    void finish() override;
+
+private:
+    std::ofstream file;
+    std::vector<char> buffer;
+};
+
+// Compact binary track log, streamed as frames arrive. int32 fields in host
+// byte order throughout:
+//   header  "MOTL", version
+//   frame   index (0-based), count, then count x (id, classId, x, y, w, h)
+class BinaryTrackSink : public AsyncSink {
+public:
+    static const int VERSION = 1;
+
+    explicit BinaryTrackSink(const std::string& path);
+    ~BinaryTrackSink() override;
+
+    bool isOpen() const { return file.is_open(); }
+
+protected:
+    void consume(const FrameResult& result) override;
+    void finish() override;
+
+private:
+    std::ofstream file;
+    std::vector<char> buffer;
+    std::vector<int32_t> record;
+};
+
+// Annotated video, encoded on the sink thread. scale < 1 downsizes the
+// frames before drawing and encoding; everyNth > 1 keeps only every Nth
+// frame (the output frame rate is lowered to match). Frames are dropped,
+// never queued without limit, when the encoder falls behind.
+class VideoSink : public AsyncSink {
+public:
+    VideoSink(const std::string& path, double fps, double scale = 1.0, int everyNth = 1);
+    ~VideoSink() override;
+
+    void write(const FrameResult& result) override;
+    bool wantsTrajectories() const override { return true; }
+
+protected:
+    void consume(const FrameResult& result) override;
+    void finish() override;
+
+private:
+    std::string path;
+    double fps;
+    double scale;
+    int everyNth;
+    cv::VideoWriter writer;
+    bool openFailed = false;
+    cv::Mat canvas;
+    std::vector<cv::Scalar> colors;
+    std::vector<cv::Point> scaledTrajectory;
+};
+
+#endif // OUTPUT_SINK_H
@@ -0,0 +1,35 @@
+#ifndef SCRATCH_VECTOR_H
+#define SCRATCH_VECTOR_H
+
+#include <algorithm>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+// Helpers for per-frame scratch vectors that live across frames.
+// std::vector::assign() and reserve() reallocate to the exact size, so a
+// slowly rising peak (one more track than ever before) would reallocate on
+// every new peak. These grow the capacity geometrically instead; once the
+// peak is reached, reuse never touches the heap.
+
+template <typename T>
+inline void reserveScratch(std::vector<T>& buffer, size_t size) {
+    if (size > buffer.capacity()) {
+        buffer.reserve(std::max(size, 2 * buffer.capacity()));
+    }
+}
+
+template <typename T>
+inline void assignScratch(std::vector<T>& buffer, size_t size,
+                          const typename std::vector<T>::value_type& value) {
+    reserveScratch(buffer, size);
+    buffer.assign(size, value);
+}
+
+template <typename T, typename Iterator>
+inline void copyScratch(std::vector<T>& buffer, Iterator first, Iterator last) {
+    reserveScratch(buffer, static_cast<size_t>(std::distance(first, last)));
+    buffer.assign(first, last);
+}
+
+#endif // SCRATCH_VECTOR_H
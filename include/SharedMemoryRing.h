@@ -0,0 +1,112 @@
+#ifndef SHARED_MEMORY_RING_H
+#define SHARED_MEMORY_RING_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include "FrameSource.h"
+
+// Ring of decoded frames in a POSIX shared-memory object, written by one
+// producer process and read by one consumer (mot_tracker with source
+// "shm:<name>"). The object holds a SharedMemoryRingHeader followed by
+// slotCount frame slots; frame n lives in slot n % slotCount.
+//
+// The producer increments `started`, fills the slot and then increments
+// `written`.
+//  - Blocking rings (offline producers): the consumer hands out frames as
+//    cv::Mat views of their slots and keeps the last holdFrames of them
+//    valid (frames still in the pipeline): it publishes `released` = frames
+//    read - holdFrames. The producer waits for a consumer and never
+//    overwrites a frame that is not released, so no frame is lost.
+//  - Non-blocking rings (live sources): the producer never waits and may
+//    overwrite any slot, so the consumer copies each frame out. A copy the
+//    producer started overwriting meanwhile (per `started`) is discarded.
+//    A consumer that falls a whole ring behind skips to the newest frame
+//    and counts the skipped ones as dropped. holdFrames does not apply.
+// Both sides poll; a waiting read() sleeps POLL_INTERVAL between checks.
+struct SharedMemoryRingHeader {
+    static const uint32_t VERSION = 2;
+    static const uint32_t BLOCKING = 1;
+
+    char magic[4];                       // "MOTR"
+    uint32_t version;
+    uint32_t width;
+    uint32_t height;
+    uint32_t type;                       // OpenCV type, CV_8UC3 (BGR)
+    uint32_t step;                       // bytes per row
+    uint32_t slotCount;
+    uint32_t flags;
+    uint64_t slotBytes;
+    uint64_t dataOffset;                 // first slot, from the start of the object
+    double fps;
+    std::atomic<uint64_t> started;       // frames the producer began writing
+    std::atomic<uint64_t> written;       // frames published
+    std::atomic<uint64_t> released;      // frames the consumer no longer uses
+    std::atomic<uint32_t> consumers;     // attached consumers (0 or 1)
+    std::atomic<uint32_t> closed;        // producer finished
+};
+
+// Consumer side
+class SharedMemoryFrameSource : public FrameSource {
+public:
+    // name without the leading '/'; on a blocking ring holdFrames must be
+    // below the slot count
+    SharedMemoryFrameSource(const std::string& name, int holdFrames);
+    ~SharedMemoryFrameSource() override;
+
+    SharedMemoryFrameSource(const SharedMemoryFrameSource&) = delete;
+    SharedMemoryFrameSource& operator=(const SharedMemoryFrameSource&) = delete;
+
+    // Waits for the next frame; false once the producer has closed the ring
+    // and every frame was read, or after interrupt()
+    bool read(cv::Mat& frame) override;
+
+    bool isOpened() const override { return header != nullptr; }
+    cv::Size getFrameSize() const override;
+    double getFps() const override { return header ? header->fps : 0.0; }
+    bool isLive() const override { return true; }
+    int64_t getDropped() const override { return dropped; }
+    void interrupt() override { interrupted = true; }
+
+private:
+    SharedMemoryRingHeader* header = nullptr;
+    unsigned char* mapping = nullptr;
+    size_t mappingSize = 0;
+    uint64_t holdFrames;                 // blocking rings only
+    uint64_t next = 0;                   // next frame to hand out
+    int64_t dropped = 0;
+    std::atomic<bool> interrupted{false};
+
+    // Frame frameNumber's slot, as a view
+    cv::Mat slotView(uint64_t frameNumber) const;
+};
+
+// Producer side: creates (or replaces) the shared-memory object and removes
+// it again on destruction
+class SharedMemoryFrameWriter {
+public:
+    SharedMemoryFrameWriter(const std::string& name, const cv::Size& frameSize, double fps,
+                            int slotCount, bool blocking);
+    ~SharedMemoryFrameWriter();
+
+    SharedMemoryFrameWriter(const SharedMemoryFrameWriter&) = delete;
+    SharedMemoryFrameWriter& operator=(const SharedMemoryFrameWriter&) = delete;
+
+    bool isOpen() const { return header != nullptr; }
+
+    // Copies a BGR frame of the ring's size into the next slot and publishes
+    // it. Blocking rings wait for a consumer and for a released slot.
+    bool write(const cv::Mat& frame);
+
+    // Marks the end of the stream; the consumer drains the ring and stops
+    void close();
+
+private:
+    std::string name;
+    SharedMemoryRingHeader* header = nullptr;
+    unsigned char* mapping = nullptr;
+    size_t mappingSize = 0;
+};
+
+#endif // SHARED_MEMORY_RING_H
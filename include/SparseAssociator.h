@@ -0,0 +1,86 @@
+#ifndef SPARSE_ASSOCIATOR_H
+#define SPARSE_ASSOCIATOR_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include "Detection.h"
+#include "HungarianAlgorithm.h"
+
+// Track/detection association that only looks at pairs that can match.
+//
+// 1. Gating: detections are binned into a uniform grid (cell ~ typical box
+//    size); each predicted track box only visits the cells it covers, so
+//    candidate pairs (same class, IoU cost below the threshold) are found in
+//    near-linear time instead of testing every pair.
+// 2. Components: candidate pairs link tracks and detections into connected
+//    components (union-find). Components share no candidate edge, so each
+//    one is an independent assignment problem.
+// 3. Solving: every component is solved exactly on its own small dense
+//    matrix, warm-started with the tracks' duals from the last frame and
+//    each track's cheapest candidate in this one.
+class SparseAssociator {
+public:
+    struct Candidate {
+        int track;
+        int detection;
+        float cost;      // 1 - IoU
+    };
+
+    // trackBoxes/trackClassIds: numTracks predicted boxes and classes.
+    // duals: per-track row duals (see HungarianAlgorithm), read as the warm
+    //   start and updated in place; nullptr solves every component cold.
+    // A pair is admissible if the classes match and 1 - IoU < maxCost.
+    void associate(const cv::Rect* trackBoxes, const int* trackClassIds, int numTracks,
+                   float* duals,
+                   const std::vector<Detection>& detections, float maxCost,
+                   std::vector<int>& matchedTracks,
+                   std::vector<int>& matchedDetections,
+                   std::vector<int>& unmatchedTracks,
+                   std::vector<int>& unmatchedDetections);
+
+    // Gating step alone: admissible pairs, grouped by track
+    void findCandidates(const cv::Rect* trackBoxes, const int* trackClassIds, int numTracks,
+                        const std::vector<Detection>& detections, float maxCost,
+                        std::vector<Candidate>& candidates);
+
+    // Intersection over union of two boxes
+    static float calculateIoU(const cv::Rect& box1, const cv::Rect& box2);
+
+    int getLastComponentCount() const { return lastComponentCount; }
+
+private:
+    HungarianAlgorithm solver;
+    int lastComponentCount = 0;
+
+    // Grid buckets in CSR form: detections of cell c are
+    // cellItems[cellStart[c] .. cellStart[c + 1])
+    std::vector<int> cellStart;
+    std::vector<int> cellItems;
+    std::vector<int> visitStamp;        // last track that tested detection j
+
+    std::vector<Candidate> candidates;
+
+    // Union-find over tracks [0, numTracks) and detections after them
+    std::vector<int> parent;
+
+    // Component grouping (CSR by component root)
+    std::vector<int> componentOf;
+    std::vector<int> componentStart;
+    std::vector<int> componentNodes;
+    std::vector<int> componentEdgeStart;
+    std::vector<int> componentEdges;
+
+    // Per-component dense problem
+    std::vector<int> localIndex;        // node -> row/column inside its component
+    std::vector<int> localTracks;
+    std::vector<int> localDetections;
+    std::vector<float> localCost;
+    std::vector<float> localDuals;
+    std::vector<int> localAssignment;
+    std::vector<char> detectionMatched;
+
+    int find(int node);
+    void unite(int a, int b);
+};
+
+#endif // SPARSE_ASSOCIATOR_H
@@ -0,0 +1,176 @@
+#ifndef STREAM_SERVER_H
+#define STREAM_SERVER_H
+
+#include <opencv2/opencv.hpp>
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <deque>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+#include "Detection.h"
+#include "FrameSource.h"
+#include "Int8Calibrator.h"
+#include "LatencyController.h"
+#include "MotionGate.h"
+#include "Tracker.h"
+#include "YOLODetector.h"
+
+// Tracks many video sources in one process.
+//
+// Every stream has its own decode thread and its own Tracker. Detection is
+// served by a small pool of workers shared by all streams; each worker owns
+// one network, so memory grows with the number of workers, not streams.
+// One worker batching frames across streams is the recommended setup: a
+// batch takes only the frames already waiting, so it adds no latency, and
+// further workers pay for a full copy of the weights and activations each.
+//
+// Scheduling is fair-share: workers take frames round-robin across streams,
+// at most one frame per stream per batch, and a stream with a frame in
+// flight is skipped so its frames are tracked in order. Each stream keeps
+// only the newest queueDepth decoded frames; when the pool is saturated the
+// oldest frame is dropped, so a busy server lowers every stream's frame
+// rate instead of adding latency. With dropFrames off (offline files) the
+// decoder waits instead.
+//
+// With the motion gate on, each stream has its own MotionGate. Frames where
+// nothing moved skip the detector, and frames with little motion are
+// detected on their regions alone; only full frames share a batch.
+//
+// With a latency budget, one LatencyController watches the end-to-end
+// latency of every frame. Waiting for a worker is part of that latency, so
+// it grows with the number of streams sharing the pool. The controller sets
+// the input size of all detectors and a detection stride for all streams;
+// frames off the stride only propagate their stream's tracks.
+class StreamServer {
+public:
+    struct Options {
+        int detectorWorkers = 1;     // networks / worker threads
+        int batchSize = 4;           // max frames (from distinct streams) per forward pass
+        int queueDepth = 2;          // decoded frames kept per stream
+        bool dropFrames = true;      // false: block the decoder when the queue is full
+        float confThreshold = 0.5f;
+        float nmsThreshold = 0.4f;
+        float maxIoUDistance = 0.7f;
+        int maxAge = 30;
+        int minHits = 3;
+        std::vector<int> trackClasses;   // empty = all classes
+        NonMaxSuppressor::Options nmsOptions;
+        bool letterbox = false;
+        int inputSize = 416;
+        YOLODetector::TileOptions tiling;
+        InferenceBackend::Options backend;
+        FrameSource::Options sourceOptions;
+        MotionGate::Options motionGate;
+        LatencyController::Options latency;
+        int trajectoryLength = 30;
+        int trajectorySampleInterval = 1;
+    };
+
+    struct StreamStats {
+        int decoded = 0;
+        int processed = 0;
+        int dropped = 0;
+        MotionGate::Stats gate;       // zero unless the motion gate is on
+    };
+
+    // Called on a worker thread after a frame has been tracked. Calls for the
+    // same stream never overlap and arrive in decode order; tracks are valid
+    // only during the call.
+    using ResultCallback = std::function<void(int stream, int frameIndex, cv::Mat& frame,
+                                              const std::vector<Track>& tracks)>;
+
+    StreamServer(const std::string& modelPath, const std::string& configPath,
+                 const std::string& classesPath, const Options& options);
+    ~StreamServer();
+
+    StreamServer(const StreamServer&) = delete;
+    StreamServer& operator=(const StreamServer&) = delete;
+
+    bool isLoaded() const;
+    
+    // Switches every detector worker to INT8; call before run(). Returns
+    // false if any worker stays in FP32.
+    bool quantize(Int8Calibrator& calibrator);
+
+    // Opens a source (see FrameSource::open); returns the stream id or -1 if
+    // it cannot be opened. Streams must be added before run().
+    int addStream(const std::string& source);
+
+    // Processes all streams until they end or stop() is called
+    void run(const ResultCallback& onResult);
+
+    void stop();
+
+    int getStreamCount() const { return static_cast<int>(streams.size()); }
+    const std::string& getSource(int stream) const { return streams[stream]->source; }
+    double getInputFps(int stream) const { return streams[stream]->fps; }
+    StreamStats getStats(int stream) const;
+    int getTotalTracks(int stream) const { return streams[stream]->tracker.getTotalTracks(); }
+    const std::string& getClassName(int classId) const { return detectors[0]->getClassName(classId); }
+    
+    // Level changes and current level; read after run()
+    const LatencyController& getLatencyController() const { return latency; }
+
+private:
+    struct Job {
+        int stream;
+        int index;
+        cv::Mat frame;
+        MotionGate::Decision decision = MotionGate::Decision::FullFrame;
+        std::vector<cv::Rect> regions;
+        std::chrono::steady_clock::time_point decodeStart;
+    };
+
+    struct Stream {
+        std::string source;
+        std::unique_ptr<FrameSource> capture;
+        double fps = 0.0;             // as reported by the source (0 if unknown)
+        Tracker tracker;
+        MotionGate gate;              // used only by the worker holding the stream
+        std::vector<cv::Rect> trackBoxes;   // latest tracked boxes, for the gate
+        std::deque<Job> inbox;        // guarded by StreamServer::mutex
+        bool busy = false;            // a frame of this stream is in flight
+        bool finished = false;        // decoder reached the end
+        std::thread decodeThread;
+        std::atomic<int> decoded{0};
+        std::atomic<int> processed{0};
+        std::atomic<int> dropped{0};
+
+        Stream(const std::string& source, const Options& options)
+            : source(source),
+              tracker(options.maxIoUDistance, options.maxAge, options.minHits),
+              gate(options.motionGate) {
+            tracker.setTrajectoryPolicy(options.trajectoryLength, options.trajectorySampleInterval);
+        }
+    };
+
+    Options options;
+    std::vector<std::unique_ptr<YOLODetector>> detectors;
+    std::vector<std::unique_ptr<Stream>> streams;
+
+    std::mutex mutex;
+    std::condition_variable workAvailable;
+    std::condition_variable spaceAvailable;
+    size_t nextStream = 0;            // round-robin cursor
+    bool stopping = false;
+
+    LatencyController latency;        // guarded by latencyMutex
+    std::mutex latencyMutex;
+    std::atomic<int> activeInputSize;
+    std::atomic<int> activeStride;
+
+    void decodeLoop(int stream);
+    void workerLoop(YOLODetector& detector, const ResultCallback& onResult);
+
+    // Takes up to batchSize jobs from distinct idle streams; caller holds mutex
+    void takeJobs(std::vector<Job>& jobs);
+    bool hasWork() const;
+    bool allFinished() const;
+};
+
+#endif // STREAM_SERVER_H
@@ -3,47 +3,36 @@
 
 #include <opencv2/opencv.hpp>
 #include <vector>
-#include <deque>
-#include "KalmanFilter.h"
-
-enum class TrackState {
-    Tentative,
-    Confirmed,
-    Deleted
-};
+#include "TrackStore.h"
 
+// Lightweight read-only view of one track in a TrackStore.
+// Views are cheap to copy and are valid until the tracker's next
+// update()/propagate(), which may compact the store.
 class Track {
 public:
-    Track(const cv::Rect& bbox, int classId, const std::string& className, int trackId);
+    Track(const TrackStore& store, int slot) : store(&store), slot(slot) {}
     
-    void predict();
-    void update(const cv::Rect& bbox);
+    // Prior for the current frame and the posterior after this frame's
+    // correction (equal if the track was not corrected); both are cached
+    const cv::Rect& getPredictedBbox() const { return store->getPredictedBbox(slot); }
+    const cv::Rect& getCurrentBbox() const { return store->getBbox(slot); }
+    int getId() const { return store->getId(slot); }
+    int getClassId() const { return store->getClassId(slot); }
+    TrackState getState() const { return store->getState(slot); }
+    int getTimeSinceUpdate() const { return store->getTimeSinceUpdate(slot); }
+    int getHitStreak() const { return store->getHitStreak(slot); }
     
-    cv::Rect getPredictedBbox() const;
-    cv::Rect getCurrentBbox() const;
-    int getId() const { return id; }
-    int getClassId() const { return classId; }
-    std::string getClassName() const { return className; }
-    TrackState getState() const { return state; }
-    int getTimeSinceUpdate() const { return timeSinceUpdate; }
-    int getHitStreak() const { return hitStreak; }
-    std::vector<cv::Point> getTrajectory() const;
+    // Trajectory of detected centers, oldest first, as a view into the
+    // store's ring (no copy)
+    TrajectoryView getTrajectory() const;
     
-    void markMissed();
-    void markHit();
-    void setState(TrackState newState) { state = newState; }
+    // Distance between the estimated center and the last detected center,
+    // relative to the box size
+    float getDrift() const { return store->getDrift(slot); }
     
 private:
-    int id;
-    int classId;
-    std::string className;
-    KalmanFilter kf;
-    TrackState state;
-    int timeSinceUpdate;
-    int hitStreak;
-    int age;
-    std::deque<cv::Point> trajectory;
-    static const int MAX_TRAJECTORY_LENGTH = 30;
+    const TrackStore* store;
+    int slot;
 };
 
 #endif // TRACK_H
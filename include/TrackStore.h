@@ -0,0 +1,130 @@
+#ifndef TRACK_STORE_H
+#define TRACK_STORE_H
+
+#include <opencv2/opencv.hpp>
+#include <vector>
+#include "Detection.h"
+#include "KalmanFilter.h"
+#include "TrajectoryView.h"
+
+enum class TrackState {
+    Tentative,
+    Confirmed,
+    Deleted
+};
+
+// Structure-of-arrays storage for all live tracks.
+// Slot i of every array belongs to the same track; slots are dense
+// (0..size()-1) and are renumbered when dead tracks are compacted away, so
+// slot indices are only valid until the next removeStale().
+// Kalman means and covariances live in two contiguous float arrays and are
+// predicted/corrected in batches. Each track is predicted exactly once per
+// frame; the predicted (prior) and current (posterior) boxes are cached so
+// reading them never touches the filter.
+// Nothing is allocated per frame once the arrays have grown to the peak
+// track count: removed slots keep their capacity, trajectories are
+// fixed-size rings, and tracks store class ids rather than names.
+class TrackStore {
+public:
+    TrackStore(float processNoise = 1e-2f, float measurementNoise = 1e-1f);
+
+    int size() const { return static_cast<int>(ids.size()); }
+    bool empty() const { return ids.empty(); }
+    void reserve(size_t capacity);
+
+    // Trajectory ring size and downsampling: a new point is committed at
+    // most every sampleInterval updates, while the newest point always
+    // follows the latest detection. Existing histories keep their newest
+    // points.
+    void setTrajectoryPolicy(int length, int sampleInterval = 1);
+    int getTrajectoryCapacity() const { return trajectoryCapacity; }
+
+    // Appends a new tentative track; returns its slot
+    int add(const cv::Rect& bbox, int classId, int id);
+
+    // Kalman prediction for every track; the frame counts towards the age
+    // and time since update
+    void predictAll();
+
+    // Prediction-only step for frames without detections: the frame does
+    // not count as a miss
+    void propagateAll();
+
+    // Corrects slots[i] with detections[detectionIndices[i]].bbox
+    void update(const std::vector<int>& slots, const std::vector<int>& detectionIndices,
+                const std::vector<Detection>& detections);
+
+    // Corrects the filter with a non-detection measurement (e.g. optical
+    // flow); does not touch hit counters or the trajectory
+    void refine(int slot, const cv::Rect& bbox);
+
+    void markMissed(int slot);
+
+    // Removes tracks not updated for more than maxAge frames, compacting the
+    // arrays in place. Returns the number of removed tracks.
+    int removeStale(int maxAge);
+
+    // Per-slot accessors
+    int getId(int slot) const { return ids[slot]; }
+    int getClassId(int slot) const { return classIds[slot]; }
+    TrackState getState(int slot) const { return states[slot]; }
+    int getTimeSinceUpdate(int slot) const { return timeSinceUpdate[slot]; }
+    int getHitStreak(int slot) const { return hitStreaks[slot]; }
+    int getAge(int slot) const { return ages[slot]; }
+    const cv::Rect& getPredictedBbox(int slot) const { return predictedBoxes[slot]; }
+    const cv::Rect& getBbox(int slot) const { return boxes[slot]; }
+    
+    // Trajectory of detected centers, oldest first (no copy)
+    TrajectoryView getTrajectory(int slot) const {
+        return TrajectoryView(&trajectoryPoints[slot * trajectoryCapacity], trajectoryCapacity,
+                              trajectoryHeads[slot], trajectoryLengths[slot]);
+    }
+
+    // Contiguous per-slot arrays
+    const cv::Rect* getPredictedBboxes() const { return predictedBoxes.data(); }
+    const cv::Rect* getBboxes() const { return boxes.data(); }
+    const int* getClassIds() const { return classIds.data(); }
+
+    // Assignment warm-start state, one entry per slot: the solver's row dual
+    // from the last detector frame
+    float* getAssignmentDuals() { return assignmentDuals.data(); }
+
+    // Distance between the estimated center and the last detected center,
+    // relative to the box size
+    float getDrift(int slot) const;
+
+private:
+    float processNoise;
+    float measurementNoise;
+
+    std::vector<int> ids;
+    std::vector<int> classIds;
+    std::vector<TrackState> states;
+    std::vector<int> timeSinceUpdate;
+    std::vector<int> hitStreaks;
+    std::vector<int> ages;
+    std::vector<cv::Rect> predictedBoxes;    // prior of the current frame
+    std::vector<cv::Rect> boxes;             // posterior (= prior if uncorrected)
+    std::vector<float> means;                // size() * KalmanFilter::MEAN_SIZE
+    std::vector<float> covariances;          // size() * KalmanFilter::COV_SIZE
+    std::vector<cv::Point> trajectoryPoints;  // size() * trajectoryCapacity ring slots
+    std::vector<int> trajectoryHeads;         // ring index of the oldest point
+    std::vector<int> trajectoryLengths;
+    std::vector<int> trajectorySinceSample;   // updates since the last committed point
+    int trajectoryCapacity;
+    int trajectorySampleInterval;
+    std::vector<float> assignmentDuals;
+
+    // Scratch buffer for batched updates
+    std::vector<float> measurements;
+
+    static const int DEFAULT_TRAJECTORY_LENGTH = 30;
+
+    void refreshBox(int slot);
+    void refreshPrediction(int slot);
+    void pushTrajectory(int slot, const cv::Rect& bbox);
+    void moveSlot(int from, int to);
+    void resize(int count);
+};
+
+#endif // TRACK_STORE_H
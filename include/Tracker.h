@@ -2,32 +2,63 @@
 #define TRACKER_H
 
 #include <vector>
-#include <memory>
+#include <functional>
 #include "Track.h"
+#include "TrackStore.h"
 #include "Detection.h"
+#include "SparseAssociator.h"
+
+// Optional refinement for detector-free frames: given a track's box on the
+// previous frame, writes its box on the current frame and returns true, or
+// returns false to keep the pure Kalman prediction
+using BoxRefiner = std::function<bool(const cv::Rect& previous, cv::Rect& refined)>;
 
 class Tracker {
 public:
     Tracker(float maxIoUDistance = 0.7f, int maxAge = 30, int minHits = 3);
     
-    std::vector<std::shared_ptr<Track>> update(const std::vector<Detection>& detections);
+    // Returns views of the confirmed tracks, valid until the next
+    // update()/propagate(). Once the tracker has seen its peak track and
+    // detection counts, neither call allocates.
+    const std::vector<Track>& update(const std::vector<Detection>& detections);
+    
+    // Advances all tracks on a frame where the detector was skipped. Tracks
+    // move by Kalman prediction (plus the optional refiner) and are not
+    // counted as missed, so maxAge is measured in detector frames.
+    const std::vector<Track>& propagate(const BoxRefiner& refiner = nullptr);
+    
+    // True if any confirmed track has drifted more than maxDrift box sizes
+    // from its last detection, i.e. the detector should run again
+    bool isUncertain(float maxDrift) const;
+    
+    // Trajectory points kept per track, and downsampling interval (see
+    // TrackStore::setTrajectoryPolicy)
+    void setTrajectoryPolicy(int length, int sampleInterval = 1) {
+        store.setTrajectoryPolicy(length, sampleInterval);
+    }
     
     int getTotalTracks() const { return nextId; }
     
 private:
-    std::vector<std::shared_ptr<Track>> tracks;
+    TrackStore store;
     int nextId;
     float maxIoUDistance;
     int maxAge;
     int minHits;
     
-    // Calculate IoU (Intersection over Union) between two bounding boxes
-    float calculateIoU(const cv::Rect& box1, const cv::Rect& box2) const;
+    // Gated, per-component assignment, warm-started from the previous frame
+    SparseAssociator associator;
+    
+    // Per-frame scratch buffers, reused across frames
+    std::vector<cv::Rect> previousBoxes;
+    std::vector<int> matchedTracks;
+    std::vector<int> matchedDetections;
+    std::vector<int> unmatchedTracks;
+    std::vector<int> unmatchedDetections;
+    std::vector<Track> confirmedTracks;
     
-    // Create cost matrix for Hungarian algorithm
-    std::vector<std::vector<float>> createCostMatrix(
-        const std::vector<std::shared_ptr<Track>>& tracks,
-        const std::vector<Detection>& detections) const;
+    // Tracks reported to the caller
+    const std::vector<Track>& getConfirmedTracks();
     
     // Associate detections to tracks
     void associate(const std::vector<Detection>& detections,
@@ -0,0 +1,74 @@
+#ifndef TRAJECTORY_VIEW_H
+#define TRAJECTORY_VIEW_H
+
+#include <opencv2/opencv.hpp>
+#include <cstddef>
+#include <iterator>
+#include <vector>
+
+// Non-owning view of one track's trajectory ring in a TrackStore, oldest
+// point first. The points occupy at most two contiguous runs (before and
+// after the ring wraps); firstRun()/secondRun() expose them for bulk
+// consumers, operator[] and the iterators walk them in order.
+// Valid until the tracker's next update()/propagate().
+class TrajectoryView {
+public:
+    class const_iterator {
+    public:
+        using iterator_category = std::forward_iterator_tag;
+        using value_type = cv::Point;
+        using difference_type = std::ptrdiff_t;
+        using pointer = const cv::Point*;
+        using reference = const cv::Point&;
+
+        const_iterator(const TrajectoryView* view, int index) : view(view), index(index) {}
+
+        reference operator*() const { return (*view)[index]; }
+        pointer operator->() const { return &(*view)[index]; }
+        const_iterator& operator++() { ++index; return *this; }
+        const_iterator operator++(int) { const_iterator old = *this; ++index; return old; }
+        bool operator==(const const_iterator& other) const { return index == other.index; }
+        bool operator!=(const const_iterator& other) const { return index != other.index; }
+
+    private:
+        const TrajectoryView* view;
+        int index;
+    };
+
+    TrajectoryView(const cv::Point* ring, int capacity, int head, int length)
+        : ring(ring), capacity(capacity), head(head), length(length) {}
+
+    int size() const { return length; }
+    bool empty() const { return length == 0; }
+
+    const cv::Point& operator[](int k) const {
+        int index = head + k;
+        return ring[index < capacity ? index : index - capacity];
+    }
+    const cv::Point& front() const { return (*this)[0]; }
+    const cv::Point& back() const { return (*this)[length - 1]; }
+
+    const_iterator begin() const { return const_iterator(this, 0); }
+    const_iterator end() const { return const_iterator(this, length); }
+
+    // Contiguous runs: [firstRun(), firstRun() + firstRunSize()) then
+    // [secondRun(), secondRun() + secondRunSize())
+    const cv::Point* firstRun() const { return ring + head; }
+    int firstRunSize() const { return std::min(length, capacity - head); }
+    const cv::Point* secondRun() const { return ring; }
+    int secondRunSize() const { return length - firstRunSize(); }
+
+    // Copies the points into out, reusing its capacity
+    void copyTo(std::vector<cv::Point>& out) const {
+        out.assign(firstRun(), firstRun() + firstRunSize());
+        out.insert(out.end(), secondRun(), secondRun() + secondRunSize());
+    }
+
+private:
+    const cv::Point* ring;
+    int capacity;
+    int head;
+    int length;
+};
+
+#endif // TRAJECTORY_VIEW_H
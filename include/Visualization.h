@@ -0,0 +1,52 @@
+#ifndef VISUALIZATION_H
+#define VISUALIZATION_H
+
+#include <opencv2/opencv.hpp>
+#include <string>
+#include <vector>
+#include "FrameResult.h"
+
+// Color palette for visualization
+std::vector<cv::Scalar> generateColors(int n);
+
+// Draws one track: box, "ID:<id> <class>" label and trajectory polyline
+template <typename PointRange>
+void drawTrack(cv::Mat& frame, int id, const cv::Rect& bbox, const std::string& className,
+               const PointRange& trajectory, const std::vector<cv::Scalar>& colors) {
+    cv::Scalar color = colors[id % colors.size()];
+    
+    // Draw bounding box
+    cv::rectangle(frame, bbox, color, 2);
+    
+    // Draw track ID and class
+    std::string label = "ID:" + std::to_string(id) + " " + className;
+    int baseLine;
+    cv::Size labelSize = cv::getTextSize(label, cv::FONT_HERSHEY_SIMPLEX, 
+                                         0.5, 1, &baseLine);
+    
+    int top = std::max(bbox.y, labelSize.height);
+    cv::rectangle(frame, 
+                 cv::Point(bbox.x, top - labelSize.height - 5),
+                 cv::Point(bbox.x + labelSize.width, top + baseLine),
+                 color, cv::FILLED);
+    cv::putText(frame, label, cv::Point(bbox.x, top - 2),
+               cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 255), 1);
+    
+    // Draw trajectory
+    auto it = trajectory.begin();
+    if (it == trajectory.end()) {
+        return;
+    }
+    cv::Point previous = *it;
+    for (++it; it != trajectory.end(); ++it) {
+        cv::line(frame, previous, *it, color, 2);
+        previous = *it;
+    }
+}
+
+void drawTracks(cv::Mat& frame, const std::vector<TrackRecord>& tracks,
+                const std::vector<cv::Scalar>& colors);
+
+void displayStats(cv::Mat& frame, int frameCount, double fps, int trackCount);
+
+#endif // VISUALIZATION_H
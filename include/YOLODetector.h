@@ -2,28 +2,246 @@
 #define YOLO_DETECTOR_H
 
 #include <opencv2/opencv.hpp>
-#include <opencv2/dnn.hpp>
+#include <memory>
 #include <vector>
 #include <string>
 #include "Detection.h"
+#include "InferenceBackend.h"
+#include "NonMaxSuppressor.h"
 
 class YOLODetector {
 public:
+    // Tiled detection for frames much larger than the network input: the
+    // frame is cut into overlapping tiles of tileSize frame pixels, each
+    // tile is detected at (near) native scale, and duplicates at tile seams
+    // are merged. A coarse full-frame pass can be added for objects larger
+    // than a tile. All passes of a frame share one batch.
+    struct TileOptions {
+        bool enabled = false;
+        int tileSize = 0;            // frame pixels per tile side (0 = input size, native scale)
+        float overlap = 0.2f;        // overlap of neighbouring tiles, fraction of tileSize
+        bool coarsePass = true;      // also detect the whole frame at input size
+        float mergeThreshold = 0.6f; // same-class boxes overlapping this much of the
+                                     // smaller box are one object
+        int batchSize = 8;           // tiles per forward pass
+    };
+    
+    // The backend runs the network (see InferenceBackend); pre- and
+    // post-processing stay here and are the same for every backend
     YOLODetector(const std::string& modelPath, const std::string& configPath, 
-                 const std::string& classesPath);
+                 const std::string& classesPath, int maxBatchSize = 1,
+                 const InferenceBackend::Options& backendOptions = InferenceBackend::Options());
+    
+    // Decode-only instance: no network, only decode() is usable. For
+    // replaying or benchmarking post-processing on recorded outputs.
+    explicit YOLODetector(const std::string& classesPath);
     
     std::vector<Detection> detect(const cv::Mat& frame, float confThreshold = 0.5f, 
                                    float nmsThreshold = 0.4f);
     
-    bool isLoaded() const { return !net.empty(); }
+    // Runs several frames through the network as one NCHW blob (split into
+    // chunks of at most maxBatchSize) and returns one Detection list per
+    // frame. Amortizes per-call overhead when serving many frames at once.
+    // With tiling on, detect() and detectBatch() tile every frame larger
+    // than one tile.
+    std::vector<std::vector<Detection>> detectBatch(const std::vector<cv::Mat>& frames,
+                                                    float confThreshold = 0.5f,
+                                                    float nmsThreshold = 0.4f);
+    
+    // Detects objects only inside the given disjoint frame regions (see
+    // MotionGate). The regions keep their full-frame scale (tile scale with
+    // tiling on) and are packed
+    // side by side into one smaller input, so the forward pass costs about
+    // their share of the frame. Boxes are clipped to their region. Returns
+    // false without running the network if the packed regions are not
+    // smaller than the regular input, or the model has a fixed input size;
+    // detect() the whole frame instead.
+    bool detectRegions(const cv::Mat& frame, const std::vector<cv::Rect>& regions,
+                       float confThreshold, float nmsThreshold, std::vector<Detection>& detections);
+    
+    // Restricts detections to the given class ids (empty = all classes).
+    // Applied while decoding, before NMS.
+    void setClassFilter(const std::vector<int>& classIds);
+    
+    // NMS mode, top-K and detection limit; the IoU threshold is passed to detect()
+    void setNmsOptions(const NonMaxSuppressor::Options& options) { nms.setOptions(options); }
+    
+    // Letterbox: keep the aspect ratio and pad the network input instead of
+    // stretching the frame. Boxes are mapped back to frame pixels either way.
+    void setLetterbox(bool enabled) { letterbox = enabled; }
+    
+    // Square network input size, rounded down to a multiple of 32 (the
+    // YOLO stride). Smaller inputs are faster but miss small objects.
+    // Ignored when the model has a fixed input size.
+    void setInputSize(int size);
+    int getInputSize() const { return inputSize.width; }
+    
+    void setTiling(const TileOptions& options) { tiling = options; }
+    const TileOptions& getTiling() const { return tiling; }
+    
+    // INT8 mode (see Int8Calibrator). makeInputTensor() fills an N-image
+    // input tensor from frames with the current input size and letterbox;
+    // quantize() calibrates the network on such a tensor. Returns false,
+    // leaving the network in FP32, if the backend cannot quantize.
+    void makeInputTensor(const std::vector<cv::Mat>& frames, cv::Mat& tensor);
+    bool quantize(const cv::Mat& calibration);
+    bool isQuantized() const { return quantized; }
+    
+    // Post-processing alone: decodes the raw outputs of a single-image
+    // forward pass over a frame of frameSize (as left by detect(), see
+    // getLastOutputs()), with the current letterbox, filter and NMS settings
+    std::vector<Detection> decode(const std::vector<cv::Mat>& outputs, const cv::Size& frameSize,
+                                  float confThreshold = 0.5f, float nmsThreshold = 0.4f);
+    
+    // decode() into a caller-owned vector (cleared first), so a reused vector
+    // makes steady-state decoding allocation-free
+    void decode(const std::vector<cv::Mat>& outputs, const cv::Size& frameSize,
+                float confThreshold, float nmsThreshold, std::vector<Detection>& detections);
+    
+    // decode() for a forward pass over frameSizes.size() images, one frame
+    // size per image. Outputs may stack the images along the rows (2-D) or
+    // along a leading batch dimension (3-D, OpenCV's Region layer for N > 1).
+    std::vector<std::vector<Detection>> decodeBatch(const std::vector<cv::Mat>& outputs,
+                                                    const std::vector<cv::Size>& frameSizes,
+                                                    float confThreshold = 0.5f,
+                                                    float nmsThreshold = 0.4f);
+    
+    // Raw outputs of the last forward pass
+    const std::vector<cv::Mat>& getLastOutputs() const { return outs; }
+    
+    bool isLoaded() const { return backend && backend->isLoaded(); }
+    
+    // Name of the inference backend; "none" for a decode-only instance
+    const char* getBackendName() const { return backend ? backend->getName() : "none"; }
+    
+    // Class table lookup; "unknown" for ids outside the table. The table is
+    // fixed after construction, so this is safe from any thread.
+    const std::string& getClassName(int classId) const;
+    int getMaxBatchSize() const { return maxBatchSize; }
     
 private:
-    cv::dnn::Net net;
+    // Maps frame pixels into the network input: input = frame * scale + pad
+    struct InputTransform {
+        cv::Size input;                      // network input the outputs refer to
+        float scaleX = 1.0f;
+        float scaleY = 1.0f;
+        float padX = 0.0f;
+        float padY = 0.0f;
+    };
+    
+    // Gray border value for letterboxed inputs (Darknet convention)
+    static constexpr float LETTERBOX_FILL = 0.5f;
+    
+    // Gray input pixels between packed regions
+    static constexpr int REGION_GAP = 8;
+    
+    // A detection of a tiled pass, in frame pixels. clipped: the box touches
+    // a tile edge inside the frame, so the object may continue past it.
+    struct TileDetection {
+        Detection detection;
+        bool clipped;
+    };
+    
+    // A region of the frame and where it sits in the packed input
+    struct RegionTile {
+        cv::Rect region;
+        cv::Rect tile;
+    };
+    
+    std::unique_ptr<InferenceBackend> backend;
     std::vector<std::string> classNames;
     cv::Size inputSize;
+    int maxBatchSize;
+    bool letterbox;
+    bool quantized = false;
+    
+    // Reused forward-pass buffers; blob is the persistent NCHW input tensor
+    cv::Mat blob;
+    std::vector<cv::Mat> outs;
+    std::vector<InputTransform> batchTransforms;
+    
+    // Packed-region input (detectRegions)
+    cv::Mat regionBlob;
+    std::vector<RegionTile> tiles;
+    std::vector<int> tileOrder;
+    
+    // Preprocessing scratch
+    cv::Mat converted;                       // non-BGR input converted to BGR
+    std::vector<int> columnTaps;
+    std::vector<float> columnWeights;
+    
+    // Reused decoding buffers
+    std::vector<cv::Rect> candidateBoxes;
+    std::vector<float> candidateScores;
+    std::vector<int> candidateClassIds;
+    std::vector<int> keptIndices;
+    std::vector<char> classAllowed;          // by class id; empty = all allowed
+    
+    NonMaxSuppressor nms;
+    
+    // Tiled mode
+    TileOptions tiling;
+    std::vector<cv::Rect> tileRects;
+    std::vector<cv::Mat> tileFrames;
+    std::vector<TileDetection> tileDetections;
+    std::vector<TileDetection> mergedDetections;
     
     void loadClassNames(const std::string& classesPath);
-    std::vector<cv::String> getOutputNames();
+    
+    // detectBatch() without tiling, chunkSize images per forward pass
+    std::vector<std::vector<Detection>> detectImages(const std::vector<cv::Mat>& frames,
+                                                     float confThreshold, float nmsThreshold,
+                                                     int chunkSize);
+    
+    // Tile side in frame pixels
+    int tileSide() const;
+    
+    // Tiles covering the frame; one tile means tiling does not apply
+    void layoutTiles(const cv::Size& frameSize, std::vector<cv::Rect>& tiles) const;
+    
+    // One frame in tiled mode
+    std::vector<Detection> detectTiled(const cv::Mat& frame, float confThreshold,
+                                       float nmsThreshold);
+    
+    // Greedy seam merge over tileDetections, best unclipped boxes first: a
+    // box overlapping a kept box of the same class (IoU above nmsThreshold,
+    // or mergeThreshold of the smaller box) is a duplicate, and a clipped
+    // kept box grows to cover it
+    void mergeTileDetections(float nmsThreshold, std::vector<Detection>& detections);
+    
+    // Images per forward pass, capped by a fixed model batch size
+    int batchLimit(int requested) const;
+    
+    // (Re)shapes the input tensor for batchSize images
+    void allocateInput(int batchSize);
+    
+    // Frame -> input mapping for a frame of the given size; contentSize
+    // receives the resized image area inside the (possibly padded) input
+    InputTransform computeTransform(const cv::Size& frameSize, cv::Size& contentSize) const;
+    
+    // Fused resize (bilinear, optional letterbox), BGR->RGB, 1/255 scaling
+    // and HWC->CHW in one pass over the output, written to one image of the
+    // input tensor. The source is only sampled, never copied whole.
+    void preprocess(const cv::Mat& frame, float* tensor, InputTransform& transform);
+    
+    // The resampling pass of preprocess(): scales the whole BGR source into
+    // the target rectangle of a CHW tensor of tensorSize
+    void resample(const cv::Mat& source, float* tensor, const cv::Size& tensorSize,
+                  const cv::Rect& target);
+    
+    // The frame, or a BGR conversion of it in `converted`
+    const cv::Mat& toBgr(const cv::Mat& frame);
+    
+    // Decodes image `batchIndex` of a forward pass over `batchSize` images.
+    // Region outputs stack the images along the rows, or along the first
+    // dimension of a 3-D output. Rows are rejected on
+    // objectness before the class scores are scanned.
+    void decodeOutputs(int batchIndex, int batchSize, const InputTransform& transform,
+                       float confThreshold, float nmsThreshold,
+                       std::vector<Detection>& detections);
+    
+    // Largest of count scores and its first index (SSE2/NEON when available)
+    static float maxScore(const float* scores, int count, int& argmax);
 };
 
 #endif // YOLO_DETECTOR_H
@@ -19,6 +19,9 @@ make -j$(nproc)
 if [ $? -eq 0 ]; then
     echo "Build successful!"
     echo "Executable created: ./build/mot_tracker"
+    echo "Benchmarks: ./build/mot_bench"
+    echo "Tuning sweep: ./build/mot_sweep <video> <gt.txt> --settings <file>"
+    echo "Shared-memory producer: ./build/frame_producer <video> <ring name>"
 else
     echo "Build failed!"
     exit 1
@@ -0,0 +1,62 @@
+#!/usr/bin/env python3
+"""Compare two mot_bench JSON results and flag regressions.
+
+Usage: compare_bench.py <baseline.json> <current.json> [--threshold PERCENT]
+
+Benchmarks are matched by label. A benchmark regresses when its median time
+per operation grows by more than the threshold (default 10%), or when it
+starts allocating in steady state. Exits with status 1 if anything regressed.
+The strict zero-allocation check is `mot_bench --check-allocations`.
+"""
+
+import argparse
+import json
+import sys
+
+
+def load(path):
+    with open(path) as f:
+        return {b["label"]: b for b in json.load(f)["benchmarks"]}
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__.splitlines()[0])
+    parser.add_argument("baseline")
+    parser.add_argument("current")
+    parser.add_argument("--threshold", type=float, default=10.0,
+                        help="allowed slowdown in percent (default 10)")
+    args = parser.parse_args()
+
+    baseline = load(args.baseline)
+    current = load(args.current)
+
+    regressions = 0
+    print(f"{'benchmark':<60} {'baseline':>12} {'current':>12} {'change':>8}")
+    for label, result in current.items():
+        if label not in baseline:
+            print(f"{label:<60} {'-':>12} {result['ns_per_op']['median']:>12.0f}      new")
+            continue
+        before = baseline[label]["ns_per_op"]["median"]
+        after = result["ns_per_op"]["median"]
+        change = 100.0 * (after - before) / before if before > 0 else 0.0
+        flag = ""
+        if change > args.threshold:
+            flag = "  SLOWER"
+            regressions += 1
+        if baseline[label]["allocations_per_op"] < 0.5 <= result["allocations_per_op"]:
+            flag += "  ALLOCATES"
+            regressions += 1
+        print(f"{label:<60} {before:>12.0f} {after:>12.0f} {change:>7.1f}%{flag}")
+
+    for label in baseline:
+        if label not in current:
+            print(f"{label:<60} missing from current results")
+
+    if regressions:
+        print(f"\n{regressions} regression(s) above {args.threshold:.0f}%")
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,135 @@
+#include "Config.h"
+#include <algorithm>
+#include <cctype>
+#include <fstream>
+#include <sstream>
+
+std::string Config::trim(const std::string& text) {
+    size_t begin = text.find_first_not_of(" \t\r\n");
+    if (begin == std::string::npos) {
+        return "";
+    }
+    size_t end = text.find_last_not_of(" \t\r\n");
+    return text.substr(begin, end - begin + 1);
+}
+
+std::string Config::makeKey(const std::string& section, const std::string& key) {
+    return section + "." + key;
+}
+
+bool Config::load(const std::string& path) {
+    std::ifstream ifs(path);
+    if (!ifs.is_open()) {
+        return false;
+    }
+
+    std::string section;
+    std::string line;
+    while (std::getline(ifs, line)) {
+        // Strip comments
+        size_t comment = line.find('#');
+        if (comment != std::string::npos) {
+            line = line.substr(0, comment);
+        }
+        line = trim(line);
+        if (line.empty()) {
+            continue;
+        }
+
+        if (line.front() == '[' && line.back() == ']' && line.find('=') == std::string::npos) {
+            section = trim(line.substr(1, line.size() - 2));
+            continue;
+        }
+
+        size_t eq = line.find('=');
+        if (eq == std::string::npos) {
+            continue;
+        }
+        values[makeKey(section, trim(line.substr(0, eq)))] = trim(line.substr(eq + 1));
+    }
+
+    return true;
+}
+
+bool Config::has(const std::string& section, const std::string& key) const {
+    return values.count(makeKey(section, key)) > 0;
+}
+
+std::string Config::getString(const std::string& section, const std::string& key,
+                              const std::string& defaultValue) const {
+    auto it = values.find(makeKey(section, key));
+    return it != values.end() ? it->second : defaultValue;
+}
+
+int Config::getInt(const std::string& section, const std::string& key, int defaultValue) const {
+    auto it = values.find(makeKey(section, key));
+    if (it == values.end()) {
+        return defaultValue;
+    }
+    try {
+        return std::stoi(it->second);
+    }
+    catch (const std::exception&) {
+        return defaultValue;
+    }
+}
+
+float Config::getFloat(const std::string& section, const std::string& key, float defaultValue) const {
+    auto it = values.find(makeKey(section, key));
+    if (it == values.end()) {
+        return defaultValue;
+    }
+    try {
+        return std::stof(it->second);
+    }
+    catch (const std::exception&) {
+        return defaultValue;
+    }
+}
+
+bool Config::getBool(const std::string& section, const std::string& key, bool defaultValue) const {
+    auto it = values.find(makeKey(section, key));
+    if (it == values.end()) {
+        return defaultValue;
+    }
+    std::string value = it->second;
+    std::transform(value.begin(), value.end(), value.begin(),
+                   [](unsigned char c) { return std::tolower(c); });
+    if (value == "true" || value == "1" || value == "yes" || value == "on") {
+        return true;
+    }
+    if (value == "false" || value == "0" || value == "no" || value == "off") {
+        return false;
+    }
+    return defaultValue;
+}
+
+std::vector<int> Config::getIntList(const std::string& section, const std::string& key) const {
+    std::vector<int> result;
+    std::string value = getString(section, key);
+    std::replace(value.begin(), value.end(), '[', ' ');
+    std::replace(value.begin(), value.end(), ']', ' ');
+    std::replace(value.begin(), value.end(), ',', ' ');
+
+    std::istringstream iss(value);
+    int item;
+    while (iss >> item) {
+        result.push_back(item);
+    }
+    return result;
+}
+
+std::vector<float> Config::getFloatList(const std::string& section, const std::string& key) const {
+    std::vector<float> result;
+    std::string value = getString(section, key);
+    std::replace(value.begin(), value.end(), '[', ' ');
+    std::replace(value.begin(), value.end(), ']', ' ');
+    std::replace(value.begin(), value.end(), ',', ' ');
+
+    std::istringstream iss(value);
+    float item;
+    while (iss >> item) {
+        result.push_back(item);
+    }
+    return result;
+}
@@ -0,0 +1,288 @@
+#include "DetectionCache.h"
+#include <cstdio>
+#include <cstring>
+#include <iostream>
+#include <sstream>
+#include <sys/stat.h>
+#ifndef _WIN32
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+static const char MAGIC[4] = {'M', 'O', 'T', 'D'};
+
+struct CacheHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t frameCount;
+    uint32_t identityLength;
+    uint64_t recordCount;
+    uint64_t tableOffset;    // 0 until the writer has finished
+};
+static_assert(sizeof(CacheHeader) == 40, "cache header layout");
+
+struct DetectionCache::Record {
+    int32_t x, y, width, height;
+    float confidence;
+    int32_t classId;
+};
+
+struct DetectionCache::FrameEntry {
+    int64_t first;
+    int64_t count;           // -1: detector skipped this frame
+};
+
+DetectionCache::~DetectionCache() {
+    close();
+}
+
+bool DetectionCache::open(const std::string& path, uint64_t expectedKey) {
+    static_assert(sizeof(Record) == 24 && sizeof(FrameEntry) == 16, "cache record layout");
+    close();
+
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(CacheHeader))) {
+        ::close(fd);
+        return false;
+    }
+    size = static_cast<size_t>(info.st_size);
+    void* mapped = mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        size = 0;
+        return false;
+    }
+    data = static_cast<const unsigned char*>(mapped);
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    fallback.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(fallback.data()), fallback.size());
+    if (!file || fallback.size() < sizeof(CacheHeader)) {
+        fallback.clear();
+        return false;
+    }
+    size = fallback.size();
+    data = fallback.data();
+#endif
+
+    CacheHeader header;
+    std::memcpy(&header, data, sizeof(header));
+    uint64_t recordsOffset = (sizeof(CacheHeader) + header.identityLength + 7) & ~uint64_t(7);
+    bool valid = std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) == 0 &&
+                 header.version == VERSION &&
+                 header.tableOffset != 0 &&
+                 (expectedKey == 0 || header.key == expectedKey) &&
+                 recordsOffset + header.recordCount * sizeof(Record) <= header.tableOffset &&
+                 header.tableOffset + uint64_t(header.frameCount) * sizeof(FrameEntry) <= size;
+    if (!valid) {
+        close();
+        return false;
+    }
+
+    key = header.key;
+    frameCount = static_cast<int>(header.frameCount);
+    identity.assign(reinterpret_cast<const char*>(data + sizeof(CacheHeader)), header.identityLength);
+    recordCount = header.recordCount;
+    records = reinterpret_cast<const Record*>(data + recordsOffset);
+    table = reinterpret_cast<const FrameEntry*>(data + header.tableOffset);
+    return true;
+}
+
+void DetectionCache::close() {
+#ifndef _WIN32
+    if (data != nullptr) {
+        munmap(const_cast<unsigned char*>(data), size);
+    }
+#endif
+    fallback.clear();
+    data = nullptr;
+    size = 0;
+    key = 0;
+    frameCount = 0;
+    identity.clear();
+    records = nullptr;
+    recordCount = 0;
+    table = nullptr;
+}
+
+bool DetectionCache::getFrame(int index, std::vector<Detection>& detections) const {
+    detections.clear();
+    if (index < 0 || index >= frameCount || table[index].count < 0) {
+        return false;
+    }
+    const FrameEntry& entry = table[index];
+    if (entry.first < 0 || static_cast<uint64_t>(entry.first + entry.count) > recordCount) {
+        return false;
+    }
+    detections.reserve(static_cast<size_t>(entry.count));
+    for (int64_t r = entry.first; r < entry.first + entry.count; ++r) {
+        const Record& record = records[r];
+        detections.emplace_back(cv::Rect(record.x, record.y, record.width, record.height),
+                                record.confidence, record.classId);
+    }
+    return true;
+}
+
+uint64_t DetectionCache::hashIdentity(const std::string& identity) {
+    uint64_t hash = 14695981039346656037ull;
+    for (unsigned char c : identity) {
+        hash ^= c;
+        hash *= 1099511628211ull;
+    }
+    return hash;
+}
+
+std::string DetectionCache::fileFingerprint(const std::string& path) {
+    struct stat info;
+    if (stat(path.c_str(), &info) != 0) {
+        return path;
+    }
+    std::ostringstream fingerprint;
+    fingerprint << path << ":" << static_cast<long long>(info.st_size) << ":"
+                << static_cast<long long>(info.st_mtime);
+    return fingerprint.str();
+}
+
+std::string DetectionCache::cachePath(const std::string& directory, const std::string& videoPath,
+                                      uint64_t key) {
+    std::string stem = videoPath;
+    size_t slash = stem.find_last_of("/\\");
+    if (slash != std::string::npos) {
+        stem = stem.substr(slash + 1);
+    }
+    size_t dot = stem.find_last_of('.');
+    if (dot != std::string::npos && dot > 0) {
+        stem = stem.substr(0, dot);
+    }
+
+    char hex[17];
+    std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(key));
+    std::string prefix = directory.empty() ? std::string() : directory;
+    if (!prefix.empty() && prefix.back() != '/') {
+        prefix += '/';
+    }
+    return prefix + stem + "-" + hex + ".motd";
+}
+
+DetectionCacheWriter::DetectionCacheWriter(const std::string& path, uint64_t key,
+                                           const std::string& identity)
+    : path(path), key(key), identity(identity) {
+    file.open(path, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not create detection cache: " << path << std::endl;
+        return;
+    }
+
+    // Unfinished header (tableOffset 0) until finish()
+    CacheHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = DetectionCache::VERSION;
+    header.key = key;
+    header.identityLength = static_cast<uint32_t>(identity.size());
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.write(identity.data(), identity.size());
+    static const char padding[8] = {};
+    size_t end = sizeof(CacheHeader) + identity.size();
+    file.write(padding, ((end + 7) & ~size_t(7)) - end);
+}
+
+DetectionCacheWriter::~DetectionCacheWriter() {
+    if (file.is_open() && !finished) {
+        file.close();
+        std::remove(path.c_str());
+    }
+}
+
+void DetectionCacheWriter::append(bool detected, const std::vector<Detection>& detections) {
+    if (!file.is_open() || finished) {
+        return;
+    }
+    frameTable.push_back(static_cast<int64_t>(recordCount));
+    if (!detected) {
+        frameTable.push_back(-1);
+        return;
+    }
+    for (const auto& detection : detections) {
+        int32_t record[6] = {detection.bbox.x, detection.bbox.y, detection.bbox.width,
+                             detection.bbox.height, 0, detection.classId};
+        std::memcpy(&record[4], &detection.confidence, sizeof(float));
+        file.write(reinterpret_cast<const char*>(record), sizeof(record));
+    }
+    recordCount += detections.size();
+    frameTable.push_back(static_cast<int64_t>(detections.size()));
+}
+
+bool DetectionCacheWriter::finish() {
+    if (!file.is_open() || finished) {
+        return finished;
+    }
+    uint64_t tableOffset = static_cast<uint64_t>(file.tellp());
+    file.write(reinterpret_cast<const char*>(frameTable.data()), frameTable.size() * sizeof(int64_t));
+
+    CacheHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = DetectionCache::VERSION;
+    header.key = key;
+    header.frameCount = static_cast<uint32_t>(frameTable.size() / 2);
+    header.identityLength = static_cast<uint32_t>(identity.size());
+    header.recordCount = recordCount;
+    header.tableOffset = tableOffset;
+    file.seekp(0);
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+    file.close();
+
+    // A failed write leaves the partial file to the destructor
+    finished = !file.fail();
+    if (!finished) {
+        std::remove(path.c_str());
+        std::cerr << "Error: Could not write detection cache: " << path << std::endl;
+    }
+    return finished;
+}
+
+bool MotDetectionFile::load(const std::string& path, float minConfidence) {
+    frames.clear();
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        int frame = 0;
+        int id = 0;
+        float x = 0, y = 0, width = 0, height = 0, confidence = 0;
+        if (std::sscanf(line.c_str(), "%d,%d,%f,%f,%f,%f,%f", &frame, &id, &x, &y, &width,
+                        &height, &confidence) != 7 || frame < 1) {
+            continue;
+        }
+        if (static_cast<size_t>(frame) > frames.size()) {
+            frames.resize(frame);
+        }
+        if (confidence >= minConfidence) {
+            frames[frame - 1].emplace_back(
+                cv::Rect(cvRound(x), cvRound(y), cvRound(width), cvRound(height)), confidence, 0);
+        }
+    }
+    return true;
+}
+
+bool MotDetectionFile::getFrame(int index, std::vector<Detection>& detections) const {
+    if (index < 0 || index >= static_cast<int>(frames.size())) {
+        detections.clear();
+        return false;
+    }
+    detections = frames[index];
+    return true;
+}
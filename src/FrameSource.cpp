@@ -0,0 +1,234 @@
+#include "FrameSource.h"
+#include <algorithm>
+#include <cctype>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#ifndef _WIN32
+#include "SharedMemoryRing.h"
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#endif
+
+static bool hasExtension(const std::string& path, const std::string& extension) {
+    if (path.size() < extension.size()) {
+        return false;
+    }
+    return std::equal(extension.rbegin(), extension.rend(), path.rbegin(),
+                      [](char a, char b) { return a == std::tolower(static_cast<unsigned char>(b)); });
+}
+
+std::unique_ptr<FrameSource> FrameSource::open(const std::string& source, const Options& options) {
+    if (source.compare(0, 4, "shm:") == 0) {
+#ifndef _WIN32
+        return std::unique_ptr<FrameSource>(
+            new SharedMemoryFrameSource(source.substr(4), options.holdFrames));
+#else
+        std::cerr << "Error: Shared-memory sources need POSIX shared memory" << std::endl;
+#endif
+    }
+    if (hasExtension(source, ".y4m")) {
+        return std::unique_ptr<FrameSource>(new Y4mVideoSource(source));
+    }
+    if (hasExtension(source, ".bgr") || hasExtension(source, ".raw")) {
+        return std::unique_ptr<FrameSource>(
+            new RawVideoSource(source, options.rawWidth, options.rawHeight, options.rawFps));
+    }
+    return std::unique_ptr<FrameSource>(new VideoCaptureSource(source));
+}
+
+VideoCaptureSource::VideoCaptureSource(const std::string& source) {
+    // A purely numeric source is a camera index
+    bool isCamera = !source.empty() &&
+                    std::all_of(source.begin(), source.end(),
+                                [](unsigned char c) { return std::isdigit(c); });
+    if (isCamera) {
+        capture.open(std::stoi(source));
+    } else {
+        capture.open(source);
+    }
+    live = isCamera || source.find("://") != std::string::npos;
+}
+
+cv::Size VideoCaptureSource::getFrameSize() const {
+    return cv::Size(static_cast<int>(capture.get(cv::CAP_PROP_FRAME_WIDTH)),
+                    static_cast<int>(capture.get(cv::CAP_PROP_FRAME_HEIGHT)));
+}
+
+double VideoCaptureSource::getFps() const {
+    return capture.get(cv::CAP_PROP_FPS);
+}
+
+MappedFile::~MappedFile() {
+    close();
+}
+
+bool MappedFile::open(const std::string& path) {
+    close();
+#ifndef _WIN32
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) {
+        return false;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size == 0) {
+        ::close(fd);
+        return false;
+    }
+    // Private and writable: stray writes to a frame copy the page instead of
+    // faulting, and never reach the file
+    void* mapped = mmap(nullptr, static_cast<size_t>(info.st_size), PROT_READ | PROT_WRITE,
+                        MAP_PRIVATE, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        return false;
+    }
+    // Frames are read front to back
+    madvise(mapped, static_cast<size_t>(info.st_size), MADV_SEQUENTIAL);
+    begin = static_cast<unsigned char*>(mapped);
+    length = static_cast<size_t>(info.st_size);
+#else
+    std::ifstream file(path, std::ios::binary | std::ios::ate);
+    if (!file.is_open()) {
+        return false;
+    }
+    fallback.resize(static_cast<size_t>(file.tellg()));
+    file.seekg(0);
+    file.read(reinterpret_cast<char*>(fallback.data()), fallback.size());
+    if (!file || fallback.empty()) {
+        fallback.clear();
+        return false;
+    }
+    begin = fallback.data();
+    length = fallback.size();
+#endif
+    return true;
+}
+
+void MappedFile::close() {
+#ifndef _WIN32
+    if (begin != nullptr) {
+        munmap(begin, length);
+    }
+#endif
+    fallback.clear();
+    begin = nullptr;
+    length = 0;
+}
+
+RawVideoSource::RawVideoSource(const std::string& path, int width, int height, double fps)
+    : size(width, height), fps(fps) {
+    if (width <= 0 || height <= 0) {
+        std::cerr << "Error: Raw video needs a frame size ([Input] raw_width, raw_height): "
+                  << path << std::endl;
+        return;
+    }
+    if (file.open(path)) {
+        frameBytes = static_cast<size_t>(width) * height * 3;
+    }
+}
+
+bool RawVideoSource::read(cv::Mat& frame) {
+    if (!isOpened() || offset + frameBytes > file.size()) {
+        return false;
+    }
+    frame = cv::Mat(size, CV_8UC3, file.data() + offset);
+    offset += frameBytes;
+    return true;
+}
+
+Y4mVideoSource::Y4mVideoSource(const std::string& path) {
+    if (file.open(path) && !parseHeader()) {
+        std::cerr << "Error: Unsupported Y4M file (4:2:0 or mono only): " << path << std::endl;
+        file.close();
+    }
+}
+
+bool Y4mVideoSource::parseHeader() {
+    const char* text = reinterpret_cast<const char*>(file.data());
+    const char* end = text + file.size();
+    const char* newline = static_cast<const char*>(std::memchr(text, '\n', file.size()));
+    if (newline == nullptr || file.size() < 9 || std::memcmp(text, "YUV4MPEG2", 9) != 0) {
+        return false;
+    }
+
+    // Space-separated tags: W<width> H<height> F<num>:<den> C<colorspace> ...
+    std::string header(text + 9, newline);
+    size_t position = 0;
+    while (position < header.size()) {
+        size_t next = header.find(' ', position);
+        std::string tag = header.substr(position, next == std::string::npos ? std::string::npos
+                                                                            : next - position);
+        if (!tag.empty()) {
+            const char* value = tag.c_str() + 1;
+            switch (tag[0]) {
+            case 'W':
+                size.width = std::atoi(value);
+                break;
+            case 'H':
+                size.height = std::atoi(value);
+                break;
+            case 'F': {
+                int numerator = 0;
+                int denominator = 1;
+                if (std::sscanf(value, "%d:%d", &numerator, &denominator) == 2 && denominator > 0) {
+                    fps = static_cast<double>(numerator) / denominator;
+                }
+                break;
+            }
+            case 'C':
+                if (tag.compare(1, 3, "420") == 0) {
+                    chroma = Chroma::Yuv420;
+                } else if (tag.compare(1, 4, "mono") == 0) {
+                    chroma = Chroma::Mono;
+                } else {
+                    return false;
+                }
+                break;
+            default:
+                break;
+            }
+        }
+        position = next == std::string::npos ? header.size() : next + 1;
+    }
+
+    if (size.width <= 0 || size.height <= 0 || (size.width | size.height) & 1) {
+        return false;
+    }
+    size_t luma = static_cast<size_t>(size.width) * size.height;
+    frameBytes = chroma == Chroma::Yuv420 ? luma * 3 / 2 : luma;
+    offset = static_cast<size_t>(newline + 1 - text);
+    return offset <= static_cast<size_t>(end - text);
+}
+
+bool Y4mVideoSource::read(cv::Mat& frame) {
+    if (!isOpened()) {
+        return false;
+    }
+    // "FRAME" plus optional parameters up to the newline
+    const unsigned char* marker = file.data() + offset;
+    size_t remaining = file.size() - offset;
+    const void* newline = std::memchr(marker, '\n', std::min<size_t>(remaining, 256));
+    if (remaining < 5 || newline == nullptr || std::memcmp(marker, "FRAME", 5) != 0) {
+        return false;
+    }
+    size_t dataOffset = static_cast<const unsigned char*>(newline) + 1 - file.data();
+    if (dataOffset + frameBytes > file.size()) {
+        return false;
+    }
+    unsigned char* planes = file.data() + dataOffset;
+    offset = dataOffset + frameBytes;
+
+    // The previous frame may still be in the pipeline; convert into a new buffer
+    frame.release();
+    if (chroma == Chroma::Yuv420) {
+        cv::cvtColor(cv::Mat(size.height * 3 / 2, size.width, CV_8UC1, planes), frame,
+                     cv::COLOR_YUV2BGR_I420);
+    } else {
+        cv::cvtColor(cv::Mat(size, CV_8UC1, planes), frame, cv::COLOR_GRAY2BGR);
+    }
+    return true;
+}
@@ -1,80 +1,182 @@
 #include "HungarianAlgorithm.h"
+#include "ScratchVector.h"
 #include <algorithm>
+#include <cmath>
 
 const float HungarianAlgorithm::INF = std::numeric_limits<float>::max();
 
+// Reduced costs within this tolerance count as tight (float round-off)
+static const float TIGHT_EPS = 1e-5f;
+
+// Cost of the padded square problem (1-based indices); padding costs 0
+static inline float paddedCost(const float* cost, int rows, int cols, int i, int j) {
+    return (i <= rows && j <= cols) ? cost[(i - 1) * cols + (j - 1)] : 0.0f;
+}
+
 std::vector<int> HungarianAlgorithm::solve(const std::vector<std::vector<float>>& costMatrix) {
     if (costMatrix.empty() || costMatrix[0].empty()) {
         return std::vector<int>();
     }
-    
+
     int rows = costMatrix.size();
     int cols = costMatrix[0].size();
-    
-    // Create working copy of cost matrix
-    std::vector<std::vector<float>> cost = costMatrix;
-    
-    // Result: assignment[i] = j means row i is assigned to column j
-    std::vector<int> assignment(rows, -1);
-    std::vector<bool> rowCovered(rows, false);
-    std::vector<bool> colCovered(cols, false);
-    
-    // Step 1: Subtract row minimum from each row
+
+    // Flatten into a contiguous buffer
+    std::vector<float> cost(rows * cols);
     for (int i = 0; i < rows; ++i) {
-        float minVal = *std::min_element(cost[i].begin(), cost[i].end());
-        if (minVal < INF) {
-            for (int j = 0; j < cols; ++j) {
-                if (cost[i][j] < INF) {
-                    cost[i][j] -= minVal;
-                }
-            }
-        }
+        std::copy(costMatrix[i].begin(), costMatrix[i].end(), cost.begin() + i * cols);
+    }
+
+    std::vector<int> assignment(rows, -1);
+    HungarianAlgorithm solver;
+    solver.solve(cost.data(), rows, cols, assignment.data());
+    return assignment;
+}
+
+float HungarianAlgorithm::solve(const float* cost, int rows, int cols, int* assignment,
+                                float* rowDuals, bool warmStart) {
+    lastAugmentations = 0;
+    if (rows <= 0) {
+        return 0.0f;
+    }
+    if (cols <= 0) {
+        std::fill(assignment, assignment + rows, -1);
+        return 0.0f;
     }
-    
-    // Step 2: Subtract column minimum from each column
-    for (int j = 0; j < cols; ++j) {
-        float minVal = INF;
-        for (int i = 0; i < rows; ++i) {
-            minVal = std::min(minVal, cost[i][j]);
+
+    const int n = std::max(rows, cols);
+    assignScratch(u, n + 1, 0.0f);
+    assignScratch(v, n + 1, 0.0f);
+    assignScratch(colMatch, n + 1, 0);
+    assignScratch(rowMatch, n + 1, 0);
+    way.resize(n + 1);
+    minv.resize(n + 1);
+    used.resize(n + 1);
+    assignScratch(colArgmin, n + 1, 0);
+
+    // Row potentials: previous duals, or 0 for a cold start / padding rows
+    if (warmStart && rowDuals) {
+        for (int i = 1; i <= rows; ++i) {
+            u[i] = rowDuals[i - 1];
         }
-        if (minVal < INF) {
-            for (int i = 0; i < rows; ++i) {
-                if (cost[i][j] < INF) {
-                    cost[i][j] -= minVal;
-                }
+    }
+
+    // Column potentials v[j] = min_i (c[i][j] - u[i]) keep (u, v) dual
+    // feasible whatever u was, and make (argmin, j) tight
+    for (int j = 1; j <= n; ++j) {
+        float best = INF;
+        int bestRow = 0;
+        for (int i = 1; i <= n; ++i) {
+            float reduced = paddedCost(cost, rows, cols, i, j) - u[i];
+            if (reduced < best) {
+                best = reduced;
+                bestRow = i;
             }
         }
+        v[j] = best;
+        colArgmin[j] = bestRow;
     }
-    
-    // Step 3: Greedy assignment of zeros
-    for (int i = 0; i < rows; ++i) {
-        for (int j = 0; j < cols; ++j) {
-            if (cost[i][j] == 0.0f && !rowCovered[i] && !colCovered[j]) {
-                assignment[i] = j;
-                rowCovered[i] = true;
-                colCovered[j] = true;
-                break;
+
+    // Keep hinted pairs that are tight
+    if (warmStart) {
+        for (int i = 1; i <= rows; ++i) {
+            int j = assignment[i - 1] + 1;
+            if (j >= 1 && j <= cols && colMatch[j] == 0 &&
+                paddedCost(cost, rows, cols, i, j) - u[i] - v[j] <= TIGHT_EPS) {
+                colMatch[j] = i;
+                rowMatch[i] = j;
             }
         }
     }
-    
-    // Simple greedy approach for remaining unassigned rows
-    for (int i = 0; i < rows; ++i) {
-        if (assignment[i] == -1) {
-            float minCost = INF;
-            int minCol = -1;
-            for (int j = 0; j < cols; ++j) {
-                if (!colCovered[j] && cost[i][j] < minCost) {
-                    minCost = cost[i][j];
-                    minCol = j;
-                }
+
+    // Column reduction: pair each free column with its argmin row if free
+    for (int j = 1; j <= n; ++j) {
+        int i = colArgmin[j];
+        if (colMatch[j] == 0 && rowMatch[i] == 0) {
+            colMatch[j] = i;
+            rowMatch[i] = j;
+        }
+    }
+
+    // Shortest augmenting path from every row that is still free
+    for (int i = 1; i <= n; ++i) {
+        if (rowMatch[i] == 0) {
+            augment(cost, rows, cols, n, i);
+            lastAugmentations++;
+        }
+    }
+
+    float total = 0.0f;
+    for (int i = 1; i <= rows; ++i) {
+        int j = rowMatch[i];
+        if (j <= cols) {
+            assignment[i - 1] = j - 1;
+            total += cost[(i - 1) * cols + (j - 1)];
+        } else {
+            assignment[i - 1] = -1;
+        }
+    }
+
+    // Stored duals are re-centred on their minimum. A uniform shift of the
+    // row duals leaves every reduced cost unchanged once the column duals
+    // are rebuilt, but without it they drift from frame to frame until
+    // float round-off breaks optimality.
+    if (rowDuals) {
+        float lowest = *std::min_element(u.begin() + 1, u.begin() + rows + 1);
+        for (int i = 1; i <= rows; ++i) {
+            rowDuals[i - 1] = u[i] - lowest;
+        }
+    }
+
+    return total;
+}
+
+void HungarianAlgorithm::augment(const float* cost, int rows, int cols, int n, int row) {
+    // Dijkstra over reduced costs from the free row; column 0 is the root
+    colMatch[0] = row;
+    int j0 = 0;
+    std::fill(minv.begin(), minv.end(), INF);
+    std::fill(used.begin(), used.end(), 0);
+
+    do {
+        used[j0] = 1;
+        int i0 = colMatch[j0];
+        float delta = INF;
+        int j1 = 0;
+
+        for (int j = 1; j <= n; ++j) {
+            if (used[j]) {
+                continue;
             }
-            if (minCol != -1 && minCost < INF) {
-                assignment[i] = minCol;
-                colCovered[minCol] = true;
+            float reduced = paddedCost(cost, rows, cols, i0, j) - u[i0] - v[j];
+            if (reduced < minv[j]) {
+                minv[j] = reduced;
+                way[j] = j0;
+            }
+            if (minv[j] < delta) {
+                delta = minv[j];
+                j1 = j;
             }
         }
-    }
-    
-    return assignment;
+
+        // Shift potentials so the tree edges stay tight
+        for (int j = 0; j <= n; ++j) {
+            if (used[j]) {
+                u[colMatch[j]] += delta;
+                v[j] -= delta;
+            } else {
+                minv[j] -= delta;
+            }
+        }
+
+        j0 = j1;
+    } while (colMatch[j0] != 0);
+
+    // Flip the matching along the path back to the root
+    do {
+        int j1 = way[j0];
+        colMatch[j0] = colMatch[j1];
+        rowMatch[colMatch[j0]] = j0;
+        j0 = j1;
+    } while (j0 != 0);
 }
@@ -0,0 +1,98 @@
+#include "InferenceBackend.h"
+#include <iostream>
+#ifdef MOT_WITH_ONNXRUNTIME
+#include "OnnxRuntimeBackend.h"
+#endif
+
+std::unique_ptr<InferenceBackend> InferenceBackend::create(const std::string& modelPath,
+                                                           const std::string& configPath,
+                                                           const Options& options) {
+    if (options.name == "opencv") {
+        return std::unique_ptr<InferenceBackend>(new OpenCvBackend(modelPath, configPath, options));
+    }
+#ifdef MOT_WITH_ONNXRUNTIME
+    if (options.name == "onnxruntime") {
+        return std::unique_ptr<InferenceBackend>(new OnnxRuntimeBackend(modelPath, options));
+    }
+#endif
+    std::cerr << "Unknown or unavailable inference backend: " << options.name << " (available:";
+    for (const std::string& name : available()) {
+        std::cerr << " " << name;
+    }
+    std::cerr << ")" << std::endl;
+    return nullptr;
+}
+
+std::vector<std::string> InferenceBackend::available() {
+    std::vector<std::string> names = {"opencv"};
+#ifdef MOT_WITH_ONNXRUNTIME
+    names.push_back("onnxruntime");
+#endif
+    return names;
+}
+
+OpenCvBackend::OpenCvBackend(const std::string& modelPath, const std::string& configPath,
+                             const Options& options) {
+    try {
+        // Darknet for .weights + .cfg; the extension picks the reader otherwise
+        net = cv::dnn::readNet(modelPath, configPath);
+        net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+        net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+        findOutputs();
+    }
+    catch (const cv::Exception& e) {
+        std::cerr << "Error loading model with OpenCV DNN: " << e.what() << std::endl;
+        net = cv::dnn::Net();
+    }
+    if (options.intraOpThreads > 0) {
+        cv::setNumThreads(options.intraOpThreads);
+    }
+}
+
+void OpenCvBackend::findOutputs() {
+    outputNames.clear();
+    std::vector<int> outLayers = net.getUnconnectedOutLayers();
+    std::vector<cv::String> layerNames = net.getLayerNames();
+    for (int layer : outLayers) {
+        outputNames.push_back(layerNames[layer - 1]);
+    }
+}
+
+bool OpenCvBackend::quantize(const cv::Mat& calibration) {
+#if CV_VERSION_MAJOR > 4 || (CV_VERSION_MAJOR == 4 && CV_VERSION_MINOR >= 6)
+    try {
+        // Float in and out, so forward() and the decoder are unchanged
+        cv::dnn::Net quantized = net.quantize(std::vector<cv::Mat>{calibration}, CV_32F, CV_32F, true);
+        if (quantized.empty()) {
+            return false;
+        }
+        net = quantized;
+        net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
+        net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
+        findOutputs();
+        return true;
+    }
+    catch (const cv::Exception& e) {
+        std::cerr << "INT8 quantization failed: " << e.what() << std::endl;
+        return false;
+    }
+#else
+    // cv::dnn::Net::quantize arrived in OpenCV 4.6
+    std::cerr << "INT8 quantization unavailable: needs OpenCV 4.6 or later (this is "
+              << CV_VERSION << ")" << std::endl;
+    return false;
+#endif
+}
+
+void OpenCvBackend::forward(const cv::Mat& blob, std::vector<cv::Mat>& outputs) {
+    net.setInput(blob);
+    net.forward(outputs, outputNames);
+
+    // The Region layer returns [N, rows, 5 + C] for N > 1; stack the
+    // images along the rows (a header change, no copy)
+    for (cv::Mat& out : outputs) {
+        if (out.dims == 3) {
+            out = out.reshape(1, out.size[0] * out.size[1]);
+        }
+    }
+}
@@ -0,0 +1,308 @@
+#include "Int8Calibrator.h"
+#include "DetectionCache.h"
+#include "SparseAssociator.h"
+#include <algorithm>
+#include <cctype>
+#include <chrono>
+#include <cstdio>
+#include <cstring>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <sstream>
+
+static const char MAGIC[4] = {'M', 'O', 'T', 'Q'};
+
+struct CalibrationHeader {
+    char magic[4];
+    uint32_t version;
+    uint64_t key;
+    uint32_t frames;
+    uint32_t height;
+    uint32_t width;
+    uint32_t fp32Detections;
+    uint32_t int8Detections;
+    uint32_t matched;
+    float meanIoU;
+    float meanConfidenceDelta;
+    float fp32Ms;
+    float int8Ms;
+};
+
+namespace {
+
+bool isImageFile(const std::string& path) {
+    size_t dot = path.find_last_of('.');
+    if (dot == std::string::npos) {
+        return false;
+    }
+    std::string extension = path.substr(dot + 1);
+    std::transform(extension.begin(), extension.end(), extension.begin(),
+                   [](unsigned char c) { return static_cast<char>(std::tolower(c)); });
+    return extension == "jpg" || extension == "jpeg" || extension == "png" || extension == "bmp";
+}
+
+// Detects every frame once after a warm-up call; returns ms per frame
+double timeDetections(YOLODetector& detector, const std::vector<cv::Mat>& frames,
+                      float confThreshold, float nmsThreshold,
+                      std::vector<std::vector<Detection>>& detections) {
+    detector.detect(frames[0], confThreshold, nmsThreshold);
+    detections.clear();
+    auto start = std::chrono::steady_clock::now();
+    for (const cv::Mat& frame : frames) {
+        detections.push_back(detector.detect(frame, confThreshold, nmsThreshold));
+    }
+    auto elapsed = std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start);
+    return elapsed.count() / frames.size();
+}
+
+} // namespace
+
+Int8Calibrator::Int8Calibrator(const Options& options, const std::string& baseIdentity)
+    : options(options) {
+    this->options.maxFrames = std::max(1, options.maxFrames);
+    files = listFrames();
+
+    std::ostringstream text;
+    text << "calibration=" << options.calibrationDir << "," << this->options.maxFrames << ","
+         << options.matchIoU;
+    for (const std::string& file : files) {
+        text << "\n" << DetectionCache::fileFingerprint(file);
+    }
+    identity = text.str();
+    key = DetectionCache::hashIdentity(baseIdentity + "\n" + identity);
+
+    if (!options.cacheDir.empty()) {
+        char hex[17];
+        std::snprintf(hex, sizeof(hex), "%016llx", static_cast<unsigned long long>(key));
+        cachePath = options.cacheDir;
+        if (cachePath.back() != '/') {
+            cachePath += '/';
+        }
+        cachePath += std::string("int8-") + hex + ".motq";
+    }
+}
+
+std::vector<std::string> Int8Calibrator::listFrames() const {
+    std::vector<cv::String> entries;
+    if (!options.calibrationDir.empty()) {
+        try {
+            cv::glob(options.calibrationDir, entries, false);
+        }
+        catch (const cv::Exception&) {
+            entries.clear();
+        }
+    }
+    std::vector<std::string> images;
+    for (const cv::String& entry : entries) {
+        if (isImageFile(entry)) {
+            images.push_back(entry);
+        }
+    }
+    std::sort(images.begin(), images.end());
+
+    // Evenly spaced, so a folder of consecutive frames still spans the scene
+    if (static_cast<int>(images.size()) <= options.maxFrames) {
+        return images;
+    }
+    std::vector<std::string> selected;
+    for (int i = 0; i < options.maxFrames; ++i) {
+        selected.push_back(images[i * images.size() / options.maxFrames]);
+    }
+    return selected;
+}
+
+bool Int8Calibrator::apply(YOLODetector& detector, float confThreshold, float nmsThreshold) {
+    if (calibrated) {
+        return detector.quantize(calibration);
+    }
+
+    cv::Size inputSize(detector.getInputSize(), detector.getInputSize());
+    std::vector<cv::Mat> frames;
+    std::vector<std::vector<Detection>> reference;
+    cached = loadCache(inputSize);
+    if (!cached && !calibrate(detector, confThreshold, nmsThreshold, frames, reference)) {
+        return false;
+    }
+    calibrated = true;
+    if (!detector.quantize(calibration)) {
+        return false;
+    }
+    if (cached) {
+        return true;
+    }
+
+    std::vector<std::vector<Detection>> int8;
+    report.int8Ms = static_cast<float>(timeDetections(detector, frames, confThreshold, nmsThreshold, int8));
+    compare(reference, int8);
+    saveCache();
+    return true;
+}
+
+bool Int8Calibrator::calibrate(YOLODetector& detector, float confThreshold, float nmsThreshold,
+                               std::vector<cv::Mat>& frames,
+                               std::vector<std::vector<Detection>>& reference) {
+    for (const std::string& file : files) {
+        cv::Mat frame = cv::imread(file);
+        if (!frame.empty()) {
+            frames.push_back(frame);
+        }
+    }
+    if (frames.empty()) {
+        std::cerr << "Error: No calibration frames in: " << options.calibrationDir << std::endl;
+        return false;
+    }
+    std::cout << "Calibrating INT8 on " << frames.size() << " frames from "
+              << options.calibrationDir << std::endl;
+
+    report = Report();
+    report.frames = static_cast<int>(frames.size());
+    report.fp32Ms = static_cast<float>(timeDetections(detector, frames, confThreshold, nmsThreshold,
+                                                      reference));
+    detector.makeInputTensor(frames, calibration);
+    return true;
+}
+
+void Int8Calibrator::compare(const std::vector<std::vector<Detection>>& reference,
+                             const std::vector<std::vector<Detection>>& int8) {
+    report.fp32Detections = 0;
+    report.int8Detections = 0;
+    report.matched = 0;
+    double iouSum = 0.0;
+    double confidenceSum = 0.0;
+    std::vector<int> order;
+    std::vector<char> used;
+
+    for (size_t f = 0; f < reference.size() && f < int8.size(); ++f) {
+        const std::vector<Detection>& expected = reference[f];
+        const std::vector<Detection>& actual = int8[f];
+        report.fp32Detections += static_cast<int>(expected.size());
+        report.int8Detections += static_cast<int>(actual.size());
+
+        // Greedy, most confident FP32 boxes first: each takes the best
+        // overlapping unused INT8 box of its class
+        order.resize(expected.size());
+        for (size_t i = 0; i < expected.size(); ++i) {
+            order[i] = static_cast<int>(i);
+        }
+        std::sort(order.begin(), order.end(), [&expected](int a, int b) {
+            return expected[a].confidence > expected[b].confidence;
+        });
+        used.assign(actual.size(), 0);
+        for (int i : order) {
+            int best = -1;
+            float bestIoU = options.matchIoU;
+            for (size_t j = 0; j < actual.size(); ++j) {
+                if (used[j] || actual[j].classId != expected[i].classId) {
+                    continue;
+                }
+                float iou = SparseAssociator::calculateIoU(expected[i].bbox, actual[j].bbox);
+                if (iou >= bestIoU) {
+                    bestIoU = iou;
+                    best = static_cast<int>(j);
+                }
+            }
+            if (best >= 0) {
+                used[best] = 1;
+                report.matched++;
+                iouSum += bestIoU;
+                confidenceSum += actual[best].confidence - expected[i].confidence;
+            }
+        }
+    }
+    if (report.matched > 0) {
+        report.meanIoU = static_cast<float>(iouSum / report.matched);
+        report.meanConfidenceDelta = static_cast<float>(confidenceSum / report.matched);
+    }
+}
+
+bool Int8Calibrator::loadCache(const cv::Size& inputSize) {
+    if (cachePath.empty()) {
+        return false;
+    }
+    std::ifstream file(cachePath, std::ios::binary);
+    CalibrationHeader header;
+    if (!file.is_open() || !file.read(reinterpret_cast<char*>(&header), sizeof(header))) {
+        return false;
+    }
+    if (std::memcmp(header.magic, MAGIC, sizeof(MAGIC)) != 0 || header.version != VERSION ||
+        header.key != key || header.frames == 0 ||
+        static_cast<int>(header.width) != inputSize.width ||
+        static_cast<int>(header.height) != inputSize.height) {
+        return false;
+    }
+
+    int sizes[] = {static_cast<int>(header.frames), 3, inputSize.height, inputSize.width};
+    cv::Mat pixels(4, sizes, CV_8U);
+    if (!file.read(reinterpret_cast<char*>(pixels.ptr<uchar>()), pixels.total())) {
+        return false;
+    }
+    pixels.convertTo(calibration, CV_32F, 1.0 / 255.0);
+
+    report = Report();
+    report.frames = static_cast<int>(header.frames);
+    report.fp32Detections = static_cast<int>(header.fp32Detections);
+    report.int8Detections = static_cast<int>(header.int8Detections);
+    report.matched = static_cast<int>(header.matched);
+    report.meanIoU = header.meanIoU;
+    report.meanConfidenceDelta = header.meanConfidenceDelta;
+    report.fp32Ms = header.fp32Ms;
+    report.int8Ms = header.int8Ms;
+    std::cout << "Using cached INT8 calibration: " << cachePath << std::endl;
+    return true;
+}
+
+void Int8Calibrator::saveCache() const {
+    if (cachePath.empty()) {
+        return;
+    }
+    std::ofstream file(cachePath, std::ios::binary | std::ios::trunc);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not write INT8 calibration cache: " << cachePath << std::endl;
+        return;
+    }
+
+    CalibrationHeader header = {};
+    std::memcpy(header.magic, MAGIC, sizeof(MAGIC));
+    header.version = VERSION;
+    header.key = key;
+    header.frames = static_cast<uint32_t>(calibration.size[0]);
+    header.height = static_cast<uint32_t>(calibration.size[2]);
+    header.width = static_cast<uint32_t>(calibration.size[3]);
+    header.fp32Detections = static_cast<uint32_t>(report.fp32Detections);
+    header.int8Detections = static_cast<uint32_t>(report.int8Detections);
+    header.matched = static_cast<uint32_t>(report.matched);
+    header.meanIoU = report.meanIoU;
+    header.meanConfidenceDelta = report.meanConfidenceDelta;
+    header.fp32Ms = report.fp32Ms;
+    header.int8Ms = report.int8Ms;
+    file.write(reinterpret_cast<const char*>(&header), sizeof(header));
+
+    // Inputs are pixel / 255, so 8 bits per value keep the calibration
+    // ranges well within quantization precision
+    cv::Mat pixels;
+    calibration.convertTo(pixels, CV_8U, 255.0);
+    file.write(reinterpret_cast<const char*>(pixels.ptr<uchar>()), pixels.total());
+    std::cout << "Saved INT8 calibration to: " << cachePath << std::endl;
+}
+
+void Int8Calibrator::printReport(std::ostream& out) const {
+    out << "\n=== INT8 Accuracy vs FP32 ===" << std::endl;
+    out << "Calibration frames: " << report.frames << (cached ? " (cached)" : "") << std::endl;
+    out << "Detections: FP32 " << report.fp32Detections << ", INT8 " << report.int8Detections
+        << ", matched " << report.matched << std::endl;
+    out << std::fixed << std::setprecision(1)
+        << "Recall: " << 100.0f * report.recall() << "%, precision: "
+        << 100.0f * report.precision() << "%" << std::endl;
+    out << std::setprecision(3)
+        << "Mean IoU of matches: " << report.meanIoU
+        << ", mean confidence change: " << report.meanConfidenceDelta << std::endl;
+    out << std::setprecision(2)
+        << "Detect time per frame: FP32 " << report.fp32Ms << " ms, INT8 " << report.int8Ms << " ms";
+    if (report.int8Ms > 0.0f) {
+        out << " (" << report.fp32Ms / report.int8Ms << "x)";
+    }
+    out << std::endl;
+    out.unsetf(std::ios::floatfield);
+    out << std::setprecision(6);
+}
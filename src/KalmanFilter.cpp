@@ -1,77 +1,162 @@
 #include "KalmanFilter.h"
 
-KalmanFilter::KalmanFilter() : initialized(false) {
-    // State: [x, y, w, h, vx, vy, vw, vh]
-    // Measurement: [x, y, w, h]
-    kf.init(8, 4, 0);
-    
-    // Transition matrix (F)
-    cv::setIdentity(kf.transitionMatrix);
-    for (int i = 0; i < 4; ++i) {
-        kf.transitionMatrix.at<float>(i, i + 4) = 1.0f; // position += velocity
-    }
-    
-    // Measurement matrix (H)
-    kf.measurementMatrix = cv::Mat::zeros(4, 8, CV_32F);
-    for (int i = 0; i < 4; ++i) {
-        kf.measurementMatrix.at<float>(i, i) = 1.0f;
-    }
-    
-    // Process noise covariance (Q)
-    cv::setIdentity(kf.processNoiseCov, cv::Scalar::all(1e-2));
-    
-    // Measurement noise covariance (R)
-    cv::setIdentity(kf.measurementNoiseCov, cv::Scalar::all(1e-1));
-    
-    // Error covariance (P)
-    cv::setIdentity(kf.errorCovPost, cv::Scalar::all(1));
+// Entry (k, j) of the transition block for dt = 1: 1 / (j - k)!
+static inline float transitionCoefficient(int distance) {
+    float coefficient = 1.0f;
+    for (int i = 2; i <= distance; ++i) {
+        coefficient /= static_cast<float>(i);
+    }
+    return coefficient;
 }
 
-void KalmanFilter::init(const cv::Rect& bbox) {
-    kf.statePost = bboxToState(bbox);
-    initialized = true;
+template <int StateDim, int MeasDim>
+FixedKalmanFilter<StateDim, MeasDim>::FixedKalmanFilter(float processNoise, float measurementNoise)
+    : processNoise(processNoise), measurementNoise(measurementNoise), initialized(false) {
+    for (int i = 0; i < MEAN_SIZE; ++i) {
+        mean[i] = 0.0f;
+    }
+    for (int i = 0; i < COV_SIZE; ++i) {
+        cov[i] = 0.0f;
+    }
 }
 
-cv::Rect KalmanFilter::predict() {
-    if (!initialized) {
-        return cv::Rect();
+template <int StateDim, int MeasDim>
+void FixedKalmanFilter<StateDim, MeasDim>::initState(float* mean, float* cov,
+                                                    const float* measurement) {
+    // Position from the measurement, higher derivatives initialized to 0
+    for (int i = 0; i < MEAN_SIZE; ++i) {
+        mean[i] = i < MeasDim ? measurement[i] : 0.0f;
+    }
+
+    // Error covariance (P) = identity
+    for (int k = 0; k < ORDER; ++k) {
+        for (int l = 0; l < ORDER; ++l) {
+            for (int c = 0; c < MeasDim; ++c) {
+                cov[(k * ORDER + l) * MeasDim + c] = k == l ? 1.0f : 0.0f;
+            }
+        }
     }
-    
-    cv::Mat prediction = kf.predict();
-    return stateToBbox(prediction);
 }
 
-void KalmanFilter::update(const cv::Rect& bbox) {
-    if (!initialized) {
-        init(bbox);
-        return;
+template <int StateDim, int MeasDim>
+void FixedKalmanFilter<StateDim, MeasDim>::predictState(float* mean, float* cov,
+                                                       float processNoise) {
+    // x = F x: each derivative accumulates the higher ones. Ascending k only
+    // reads entries that have not been updated yet.
+    for (int k = 0; k < ORDER; ++k) {
+        for (int j = k + 1; j < ORDER; ++j) {
+            const float a = transitionCoefficient(j - k);
+            for (int c = 0; c < MeasDim; ++c) {
+                mean[k * MeasDim + c] += a * mean[j * MeasDim + c];
+            }
+        }
+    }
+
+    // P = F P F^T + Q, block by block. F is upper triangular, so row k of
+    // F P only sums over j >= k.
+    float fp[COV_SIZE];
+    for (int k = 0; k < ORDER; ++k) {
+        for (int l = 0; l < ORDER; ++l) {
+            float* out = fp + (k * ORDER + l) * MeasDim;
+            for (int c = 0; c < MeasDim; ++c) {
+                out[c] = cov[(k * ORDER + l) * MeasDim + c];
+            }
+            for (int j = k + 1; j < ORDER; ++j) {
+                const float a = transitionCoefficient(j - k);
+                for (int c = 0; c < MeasDim; ++c) {
+                    out[c] += a * cov[(j * ORDER + l) * MeasDim + c];
+                }
+            }
+        }
+    }
+    for (int k = 0; k < ORDER; ++k) {
+        for (int l = 0; l < ORDER; ++l) {
+            float* out = cov + (k * ORDER + l) * MeasDim;
+            for (int c = 0; c < MeasDim; ++c) {
+                out[c] = fp[(k * ORDER + l) * MeasDim + c] + (k == l ? processNoise : 0.0f);
+            }
+            for (int j = l + 1; j < ORDER; ++j) {
+                const float a = transitionCoefficient(j - l);
+                for (int c = 0; c < MeasDim; ++c) {
+                    out[c] += a * fp[(k * ORDER + j) * MeasDim + c];
+                }
+            }
+        }
+    }
+}
+
+template <int StateDim, int MeasDim>
+void FixedKalmanFilter<StateDim, MeasDim>::updateState(float* mean, float* cov,
+                                                      const float* measurement,
+                                                      float measurementNoise) {
+    // H selects derivative 0, so S = P00 + R and K = P[:, 0] / S per coordinate
+    float gain[ORDER * MeasDim];
+    float innovation[MeasDim];
+    for (int c = 0; c < MeasDim; ++c) {
+        const float invS = 1.0f / (cov[c] + measurementNoise);
+        innovation[c] = measurement[c] - mean[c];
+        for (int k = 0; k < ORDER; ++k) {
+            gain[k * MeasDim + c] = cov[(k * ORDER) * MeasDim + c] * invS;
+        }
+    }
+
+    // x += K y
+    for (int k = 0; k < ORDER; ++k) {
+        for (int c = 0; c < MeasDim; ++c) {
+            mean[k * MeasDim + c] += gain[k * MeasDim + c] * innovation[c];
+        }
+    }
+
+    // P -= K H P, where H P is row 0 of each block (copied before it changes)
+    float row0[ORDER * MeasDim];
+    for (int l = 0; l < ORDER * MeasDim; ++l) {
+        row0[l] = cov[l];
+    }
+    for (int k = 0; k < ORDER; ++k) {
+        for (int l = 0; l < ORDER; ++l) {
+            for (int c = 0; c < MeasDim; ++c) {
+                cov[(k * ORDER + l) * MeasDim + c] -= gain[k * MeasDim + c] * row0[l * MeasDim + c];
+            }
+        }
+    }
+}
+
+template <int StateDim, int MeasDim>
+void FixedKalmanFilter<StateDim, MeasDim>::predictBatch(float* means, float* covs, int count,
+                                                       float processNoise) {
+    for (int i = 0; i < count; ++i) {
+        predictState(means + i * MEAN_SIZE, covs + i * COV_SIZE, processNoise);
+    }
+}
+
+template <int StateDim, int MeasDim>
+void FixedKalmanFilter<StateDim, MeasDim>::updateBatch(float* means, float* covs, const int* slots,
+                                                      const float* measurements, int count,
+                                                      float measurementNoise) {
+    for (int i = 0; i < count; ++i) {
+        updateState(means + slots[i] * MEAN_SIZE, covs + slots[i] * COV_SIZE,
+                    measurements + i * MeasDim, measurementNoise);
     }
-    
-    cv::Mat measurement = cv::Mat::zeros(4, 1, CV_32F);
-    measurement.at<float>(0) = bbox.x + bbox.width / 2.0f;
-    measurement.at<float>(1) = bbox.y + bbox.height / 2.0f;
-    measurement.at<float>(2) = bbox.width;
-    measurement.at<float>(3) = bbox.height;
-    
-    kf.correct(measurement);
 }
 
-cv::Mat KalmanFilter::bboxToState(const cv::Rect& bbox) const {
-    cv::Mat state = cv::Mat::zeros(8, 1, CV_32F);
-    state.at<float>(0) = bbox.x + bbox.width / 2.0f;   // center x
-    state.at<float>(1) = bbox.y + bbox.height / 2.0f;  // center y
-    state.at<float>(2) = bbox.width;
-    state.at<float>(3) = bbox.height;
-    // velocities initialized to 0
-    return state;
+template <int StateDim, int MeasDim>
+void FixedKalmanFilter<StateDim, MeasDim>::bboxToMeasurement(const cv::Rect& bbox,
+                                                            float* measurement) {
+    static_assert(MeasDim == 4, "Box measurements are [cx, cy, w, h]");
+    measurement[0] = bbox.x + bbox.width / 2.0f;   // center x
+    measurement[1] = bbox.y + bbox.height / 2.0f;  // center y
+    measurement[2] = static_cast<float>(bbox.width);
+    measurement[3] = static_cast<float>(bbox.height);
 }
 
-cv::Rect KalmanFilter::stateToBbox(const cv::Mat& state) const {
-    float cx = state.at<float>(0);
-    float cy = state.at<float>(1);
-    float w = state.at<float>(2);
-    float h = state.at<float>(3);
-    
+template <int StateDim, int MeasDim>
+cv::Rect FixedKalmanFilter<StateDim, MeasDim>::stateToBbox(const float* mean) {
+    static_assert(MeasDim == 4, "Box measurements are [cx, cy, w, h]");
+    float cx = mean[0];
+    float cy = mean[1];
+    float w = mean[2];
+    float h = mean[3];
+
     return cv::Rect(
         static_cast<int>(cx - w / 2),
         static_cast<int>(cy - h / 2),
@@ -79,3 +164,45 @@ cv::Rect KalmanFilter::stateToBbox(const cv::Mat& state) const {
         static_cast<int>(h)
     );
 }
+
+template <int StateDim, int MeasDim>
+void FixedKalmanFilter<StateDim, MeasDim>::init(const cv::Rect& bbox) {
+    float measurement[MeasDim];
+    bboxToMeasurement(bbox, measurement);
+    initState(mean, cov, measurement);
+    initialized = true;
+}
+
+template <int StateDim, int MeasDim>
+cv::Rect FixedKalmanFilter<StateDim, MeasDim>::predict() {
+    if (!initialized) {
+        return cv::Rect();
+    }
+
+    predictState(mean, cov, processNoise);
+    return stateToBbox(mean);
+}
+
+template <int StateDim, int MeasDim>
+void FixedKalmanFilter<StateDim, MeasDim>::update(const cv::Rect& bbox) {
+    if (!initialized) {
+        init(bbox);
+        return;
+    }
+
+    float measurement[MeasDim];
+    bboxToMeasurement(bbox, measurement);
+    updateState(mean, cov, measurement, measurementNoise);
+}
+
+template <int StateDim, int MeasDim>
+cv::Rect FixedKalmanFilter<StateDim, MeasDim>::getBbox() const {
+    if (!initialized) {
+        return cv::Rect();
+    }
+
+    return stateToBbox(mean);
+}
+
+template class FixedKalmanFilter<8, 4>;
+template class FixedKalmanFilter<12, 4>;
@@ -0,0 +1,77 @@
+#include "LatencyController.h"
+#include <algorithm>
+#include <cmath>
+#include <functional>
+
+LatencyController::LatencyController(const Options& options, int inputSize, int stride)
+    : options(options) {
+    this->options.window = std::max(1, options.window);
+
+    // Input sizes best first, as the detector will round them; strides ascending
+    std::vector<int> sizes;
+    for (int size : options.inputSizes) {
+        sizes.push_back(std::max(32, size / 32 * 32));
+    }
+    std::vector<int> strides;
+    for (int value : options.strides) {
+        strides.push_back(std::max(1, value));
+    }
+    if (sizes.empty()) {
+        sizes.push_back(std::max(32, inputSize / 32 * 32));
+    }
+    if (strides.empty()) {
+        strides.push_back(std::max(1, stride));
+    }
+    std::sort(sizes.begin(), sizes.end(), std::greater<int>());
+    sizes.erase(std::unique(sizes.begin(), sizes.end()), sizes.end());
+    std::sort(strides.begin(), strides.end());
+    strides.erase(std::unique(strides.begin(), strides.end()), strides.end());
+
+    for (int size : sizes) {
+        ladder.push_back({size, strides.front()});
+    }
+    for (size_t i = 1; i < strides.size(); ++i) {
+        ladder.push_back({sizes.back(), strides[i]});
+    }
+
+    double start = cost({inputSize, std::max(1, stride)});
+    for (size_t i = 1; i < ladder.size(); ++i) {
+        if (std::fabs(cost(ladder[i]) - start) < std::fabs(cost(ladder[level]) - start)) {
+            level = static_cast<int>(i);
+        }
+    }
+}
+
+double LatencyController::cost(const Level& level) {
+    return static_cast<double>(level.inputSize) * level.inputSize / level.stride;
+}
+
+bool LatencyController::record(double milliseconds) {
+    if (!options.enabled) {
+        return false;
+    }
+    framesAtLevel++;
+    sum += milliseconds;
+    if (++samples < options.window) {
+        return false;
+    }
+    double mean = sum / samples;
+    samples = 0;
+    sum = 0.0;
+
+    int next = level;
+    if (mean > options.budgetMs && level + 1 < static_cast<int>(ladder.size())) {
+        next = level + 1;
+    } else if (level > 0 && framesAtLevel >= options.cooldown &&
+               mean * cost(ladder[level - 1]) / cost(ladder[level]) <
+                   options.upgradeHeadroom * options.budgetMs) {
+        next = level - 1;
+    }
+    if (next == level) {
+        return false;
+    }
+    level = next;
+    framesAtLevel = 0;
+    changes++;
+    return true;
+}
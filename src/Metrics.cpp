@@ -0,0 +1,275 @@
+#include "Metrics.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+
+// Index of the highest set bit (value > 0)
+static inline int highestBit(uint64_t value) {
+#if defined(__GNUC__) || defined(__clang__)
+    return 63 - __builtin_clzll(value);
+#else
+    int bit = 0;
+    while (value >>= 1) {
+        bit++;
+    }
+    return bit;
+#endif
+}
+
+Histogram::Histogram() : count(0), sum(0), max(0) {
+    for (auto& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+}
+
+int Histogram::bucketOf(uint64_t value) {
+    if (value < LINEAR_LIMIT) {
+        return static_cast<int>(value);
+    }
+    int exponent = highestBit(value);
+    int sub = static_cast<int>(value >> (exponent - SUB_BUCKET_BITS)) & ((1 << SUB_BUCKET_BITS) - 1);
+    return LINEAR_LIMIT + (exponent - 4) * (1 << SUB_BUCKET_BITS) + sub;
+}
+
+uint64_t Histogram::bucketUpperBound(int bucket) {
+    if (bucket < LINEAR_LIMIT) {
+        return static_cast<uint64_t>(bucket);
+    }
+    int exponent = (bucket - LINEAR_LIMIT) / (1 << SUB_BUCKET_BITS) + 4;
+    uint64_t sub = (bucket - LINEAR_LIMIT) % (1 << SUB_BUCKET_BITS);
+    uint64_t width = uint64_t(1) << (exponent - SUB_BUCKET_BITS);
+    uint64_t lower = ((uint64_t(1) << SUB_BUCKET_BITS) + sub) * width;
+    return lower + (width - 1);
+}
+
+void Histogram::record(uint64_t value) {
+    buckets[bucketOf(value)].fetch_add(1, std::memory_order_relaxed);
+    count.fetch_add(1, std::memory_order_relaxed);
+    sum.fetch_add(value, std::memory_order_relaxed);
+    uint64_t current = max.load(std::memory_order_relaxed);
+    while (value > current &&
+           !max.compare_exchange_weak(current, value, std::memory_order_relaxed)) {
+    }
+}
+
+void Histogram::reset() {
+    for (auto& bucket : buckets) {
+        bucket.store(0, std::memory_order_relaxed);
+    }
+    count.store(0, std::memory_order_relaxed);
+    sum.store(0, std::memory_order_relaxed);
+    max.store(0, std::memory_order_relaxed);
+}
+
+Histogram::Summary Histogram::summarize() const {
+    Summary summary;
+    summary.sum = sum.load(std::memory_order_relaxed);
+    summary.max = max.load(std::memory_order_relaxed);
+
+    // Count from the buckets themselves so the percentiles are consistent
+    uint64_t snapshot[BUCKET_COUNT];
+    for (int b = 0; b < BUCKET_COUNT; ++b) {
+        snapshot[b] = buckets[b].load(std::memory_order_relaxed);
+        summary.count += snapshot[b];
+    }
+    if (summary.count == 0) {
+        return summary;
+    }
+
+    const double quantiles[] = {0.50, 0.95, 0.99};
+    uint64_t* targets[] = {&summary.p50, &summary.p95, &summary.p99};
+    uint64_t cumulative = 0;
+    int next = 0;
+    for (int b = 0; b < BUCKET_COUNT && next < 3; ++b) {
+        cumulative += snapshot[b];
+        while (next < 3 && cumulative >= quantiles[next] * summary.count) {
+            *targets[next] = std::min(bucketUpperBound(b), summary.max);
+            next++;
+        }
+    }
+    return summary;
+}
+
+Metrics& Metrics::global() {
+    static Metrics metrics;
+    return metrics;
+}
+
+Metrics::Metrics() : active(false), created(std::chrono::steady_clock::now()) {
+    for (auto& counter : counters) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+}
+
+const char* Metrics::stageName(Stage stage) {
+    static const char* const names[] = {
+        "decode", "motion_gate", "preprocess", "forward", "output_decode", "nms", "predict",
+        "cost_matrix", "assignment", "track_management", "render", "encode", "write",
+        "end_to_end"};
+    return names[static_cast<int>(stage)];
+}
+
+const char* Metrics::valueName(Value value) {
+    static const char* const names[] = {"detections_per_frame", "tracks_per_frame"};
+    return names[static_cast<int>(value)];
+}
+
+const char* Metrics::counterName(Counter counter) {
+    static const char* const names[] = {"frames", "detections", "track_births", "track_deaths",
+                                        "dropped_frames", "motion_skipped_frames", "region_frames"};
+    return names[static_cast<int>(counter)];
+}
+
+void Metrics::writeJson(std::ostream& out) const {
+    double uptime = std::chrono::duration<double>(std::chrono::steady_clock::now() - created).count();
+    out << std::fixed << std::setprecision(3);
+    out << "{\n  \"uptime_s\": " << uptime << ",\n  \"stages_ms\": {";
+    const char* separator = "\n";
+    for (int s = 0; s < static_cast<int>(Stage::Count); ++s) {
+        Histogram::Summary h = latencies[s].summarize();
+        out << separator << "    \"" << stageName(static_cast<Stage>(s)) << "\": {\"count\": " << h.count
+            << ", \"mean\": " << h.mean() * 1e-6 << ", \"p50\": " << h.p50 * 1e-6
+            << ", \"p95\": " << h.p95 * 1e-6 << ", \"p99\": " << h.p99 * 1e-6
+            << ", \"max\": " << h.max * 1e-6 << "}";
+        separator = ",\n";
+    }
+    out << "\n  },\n  \"per_frame\": {";
+    separator = "\n";
+    for (int v = 0; v < static_cast<int>(Value::Count); ++v) {
+        Histogram::Summary h = values[v].summarize();
+        out << separator << "    \"" << valueName(static_cast<Value>(v)) << "\": {\"mean\": " << h.mean()
+            << ", \"p50\": " << h.p50 << ", \"p95\": " << h.p95 << ", \"p99\": " << h.p99
+            << ", \"max\": " << h.max << "}";
+        separator = ",\n";
+    }
+    out << "\n  },\n  \"counters\": {";
+    separator = "\n";
+    for (int c = 0; c < static_cast<int>(Counter::Count); ++c) {
+        out << separator << "    \"" << counterName(static_cast<Counter>(c)) << "\": "
+            << counters[c].load(std::memory_order_relaxed);
+        separator = ",\n";
+    }
+    out << "\n  }\n}\n";
+    out << std::defaultfloat;
+}
+
+void Metrics::writePrometheus(std::ostream& out) const {
+    out << std::setprecision(9);
+    out << "# HELP mot_stage_latency_seconds Per-stage latency since start.\n"
+        << "# TYPE mot_stage_latency_seconds summary\n";
+    for (int s = 0; s < static_cast<int>(Stage::Count); ++s) {
+        Histogram::Summary h = latencies[s].summarize();
+        const char* name = stageName(static_cast<Stage>(s));
+        out << "mot_stage_latency_seconds{stage=\"" << name << "\",quantile=\"0.5\"} " << h.p50 * 1e-9 << "\n"
+            << "mot_stage_latency_seconds{stage=\"" << name << "\",quantile=\"0.95\"} " << h.p95 * 1e-9 << "\n"
+            << "mot_stage_latency_seconds{stage=\"" << name << "\",quantile=\"0.99\"} " << h.p99 * 1e-9 << "\n"
+            << "mot_stage_latency_seconds_sum{stage=\"" << name << "\"} " << h.sum * 1e-9 << "\n"
+            << "mot_stage_latency_seconds_count{stage=\"" << name << "\"} " << h.count << "\n";
+    }
+
+    for (int v = 0; v < static_cast<int>(Value::Count); ++v) {
+        Histogram::Summary h = values[v].summarize();
+        std::string name = std::string("mot_") + valueName(static_cast<Value>(v));
+        out << "# TYPE " << name << " summary\n"
+            << name << "{quantile=\"0.5\"} " << h.p50 << "\n"
+            << name << "{quantile=\"0.95\"} " << h.p95 << "\n"
+            << name << "{quantile=\"0.99\"} " << h.p99 << "\n"
+            << name << "_sum " << h.sum << "\n"
+            << name << "_count " << h.count << "\n";
+    }
+
+    for (int c = 0; c < static_cast<int>(Counter::Count); ++c) {
+        std::string name = std::string("mot_") + counterName(static_cast<Counter>(c)) + "_total";
+        out << "# TYPE " << name << " counter\n"
+            << name << " " << counters[c].load(std::memory_order_relaxed) << "\n";
+    }
+    out << std::defaultfloat;
+}
+
+void Metrics::printSummary(std::ostream& out) const {
+    out << std::left << std::setw(18) << "stage" << std::right << std::setw(10) << "count"
+        << std::setw(10) << "mean ms" << std::setw(10) << "p50" << std::setw(10) << "p95"
+        << std::setw(10) << "p99" << std::setw(10) << "max" << "\n";
+    out << std::fixed << std::setprecision(2);
+    for (int s = 0; s < static_cast<int>(Stage::Count); ++s) {
+        Histogram::Summary h = latencies[s].summarize();
+        if (h.count == 0) {
+            continue;
+        }
+        out << std::left << std::setw(18) << stageName(static_cast<Stage>(s)) << std::right
+            << std::setw(10) << h.count << std::setw(10) << h.mean() * 1e-6
+            << std::setw(10) << h.p50 * 1e-6 << std::setw(10) << h.p95 * 1e-6
+            << std::setw(10) << h.p99 * 1e-6 << std::setw(10) << h.max * 1e-6 << "\n";
+    }
+    for (int c = 0; c < static_cast<int>(Counter::Count); ++c) {
+        out << counterName(static_cast<Counter>(c)) << ": "
+            << counters[c].load(std::memory_order_relaxed) << (c + 1 < static_cast<int>(Counter::Count) ? ", " : "\n");
+    }
+    out << std::defaultfloat;
+}
+
+void Metrics::reset() {
+    for (auto& histogram : latencies) {
+        histogram.reset();
+    }
+    for (auto& histogram : values) {
+        histogram.reset();
+    }
+    for (auto& counter : counters) {
+        counter.store(0, std::memory_order_relaxed);
+    }
+}
+
+MetricsExporter::MetricsExporter(const std::string& path, Format format, double intervalSeconds)
+    : path(path), format(format),
+      interval(std::max<long long>(100, static_cast<long long>(intervalSeconds * 1000.0))) {
+    worker = std::thread([this]() {
+        std::unique_lock<std::mutex> lock(mutex);
+        bool done = false;
+        while (!done) {
+            // Always export once more after stop() for the final totals
+            done = wake.wait_for(lock, interval, [this]() { return stopping; });
+            lock.unlock();
+            exportNow();
+            lock.lock();
+        }
+    });
+}
+
+MetricsExporter::~MetricsExporter() {
+    stop();
+}
+
+void MetricsExporter::stop() {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = true;
+        wake.notify_all();
+    }
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+bool MetricsExporter::exportNow() {
+    std::string temporary = path + ".tmp";
+    {
+        std::ofstream file(temporary);
+        if (!file.is_open()) {
+            std::cerr << "Error: Could not write metrics file: " << temporary << std::endl;
+            return false;
+        }
+        if (format == Format::Prometheus) {
+            Metrics::global().writePrometheus(file);
+        } else {
+            Metrics::global().writeJson(file);
+        }
+    }
+    return std::rename(temporary.c_str(), path.c_str()) == 0;
+}
+
+MetricsExporter::Format MetricsExporter::parseFormat(const std::string& name) {
+    return name == "prometheus" ? Format::Prometheus : Format::Json;
+}
@@ -0,0 +1,254 @@
+#include "MotEvaluator.h"
+#include <algorithm>
+#include <cstdio>
+#include <fstream>
+
+static uint64_t pairKey(int truthId, int hypothesisId) {
+    return (static_cast<uint64_t>(static_cast<uint32_t>(truthId)) << 32) |
+           static_cast<uint32_t>(hypothesisId);
+}
+
+bool MotEvaluator::loadGroundTruth(const std::string& path, const std::vector<int>& evaluatedClasses) {
+    groundTruth.clear();
+    reset();
+    std::ifstream file(path);
+    if (!file.is_open()) {
+        return false;
+    }
+
+    std::string line;
+    while (std::getline(file, line)) {
+        int frame = 0;
+        int id = 0;
+        float x = 0, y = 0, width = 0, height = 0, consider = 1;
+        int classId = -1;
+        int fields = std::sscanf(line.c_str(), "%d,%d,%f,%f,%f,%f,%f,%d", &frame, &id, &x, &y,
+                                 &width, &height, &consider, &classId);
+        if (fields < 6 || frame < 1) {
+            continue;
+        }
+        bool evaluatedClass = fields < 8 || std::find(evaluatedClasses.begin(), evaluatedClasses.end(),
+                                                      classId) != evaluatedClasses.end();
+        if (static_cast<size_t>(frame) > groundTruth.size()) {
+            groundTruth.resize(frame);
+        }
+        groundTruth[frame - 1].push_back(
+            {id, cv::Rect(cvRound(x), cvRound(y), cvRound(width), cvRound(height)),
+             consider == 0 || !evaluatedClass});
+    }
+    return true;
+}
+
+void MotEvaluator::reset() {
+    totals = Summary();
+    iouSum = 0.0;
+    lastMatch.clear();
+    pairFrames.clear();
+}
+
+float MotEvaluator::iou(const cv::Rect& a, const cv::Rect& b) {
+    int intersection = (a & b).area();
+    int unionArea = a.area() + b.area() - intersection;
+    return unionArea > 0 ? static_cast<float>(intersection) / unionArea : 0.0f;
+}
+
+void MotEvaluator::matchBoxes(const std::vector<const cv::Rect*>& rows,
+                              const std::vector<const cv::Rect*>& columns) {
+    int rowCount = static_cast<int>(rows.size());
+    int columnCount = static_cast<int>(columns.size());
+    assignment.assign(rowCount, -1);
+    if (rowCount == 0 || columnCount == 0) {
+        return;
+    }
+
+    // Pairs below MIN_IOU cost more than any full set of admissible pairs
+    // (each below 1), so the solver first maximizes the number of matches,
+    // as CLEAR-MOT requires, and then their IoU. The sentinel stays small
+    // enough that float duals keep the IoU differences.
+    const float noMatch = 1.0f + std::min(rowCount, columnCount);
+    cost.resize(static_cast<size_t>(rowCount) * columnCount);
+    for (int r = 0; r < rowCount; ++r) {
+        for (int c = 0; c < columnCount; ++c) {
+            float overlap = iou(*rows[r], *columns[c]);
+            cost[r * columnCount + c] = overlap >= MIN_IOU ? 1.0f - overlap : noMatch;
+        }
+    }
+    solver.solve(cost.data(), rowCount, columnCount, assignment.data());
+    for (int r = 0; r < rowCount; ++r) {
+        if (assignment[r] >= 0 && cost[r * columnCount + assignment[r]] >= noMatch) {
+            assignment[r] = -1;
+        }
+    }
+}
+
+void MotEvaluator::addFrame(int frameIndex, const std::vector<Track>& tracks) {
+    static const std::vector<Box> noTruth;
+    const std::vector<Box>& truth = frameIndex >= 0 && frameIndex < getFrameCount()
+                                    ? groundTruth[frameIndex] : noTruth;
+    totals.frames++;
+
+    hypotheses.clear();
+    for (const auto& track : tracks) {
+        hypotheses.push_back({track.getId(), track.getCurrentBbox(), false});
+    }
+
+    // Discard hypotheses that match ignored boxes, matching against all boxes
+    // so a hypothesis on a pedestrian is not lost to an overlapping distractor
+    bool anyIgnored = std::any_of(truth.begin(), truth.end(),
+                                  [](const Box& box) { return box.ignored; });
+    if (anyIgnored && !hypotheses.empty()) {
+        std::vector<const cv::Rect*> rows;
+        std::vector<const cv::Rect*> columns;
+        for (const auto& box : truth) {
+            rows.push_back(&box.bbox);
+        }
+        for (const auto& box : hypotheses) {
+            columns.push_back(&box.bbox);
+        }
+        matchBoxes(rows, columns);
+        for (size_t r = 0; r < truth.size(); ++r) {
+            if (truth[r].ignored && assignment[r] >= 0) {
+                hypotheses[assignment[r]].ignored = true;
+            }
+        }
+        hypotheses.erase(std::remove_if(hypotheses.begin(), hypotheses.end(),
+                                        [](const Box& box) { return box.ignored; }),
+                         hypotheses.end());
+    }
+
+    // Evaluated ground truth, indices into truth
+    std::vector<int> evaluated;
+    for (size_t t = 0; t < truth.size(); ++t) {
+        if (!truth[t].ignored) {
+            evaluated.push_back(static_cast<int>(t));
+        }
+    }
+    totals.groundTruth += static_cast<int>(evaluated.size());
+    totals.hypotheses += static_cast<int>(hypotheses.size());
+
+    // Keep last correspondences that are still valid
+    truthMatch.assign(evaluated.size(), -1);
+    hypothesisUsed.assign(hypotheses.size(), 0);
+    for (size_t e = 0; e < evaluated.size(); ++e) {
+        const Box& box = truth[evaluated[e]];
+        auto previous = lastMatch.find(box.id);
+        if (previous == lastMatch.end()) {
+            continue;
+        }
+        for (size_t h = 0; h < hypotheses.size(); ++h) {
+            if (!hypothesisUsed[h] && hypotheses[h].id == previous->second &&
+                iou(box.bbox, hypotheses[h].bbox) >= MIN_IOU) {
+                truthMatch[e] = static_cast<int>(h);
+                hypothesisUsed[h] = 1;
+                break;
+            }
+        }
+    }
+
+    // Assign the rest by overlap
+    std::vector<const cv::Rect*> rows;
+    std::vector<const cv::Rect*> columns;
+    rowIndex.clear();
+    columnIndex.clear();
+    for (size_t e = 0; e < evaluated.size(); ++e) {
+        if (truthMatch[e] < 0) {
+            rows.push_back(&truth[evaluated[e]].bbox);
+            rowIndex.push_back(static_cast<int>(e));
+        }
+    }
+    for (size_t h = 0; h < hypotheses.size(); ++h) {
+        if (!hypothesisUsed[h]) {
+            columns.push_back(&hypotheses[h].bbox);
+            columnIndex.push_back(static_cast<int>(h));
+        }
+    }
+    matchBoxes(rows, columns);
+    for (size_t r = 0; r < rows.size(); ++r) {
+        if (assignment[r] < 0) {
+            continue;
+        }
+        int e = rowIndex[r];
+        int h = columnIndex[assignment[r]];
+        truthMatch[e] = h;
+        hypothesisUsed[h] = 1;
+
+        auto previous = lastMatch.find(truth[evaluated[e]].id);
+        if (previous != lastMatch.end() && previous->second != hypotheses[h].id) {
+            totals.idSwitches++;
+        }
+        lastMatch[truth[evaluated[e]].id] = hypotheses[h].id;
+    }
+
+    int matched = 0;
+    for (size_t e = 0; e < evaluated.size(); ++e) {
+        if (truthMatch[e] >= 0) {
+            matched++;
+            iouSum += iou(truth[evaluated[e]].bbox, hypotheses[truthMatch[e]].bbox);
+        }
+    }
+    totals.matches += matched;
+    totals.misses += static_cast<int>(evaluated.size()) - matched;
+    totals.falsePositives += static_cast<int>(hypotheses.size()) - matched;
+
+    // Identity bookkeeping: every overlapping pair, not only the matches
+    for (int t : evaluated) {
+        for (const auto& hypothesis : hypotheses) {
+            if (iou(truth[t].bbox, hypothesis.bbox) >= MIN_IOU) {
+                pairFrames[pairKey(truth[t].id, hypothesis.id)]++;
+            }
+        }
+    }
+}
+
+MotEvaluator::Summary MotEvaluator::summarize() const {
+    Summary summary = totals;
+    if (summary.groundTruth > 0) {
+        summary.mota = 1.0 - static_cast<double>(summary.misses + summary.falsePositives +
+                                                 summary.idSwitches) / summary.groundTruth;
+    }
+    if (summary.matches > 0) {
+        summary.motp = iouSum / summary.matches;
+    }
+
+    // Best one-to-one identity matching: maximize the frames the matched
+    // pairs overlap. Only ids that overlap at least once can contribute.
+    std::unordered_map<int, int> truthRows;
+    std::unordered_map<int, int> hypothesisColumns;
+    for (const auto& pair : pairFrames) {
+        int truthId = static_cast<int>(static_cast<uint32_t>(pair.first >> 32));
+        int hypothesisId = static_cast<int>(static_cast<uint32_t>(pair.first));
+        truthRows.emplace(truthId, static_cast<int>(truthRows.size()));
+        hypothesisColumns.emplace(hypothesisId, static_cast<int>(hypothesisColumns.size()));
+    }
+
+    long long idTruePositives = 0;
+    if (!pairFrames.empty()) {
+        int rows = static_cast<int>(truthRows.size());
+        int columns = static_cast<int>(hypothesisColumns.size());
+        std::vector<float> gains(static_cast<size_t>(rows) * columns, 0.0f);
+        for (const auto& pair : pairFrames) {
+            int r = truthRows[static_cast<int>(static_cast<uint32_t>(pair.first >> 32))];
+            int c = hypothesisColumns[static_cast<int>(static_cast<uint32_t>(pair.first))];
+            gains[r * columns + c] = -static_cast<float>(pair.second);
+        }
+        std::vector<int> identityAssignment(rows, -1);
+        HungarianAlgorithm identitySolver;
+        identitySolver.solve(gains.data(), rows, columns, identityAssignment.data());
+        for (int r = 0; r < rows; ++r) {
+            if (identityAssignment[r] >= 0) {
+                idTruePositives -= static_cast<long long>(gains[r * columns + identityAssignment[r]]);
+            }
+        }
+    }
+
+    if (summary.groundTruth + summary.hypotheses > 0) {
+        summary.idf1 = 2.0 * idTruePositives / (summary.groundTruth + summary.hypotheses);
+    }
+    if (summary.hypotheses > 0) {
+        summary.idPrecision = static_cast<double>(idTruePositives) / summary.hypotheses;
+    }
+    if (summary.groundTruth > 0) {
+        summary.idRecall = static_cast<double>(idTruePositives) / summary.groundTruth;
+    }
+    return summary;
+}
@@ -0,0 +1,130 @@
+#include "MotionGate.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <cmath>
+
+void MotionGate::reset() {
+    background.release();
+    sinceRefresh = 0;
+}
+
+MotionGate::Decision MotionGate::record(Decision decision) {
+    Metrics& metrics = Metrics::global();
+    switch (decision) {
+    case Decision::Skip:
+        stats.skipped++;
+        metrics.add(Metrics::Counter::MotionSkippedFrames);
+        break;
+    case Decision::Regions:
+        stats.regions++;
+        metrics.add(Metrics::Counter::RegionFrames);
+        break;
+    case Decision::FullFrame:
+        stats.fullFrames++;
+        sinceRefresh = 0;
+        break;
+    }
+    return decision;
+}
+
+MotionGate::Decision MotionGate::analyze(const cv::Mat& frame, const std::vector<cv::Rect>& trackBoxes,
+                                         bool force, std::vector<cv::Rect>& regions) {
+    regions.clear();
+    if (!options.enabled || frame.empty()) {
+        return Decision::FullFrame;
+    }
+    ScopedTimer gateTimer(Metrics::Stage::MotionGate);
+
+    // Gray, blurred thumbnail: cheap, and insensitive to sensor noise
+    int width = std::max(16, std::min(options.analysisWidth, frame.cols));
+    int height = std::max(1, frame.rows * width / frame.cols);
+    cv::resize(frame, small, cv::Size(width, height), 0, 0, cv::INTER_AREA);
+    if (small.channels() == 3) {
+        cv::cvtColor(small, gray, cv::COLOR_BGR2GRAY);
+    } else {
+        small.copyTo(gray);
+    }
+    cv::GaussianBlur(gray, gray, cv::Size(5, 5), 0);
+
+    if (background.empty() || background.size() != gray.size()) {
+        gray.convertTo(background, CV_32F);
+        return record(Decision::FullFrame);
+    }
+
+    background.convertTo(background8u, CV_8U);
+    cv::absdiff(gray, background8u, difference);
+    cv::accumulateWeighted(gray, background, options.backgroundRate);
+    sinceRefresh++;
+    if (options.refreshInterval > 0 && sinceRefresh >= options.refreshInterval) {
+        return record(Decision::FullFrame);
+    }
+
+    cv::threshold(difference, mask, options.pixelThreshold, 255, cv::THRESH_BINARY);
+    cv::dilate(mask, mask, cv::Mat(), cv::Point(-1, -1), 2);
+    cv::findContours(mask, contours, cv::RETR_EXTERNAL, cv::CHAIN_APPROX_SIMPLE);
+
+    // Motion regions, back in frame pixels
+    const double toFrameX = static_cast<double>(frame.cols) / width;
+    const double toFrameY = static_cast<double>(frame.rows) / height;
+    const double minPixels = options.minArea * width * height;
+    for (const auto& contour : contours) {
+        cv::Rect box = cv::boundingRect(contour);
+        if (box.area() < minPixels) {
+            continue;
+        }
+        regions.emplace_back(static_cast<int>(box.x * toFrameX), static_cast<int>(box.y * toFrameY),
+                             static_cast<int>(std::ceil(box.width * toFrameX)),
+                             static_cast<int>(std::ceil(box.height * toFrameY)));
+    }
+    if (regions.empty() && !force) {
+        return record(Decision::Skip);
+    }
+
+    // Tracked objects are detected again so their tracks stay anchored
+    regions.insert(regions.end(), trackBoxes.begin(), trackBoxes.end());
+    mergeRegions(regions, frame.size());
+    if (regions.empty()) {
+        return record(force ? Decision::FullFrame : Decision::Skip);
+    }
+
+    long long covered = 0;
+    for (const cv::Rect& region : regions) {
+        covered += region.area();
+    }
+    if (static_cast<int>(regions.size()) > options.maxRegions ||
+        covered > options.maxCoverage * frame.cols * frame.rows) {
+        regions.clear();
+        return record(Decision::FullFrame);
+    }
+    return record(Decision::Regions);
+}
+
+void MotionGate::mergeRegions(std::vector<cv::Rect>& regions, const cv::Size& frameSize) const {
+    const cv::Rect bounds(0, 0, frameSize.width, frameSize.height);
+    for (cv::Rect& region : regions) {
+        int dx = static_cast<int>(region.width * options.margin);
+        int dy = static_cast<int>(region.height * options.margin);
+        region = cv::Rect(region.x - dx, region.y - dy, region.width + 2 * dx,
+                          region.height + 2 * dy) & bounds;
+    }
+    regions.erase(std::remove_if(regions.begin(), regions.end(),
+                                 [](const cv::Rect& region) { return region.empty(); }),
+                  regions.end());
+
+    // A union can reach boxes that neither part overlapped, so repeat
+    // until a pass merges nothing; region counts are small
+    bool merged = true;
+    while (merged) {
+        merged = false;
+        for (size_t i = 0; i < regions.size() && !merged; ++i) {
+            for (size_t j = i + 1; j < regions.size(); ++j) {
+                if ((regions[i] & regions[j]).area() > 0) {
+                    regions[i] |= regions[j];
+                    regions.erase(regions.begin() + j);
+                    merged = true;
+                    break;
+                }
+            }
+        }
+    }
+}
@@ -0,0 +1,174 @@
+#include "NonMaxSuppressor.h"
+#include <algorithm>
+
+// Upper bound on grid cells; the cell size grows for very spread-out boxes
+static const long long MAX_GRID_CELLS = 1 << 16;
+
+// Smallest cell edge in pixels
+static const int MIN_CELL_SIZE = 8;
+
+NonMaxSuppressor::Mode NonMaxSuppressor::parseMode(const std::string& name) {
+    return name == "agnostic" ? Mode::ClassAgnostic : Mode::PerClass;
+}
+
+void NonMaxSuppressor::run(const cv::Rect* boxes, const float* scores, const int* classIds,
+                           int count, float scoreThreshold, float iouThreshold,
+                           std::vector<int>& keep) {
+    keep.clear();
+    if (count <= 0) {
+        return;
+    }
+
+    sortCandidates(scores, count, scoreThreshold);
+
+    areas.resize(count);
+    for (int i : order) {
+        areas[i] = boxes[i].width * boxes[i].height;
+    }
+
+    if (options.useGrid) {
+        runGrid(boxes, classIds, iouThreshold, keep);
+        return;
+    }
+
+    const size_t limit = options.maxDetections > 0 ? options.maxDetections : order.size();
+    for (int candidate : order) {
+        if (!overlapsKept(boxes, classIds, candidate, keep, iouThreshold)) {
+            keep.push_back(candidate);
+            if (keep.size() >= limit) {
+                break;
+            }
+        }
+    }
+}
+
+void NonMaxSuppressor::sortCandidates(const float* scores, int count, float scoreThreshold) {
+    order.clear();
+    for (int i = 0; i < count; ++i) {
+        if (scores[i] > scoreThreshold) {
+            order.push_back(i);
+        }
+    }
+
+    // Ties keep input order so results are deterministic
+    auto byScore = [scores](int a, int b) {
+        return scores[a] > scores[b] || (scores[a] == scores[b] && a < b);
+    };
+    if (options.topK > 0 && options.topK < static_cast<int>(order.size())) {
+        std::partial_sort(order.begin(), order.begin() + options.topK, order.end(), byScore);
+        order.resize(options.topK);
+    } else {
+        std::sort(order.begin(), order.end(), byScore);
+    }
+}
+
+bool NonMaxSuppressor::suppresses(const cv::Rect* boxes, const int* classIds, int kept,
+                                  int candidate, float iouThreshold) const {
+    if (options.mode == Mode::PerClass && classIds[kept] != classIds[candidate]) {
+        return false;
+    }
+
+    const cv::Rect& a = boxes[kept];
+    const cv::Rect& b = boxes[candidate];
+    int x1 = std::max(a.x, b.x);
+    int y1 = std::max(a.y, b.y);
+    int x2 = std::min(a.x + a.width, b.x + b.width);
+    int y2 = std::min(a.y + a.height, b.y + b.height);
+    if (x2 <= x1 || y2 <= y1) {
+        return false;
+    }
+
+    // IoU > t  <=>  inter > t * union, without the division
+    float intersection = static_cast<float>(x2 - x1) * (y2 - y1);
+    float unionArea = static_cast<float>(areas[kept]) + areas[candidate] - intersection;
+    return intersection > iouThreshold * unionArea;
+}
+
+bool NonMaxSuppressor::overlapsKept(const cv::Rect* boxes, const int* classIds, int candidate,
+                                    const std::vector<int>& keep, float iouThreshold) const {
+    for (int kept : keep) {
+        if (suppresses(boxes, classIds, kept, candidate, iouThreshold)) {
+            return true;
+        }
+    }
+    return false;
+}
+
+void NonMaxSuppressor::runGrid(const cv::Rect* boxes, const int* classIds, float iouThreshold,
+                               std::vector<int>& keep) {
+    if (order.empty()) {
+        return;
+    }
+
+    // Grid over the candidates' extent, cell ~ mean box size
+    int minX = boxes[order[0]].x;
+    int minY = boxes[order[0]].y;
+    int maxX = minX;
+    int maxY = minY;
+    long long sizeSum = 0;
+    for (int i : order) {
+        const cv::Rect& box = boxes[i];
+        minX = std::min(minX, box.x);
+        minY = std::min(minY, box.y);
+        maxX = std::max(maxX, box.x + box.width);
+        maxY = std::max(maxY, box.y + box.height);
+        sizeSum += std::max(box.width, box.height);
+    }
+
+    int cellSize = std::max(MIN_CELL_SIZE, static_cast<int>(sizeSum / static_cast<long long>(order.size())));
+    int gridCols = (maxX - minX) / cellSize + 1;
+    int gridRows = (maxY - minY) / cellSize + 1;
+    while (static_cast<long long>(gridCols) * gridRows > MAX_GRID_CELLS) {
+        cellSize *= 2;
+        gridCols = (maxX - minX) / cellSize + 1;
+        gridRows = (maxY - minY) / cellSize + 1;
+    }
+
+    cellHead.assign(gridCols * gridRows, -1);
+    entryNext.clear();
+    entryBox.clear();
+    visitStamp.assign(areas.size(), -1);
+
+    const size_t limit = options.maxDetections > 0 ? options.maxDetections : order.size();
+    for (int candidate : order) {
+        const cv::Rect& box = boxes[candidate];
+        // Empty boxes overlap nothing and are always kept
+        int cx0 = std::max(0, (box.x - minX) / cellSize);
+        int cy0 = std::max(0, (box.y - minY) / cellSize);
+        int cx1 = std::min(gridCols - 1, (box.x + std::max(box.width, 1) - 1 - minX) / cellSize);
+        int cy1 = std::min(gridRows - 1, (box.y + std::max(box.height, 1) - 1 - minY) / cellSize);
+
+        bool suppressed = false;
+        for (int cy = cy0; cy <= cy1 && !suppressed; ++cy) {
+            for (int cx = cx0; cx <= cx1 && !suppressed; ++cx) {
+                for (int e = cellHead[cy * gridCols + cx]; e >= 0; e = entryNext[e]) {
+                    int kept = entryBox[e];
+                    if (visitStamp[kept] == candidate) {
+                        continue;
+                    }
+                    visitStamp[kept] = candidate;
+                    if (suppresses(boxes, classIds, kept, candidate, iouThreshold)) {
+                        suppressed = true;
+                        break;
+                    }
+                }
+            }
+        }
+        if (suppressed) {
+            continue;
+        }
+
+        keep.push_back(candidate);
+        if (keep.size() >= limit) {
+            break;
+        }
+        for (int cy = cy0; cy <= cy1; ++cy) {
+            for (int cx = cx0; cx <= cx1; ++cx) {
+                int cell = cy * gridCols + cx;
+                entryNext.push_back(cellHead[cell]);
+                entryBox.push_back(candidate);
+                cellHead[cell] = static_cast<int>(entryBox.size()) - 1;
+            }
+        }
+    }
+}
@@ -0,0 +1,119 @@
+#include "OnnxRuntimeBackend.h"
+#include <algorithm>
+#include <cstring>
+#include <iostream>
+
+namespace {
+
+// One runtime environment per process, shared by all sessions
+Ort::Env& environment() {
+    static Ort::Env env(ORT_LOGGING_LEVEL_WARNING, "mot_tracker");
+    return env;
+}
+
+int dimension(const std::vector<int64_t>& shape, size_t index) {
+    return index < shape.size() && shape[index] > 0 ? static_cast<int>(shape[index]) : 0;
+}
+
+} // namespace
+
+OnnxRuntimeBackend::OnnxRuntimeBackend(const std::string& modelPath, const Options& options)
+    : memoryInfo(Ort::MemoryInfo::CreateCpu(OrtArenaAllocator, OrtMemTypeDefault)) {
+    try {
+        Ort::SessionOptions sessionOptions;
+        sessionOptions.SetGraphOptimizationLevel(GraphOptimizationLevel::ORT_ENABLE_ALL);
+        if (options.intraOpThreads > 0) {
+            sessionOptions.SetIntraOpNumThreads(options.intraOpThreads);
+        }
+        if (options.interOpThreads > 0) {
+            sessionOptions.SetInterOpNumThreads(options.interOpThreads);
+        }
+        // Independent branches only run concurrently in parallel mode
+        sessionOptions.SetExecutionMode(options.interOpThreads > 1 ? ExecutionMode::ORT_PARALLEL
+                                                                   : ExecutionMode::ORT_SEQUENTIAL);
+        session.reset(new Ort::Session(environment(), modelPath.c_str(), sessionOptions));
+
+        Ort::AllocatorWithDefaultOptions allocator;
+        inputName = session->GetInputNameAllocated(0, allocator).get();
+        for (size_t i = 0; i < session->GetOutputCount(); ++i) {
+            outputNames.push_back(session->GetOutputNameAllocated(i, allocator).get());
+        }
+
+        std::vector<int64_t> shape =
+            session->GetInputTypeInfo(0).GetTensorTypeAndShapeInfo().GetShape();
+        inputShape.batch = dimension(shape, 0);
+        inputShape.height = dimension(shape, 2);
+        inputShape.width = dimension(shape, 3);
+    }
+    catch (const Ort::Exception& e) {
+        std::cerr << "Error loading model with ONNX Runtime: " << e.what() << std::endl;
+        session.reset();
+    }
+}
+
+void OnnxRuntimeBackend::forward(const cv::Mat& blob, std::vector<cv::Mat>& outputs) {
+    const int batch = blob.size[0];
+    const size_t imageSize = blob.total() / batch;
+    float* data = const_cast<float*>(blob.ptr<float>());
+    int runBatch = batch;
+    if (inputShape.batch > batch) {
+        padded.assign(imageSize * inputShape.batch, 0.0f);
+        std::memcpy(padded.data(), data, imageSize * batch * sizeof(float));
+        data = padded.data();
+        runBatch = inputShape.batch;
+    }
+
+    // The tensor wraps the blob; nothing is copied unless padded
+    int64_t shape[] = {runBatch, blob.size[1], blob.size[2], blob.size[3]};
+    Ort::Value input = Ort::Value::CreateTensor<float>(memoryInfo, data, imageSize * runBatch,
+                                                       shape, 4);
+
+    const char* inputNames[] = {inputName.c_str()};
+    std::vector<const char*> names;
+    for (const std::string& name : outputNames) {
+        names.push_back(name.c_str());
+    }
+    std::vector<Ort::Value> values = session->Run(Ort::RunOptions{nullptr}, inputNames, &input, 1,
+                                                  names.data(), names.size());
+
+    if (values.size() == 2 &&
+        values[0].GetTensorTypeAndShapeInfo().GetShape().back() == 4 &&
+        values[1].GetTensorTypeAndShapeInfo().GetShape().back() != 4) {
+        outputs.resize(1);
+        toRegion(values[0], values[1], runBatch, batch, outputs[0]);
+        return;
+    }
+    outputs.resize(values.size());
+    for (size_t i = 0; i < values.size(); ++i) {
+        toRegion(values[i], runBatch, batch, outputs[i]);
+    }
+}
+
+void OnnxRuntimeBackend::toRegion(const Ort::Value& value, int images, int keep, cv::Mat& output) {
+    Ort::TensorTypeAndShapeInfo info = value.GetTensorTypeAndShapeInfo();
+    const int cols = static_cast<int>(info.GetShape().back());
+    const int rowsPerImage = static_cast<int>(info.GetElementCount() / cols / images);
+    output.create(keep * rowsPerImage, cols, CV_32F);
+    std::memcpy(output.ptr<float>(), value.GetTensorData<float>(),
+                output.total() * sizeof(float));
+}
+
+void OnnxRuntimeBackend::toRegion(const Ort::Value& boxes, const Ort::Value& confs, int images,
+                                  int keep, cv::Mat& output) {
+    Ort::TensorTypeAndShapeInfo info = confs.GetTensorTypeAndShapeInfo();
+    const int numClasses = static_cast<int>(info.GetShape().back());
+    const int rows = keep * static_cast<int>(info.GetElementCount() / numClasses / images);
+    output.create(rows, 5 + numClasses, CV_32F);
+
+    const float* box = boxes.GetTensorData<float>();
+    const float* scores = confs.GetTensorData<float>();
+    for (int j = 0; j < rows; ++j, box += 4, scores += numClasses) {
+        float* row = output.ptr<float>(j);
+        row[0] = 0.5f * (box[0] + box[2]);
+        row[1] = 0.5f * (box[1] + box[3]);
+        row[2] = box[2] - box[0];
+        row[3] = box[3] - box[1];
+        row[4] = *std::max_element(scores, scores + numClasses);
+        std::copy(scores, scores + numClasses, row + 5);
+    }
+}
@@ -0,0 +1,59 @@
+#include "OpticalFlowRefiner.h"
+#include <algorithm>
+
+OpticalFlowRefiner::OpticalFlowRefiner(int gridSize, float maxError)
+    : gridSize(std::max(2, gridSize)), maxError(maxError) {
+}
+
+void OpticalFlowRefiner::setFrame(const cv::Mat& frame) {
+    cv::swap(previousGray, currentGray);
+    cv::cvtColor(frame, currentGray, cv::COLOR_BGR2GRAY);
+}
+
+static float median(std::vector<float>& values) {
+    size_t mid = values.size() / 2;
+    std::nth_element(values.begin(), values.begin() + mid, values.end());
+    return values[mid];
+}
+
+bool OpticalFlowRefiner::refine(const cv::Rect& previous, cv::Rect& refined) {
+    if (!isReady() || previousGray.size() != currentGray.size()) {
+        return false;
+    }
+
+    cv::Rect box = previous & cv::Rect(0, 0, previousGray.cols, previousGray.rows);
+    if (box.width < gridSize || box.height < gridSize) {
+        return false;
+    }
+
+    // Sample an interior grid (skip the border, which is mostly background)
+    previousPoints.clear();
+    for (int gy = 1; gy <= gridSize; ++gy) {
+        for (int gx = 1; gx <= gridSize; ++gx) {
+            previousPoints.emplace_back(box.x + box.width * gx / (gridSize + 1.0f),
+                                        box.y + box.height * gy / (gridSize + 1.0f));
+        }
+    }
+
+    cv::calcOpticalFlowPyrLK(previousGray, currentGray, previousPoints, currentPoints,
+                             status, errors, cv::Size(15, 15), 2);
+
+    dxs.clear();
+    dys.clear();
+    for (size_t i = 0; i < previousPoints.size(); ++i) {
+        if (status[i] && errors[i] < maxError) {
+            dxs.push_back(currentPoints[i].x - previousPoints[i].x);
+            dys.push_back(currentPoints[i].y - previousPoints[i].y);
+        }
+    }
+
+    // Require at least half of the points to agree on a motion
+    if (dxs.size() * 2 < previousPoints.size()) {
+        return false;
+    }
+
+    refined = previous;
+    refined.x += cvRound(median(dxs));
+    refined.y += cvRound(median(dys));
+    return true;
+}
@@ -0,0 +1,201 @@
+#include "OutputSink.h"
+#include "Visualization.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <iostream>
+
+// Frames queued per sink before it starts to drop (video) or push back (logs)
+static const size_t LOG_QUEUE_CAPACITY = 64;
+static const size_t VIDEO_QUEUE_CAPACITY = 8;
+
+// Stream buffer for the text and binary logs
+static const size_t FILE_BUFFER_SIZE = 1 << 16;
+
+AsyncSink::AsyncSink(size_t queueCapacity, bool dropWhenFull, bool keepFrame)
+    : queue(queueCapacity), dropWhenFull(dropWhenFull), keepFrame(keepFrame) {}
+
+AsyncSink::~AsyncSink() {
+    // Derived destructors normally got here first; this only catches a
+    // sink whose start() was never followed by close()
+    close();
+}
+
+void AsyncSink::start() {
+    worker = std::thread([this]() {
+        FrameResult result;
+        while (queue.pop(result)) {
+            consume(result);
+        }
+        finish();
+    });
+}
+
+void AsyncSink::write(const FrameResult& result) {
+    FrameResult item;
+    item.index = result.index;
+    item.tracks = result.tracks;
+    item.fps = result.fps;
+    if (keepFrame) {
+        item.frame = result.frame;
+    }
+
+    if (dropWhenFull) {
+        if (!queue.tryPush(std::move(item))) {
+            dropped++;
+            Metrics::global().add(Metrics::Counter::DroppedFrames);
+        }
+    } else {
+        queue.push(std::move(item));
+    }
+}
+
+void AsyncSink::close() {
+    queue.close();
+    if (worker.joinable()) {
+        worker.join();
+    }
+}
+
+MotTextSink::MotTextSink(const std::string& path)
+    : AsyncSink(LOG_QUEUE_CAPACITY, false, false), buffer(FILE_BUFFER_SIZE) {
+    // The buffer must be installed before the file is opened
+    file.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+    file.open(path);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open MOT output file: " << path << std::endl;
+    }
+    start();
+}
+
+MotTextSink::~MotTextSink() {
+    close();
+}
+
+void MotTextSink::consume(const FrameResult& result) {
+    if (!file.is_open()) {
+        return;
+    }
+    ScopedTimer timer(Metrics::Stage::Write);
+    for (const auto& track : result.tracks) {
+        const cv::Rect& box = track.bbox;
+        file << result.index + 1 << ',' << track.id << ','
+             << box.x << ',' << box.y << ',' << box.width << ',' << box.height
+             << ",1,-1,-1,-1\n";
+    }
+}
+
+void MotTextSink::finish() {
+    file.close();
+}
+
+BinaryTrackSink::BinaryTrackSink(const std::string& path)
+    : AsyncSink(LOG_QUEUE_CAPACITY, false, false), buffer(FILE_BUFFER_SIZE) {
+    file.rdbuf()->pubsetbuf(buffer.data(), buffer.size());
+    file.open(path, std::ios::binary);
+    if (!file.is_open()) {
+        std::cerr << "Error: Could not open track log: " << path << std::endl;
+    } else {
+        int32_t version = VERSION;
+        file.write("MOTL", 4);
+        file.write(reinterpret_cast<const char*>(&version), sizeof(version));
+    }
+    start();
+}
+
+BinaryTrackSink::~BinaryTrackSink() {
+    close();
+}
+
+void BinaryTrackSink::consume(const FrameResult& result) {
+    if (!file.is_open()) {
+        return;
+    }
+    ScopedTimer timer(Metrics::Stage::Write);
+    record.clear();
+    record.push_back(result.index);
+    record.push_back(static_cast<int32_t>(result.tracks.size()));
+    for (const auto& track : result.tracks) {
+        record.push_back(track.id);
+        record.push_back(track.classId);
+        record.push_back(track.bbox.x);
+        record.push_back(track.bbox.y);
+        record.push_back(track.bbox.width);
+        record.push_back(track.bbox.height);
+    }
+    file.write(reinterpret_cast<const char*>(record.data()),
+               static_cast<std::streamsize>(record.size() * sizeof(int32_t)));
+}
+
+void BinaryTrackSink::finish() {
+    file.close();
+}
+
+VideoSink::VideoSink(const std::string& path, double fps, double scale, int everyNth)
+    : AsyncSink(VIDEO_QUEUE_CAPACITY, true, true),
+      path(path),
+      fps(fps > 0.0 ? fps : 25.0),
+      scale(scale > 0.0 ? std::min(scale, 1.0) : 1.0),
+      everyNth(std::max(1, everyNth)),
+      colors(generateColors(100)) {
+    start();
+}
+
+VideoSink::~VideoSink() {
+    close();
+}
+
+void VideoSink::write(const FrameResult& result) {
+    // Skipped frames never reach the queue
+    if (result.index % everyNth == 0) {
+        AsyncSink::write(result);
+    }
+}
+
+void VideoSink::consume(const FrameResult& result) {
+    if (result.frame.empty()) {
+        return;
+    }
+
+    // Draw on a private canvas; the frame is shared with other sinks
+    ScopedTimer renderTimer(Metrics::Stage::Render);
+    if (scale < 1.0) {
+        cv::resize(result.frame, canvas, cv::Size(), scale, scale, cv::INTER_AREA);
+    } else {
+        result.frame.copyTo(canvas);
+    }
+
+    if (!writer.isOpened()) {
+        if (openFailed) {
+            return;
+        }
+        writer.open(path, cv::VideoWriter::fourcc('M','J','P','G'), fps / everyNth, canvas.size());
+        if (!writer.isOpened()) {
+            std::cerr << "Error: Could not open video output: " << path << std::endl;
+            openFailed = true;
+            return;
+        }
+    }
+
+    for (const auto& track : result.tracks) {
+        if (scale < 1.0) {
+            cv::Rect box(cvRound(track.bbox.x * scale), cvRound(track.bbox.y * scale),
+                         cvRound(track.bbox.width * scale), cvRound(track.bbox.height * scale));
+            scaledTrajectory.clear();
+            for (const cv::Point& point : track.trajectory) {
+                scaledTrajectory.emplace_back(cvRound(point.x * scale), cvRound(point.y * scale));
+            }
+            drawTrack(canvas, track.id, box, track.className, scaledTrajectory, colors);
+        } else {
+            drawTrack(canvas, track.id, track.bbox, track.className, track.trajectory, colors);
+        }
+    }
+    displayStats(canvas, result.index + 1, result.fps, static_cast<int>(result.tracks.size()));
+    renderTimer.stop();
+
+    ScopedTimer encodeTimer(Metrics::Stage::Encode);
+    writer.write(canvas);
+}
+
+void VideoSink::finish() {
+    writer.release();
+}
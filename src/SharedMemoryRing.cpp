@@ -0,0 +1,246 @@
+#include "SharedMemoryRing.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <chrono>
+#include <cstring>
+#include <iostream>
+#include <new>
+#include <thread>
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+              std::atomic<uint32_t>::is_always_lock_free,
+              "ring counters must be lock-free to be shared between processes");
+
+static const char MAGIC[4] = {'M', 'O', 'T', 'R'};
+
+// Sleep between checks while waiting for the other side
+static const std::chrono::microseconds POLL_INTERVAL(200);
+
+// Slots start on cache-line boundaries
+static const size_t SLOT_ALIGNMENT = 64;
+
+static size_t alignUp(size_t value, size_t alignment) {
+    return (value + alignment - 1) / alignment * alignment;
+}
+
+static std::string objectName(const std::string& name) {
+    return name.empty() || name[0] != '/' ? "/" + name : name;
+}
+
+SharedMemoryFrameSource::SharedMemoryFrameSource(const std::string& name, int holdFrames)
+    : holdFrames(static_cast<uint64_t>(std::max(0, holdFrames))) {
+    int fd = shm_open(objectName(name).c_str(), O_RDWR, 0);
+    if (fd < 0) {
+        std::cerr << "Error: Could not open shared-memory ring: " << name << std::endl;
+        return;
+    }
+    struct stat info;
+    if (fstat(fd, &info) != 0 || info.st_size < static_cast<off_t>(sizeof(SharedMemoryRingHeader))) {
+        ::close(fd);
+        std::cerr << "Error: Shared-memory ring is not initialized: " << name << std::endl;
+        return;
+    }
+    mappingSize = static_cast<size_t>(info.st_size);
+    void* mapped = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        std::cerr << "Error: Could not map shared-memory ring: " << name << std::endl;
+        return;
+    }
+    mapping = static_cast<unsigned char*>(mapped);
+
+    auto* ring = reinterpret_cast<SharedMemoryRingHeader*>(mapping);
+    bool valid = std::memcmp(ring->magic, MAGIC, sizeof(MAGIC)) == 0 &&
+                 ring->version == SharedMemoryRingHeader::VERSION &&
+                 ring->type == CV_8UC3 && ring->slotCount > 0 &&
+                 ring->dataOffset + ring->slotCount * ring->slotBytes <= mappingSize;
+    if (!valid) {
+        std::cerr << "Error: Not a frame ring: " << name << std::endl;
+    } else if ((ring->flags & SharedMemoryRingHeader::BLOCKING) && this->holdFrames >= ring->slotCount) {
+        std::cerr << "Error: Shared-memory ring has " << ring->slotCount << " slots but "
+                  << this->holdFrames << " frames may be held; the producer needs a larger ring"
+                  << std::endl;
+    } else if (ring->consumers.fetch_add(1) != 0) {
+        ring->consumers.fetch_sub(1);
+        std::cerr << "Error: Shared-memory ring already has a consumer: " << name << std::endl;
+    } else {
+        header = ring;
+        // Start with the next frame; a blocking producer waits for us first
+        next = header->written.load(std::memory_order_acquire);
+        header->released.store(next, std::memory_order_release);
+        return;
+    }
+    munmap(mapping, mappingSize);
+    mapping = nullptr;
+}
+
+SharedMemoryFrameSource::~SharedMemoryFrameSource() {
+    if (header != nullptr) {
+        // Release everything so a blocking producer can carry on
+        header->released.store(header->written.load(std::memory_order_acquire),
+                               std::memory_order_release);
+        header->consumers.fetch_sub(1);
+    }
+    if (mapping != nullptr) {
+        munmap(mapping, mappingSize);
+    }
+}
+
+cv::Mat SharedMemoryFrameSource::slotView(uint64_t frameNumber) const {
+    unsigned char* slot = mapping + header->dataOffset + (frameNumber % header->slotCount) * header->slotBytes;
+    return cv::Mat(static_cast<int>(header->height), static_cast<int>(header->width), CV_8UC3,
+                   slot, header->step);
+}
+
+cv::Size SharedMemoryFrameSource::getFrameSize() const {
+    return header ? cv::Size(static_cast<int>(header->width), static_cast<int>(header->height))
+                  : cv::Size();
+}
+
+bool SharedMemoryFrameSource::read(cv::Mat& frame) {
+    if (header == nullptr) {
+        return false;
+    }
+
+    uint64_t written;
+    while ((written = header->written.load(std::memory_order_acquire)) <= next) {
+        // Check closed only after written, so frames published before the
+        // close are still read
+        if (interrupted || header->closed.load(std::memory_order_acquire)) {
+            if (header->written.load(std::memory_order_acquire) <= next) {
+                return false;
+            }
+            continue;
+        }
+        std::this_thread::sleep_for(POLL_INTERVAL);
+    }
+
+    if (header->flags & SharedMemoryRingHeader::BLOCKING) {
+        frame = slotView(next);
+        next++;
+        header->released.store(next > holdFrames ? next - holdFrames : 0, std::memory_order_release);
+        return true;
+    }
+
+    // Non-blocking producer: the slot can be overwritten at any time, so the
+    // frame is copied out and kept only if the producer has not started on
+    // the slot's next frame (next + slotCount) meanwhile
+    for (;;) {
+        if (header->started.load(std::memory_order_acquire) - next > header->slotCount) {
+            // A whole ring behind: skip to the newest frame
+            uint64_t newest = header->written.load(std::memory_order_acquire) - 1;
+            int64_t skipped = static_cast<int64_t>(newest - next);
+            dropped += skipped;
+            Metrics::global().add(Metrics::Counter::DroppedFrames, static_cast<uint64_t>(skipped));
+            next = newest;
+        }
+        cv::Mat copy;
+        slotView(next).copyTo(copy);
+        std::atomic_thread_fence(std::memory_order_acquire);
+        if (header->started.load(std::memory_order_relaxed) - next <= header->slotCount) {
+            frame = copy;
+            next++;
+            return true;
+        }
+    }
+}
+
+SharedMemoryFrameWriter::SharedMemoryFrameWriter(const std::string& name, const cv::Size& frameSize,
+                                                 double fps, int slotCount, bool blocking)
+    : name(objectName(name)) {
+    uint32_t step = static_cast<uint32_t>(frameSize.width) * 3;
+    uint64_t slotBytes = alignUp(static_cast<size_t>(step) * frameSize.height, SLOT_ALIGNMENT);
+    uint64_t dataOffset = alignUp(sizeof(SharedMemoryRingHeader), SLOT_ALIGNMENT);
+    if (frameSize.area() <= 0 || slotCount <= 0) {
+        std::cerr << "Error: Invalid frame ring size" << std::endl;
+        return;
+    }
+    mappingSize = static_cast<size_t>(dataOffset + slotBytes * slotCount);
+
+    // Replace any ring left behind by a crashed producer
+    shm_unlink(this->name.c_str());
+    int fd = shm_open(this->name.c_str(), O_RDWR | O_CREAT | O_EXCL, 0600);
+    if (fd < 0 || ftruncate(fd, static_cast<off_t>(mappingSize)) != 0) {
+        if (fd >= 0) {
+            ::close(fd);
+            shm_unlink(this->name.c_str());
+        }
+        std::cerr << "Error: Could not create shared-memory ring: " << name << std::endl;
+        return;
+    }
+    void* mapped = mmap(nullptr, mappingSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+    ::close(fd);
+    if (mapped == MAP_FAILED) {
+        shm_unlink(this->name.c_str());
+        std::cerr << "Error: Could not map shared-memory ring: " << name << std::endl;
+        return;
+    }
+    mapping = static_cast<unsigned char*>(mapped);
+
+    header = new (mapping) SharedMemoryRingHeader();
+    header->version = SharedMemoryRingHeader::VERSION;
+    header->width = static_cast<uint32_t>(frameSize.width);
+    header->height = static_cast<uint32_t>(frameSize.height);
+    header->type = CV_8UC3;
+    header->step = step;
+    header->slotCount = static_cast<uint32_t>(slotCount);
+    header->flags = blocking ? SharedMemoryRingHeader::BLOCKING : 0;
+    header->slotBytes = slotBytes;
+    header->dataOffset = dataOffset;
+    header->fps = fps;
+    header->started.store(0);
+    header->written.store(0);
+    header->released.store(0);
+    header->consumers.store(0);
+    header->closed.store(0);
+    // Magic last: a consumer never sees a half-initialized header as valid
+    std::atomic_thread_fence(std::memory_order_release);
+    std::memcpy(header->magic, MAGIC, sizeof(MAGIC));
+}
+
+SharedMemoryFrameWriter::~SharedMemoryFrameWriter() {
+    if (header != nullptr) {
+        close();
+        munmap(mapping, mappingSize);
+        shm_unlink(name.c_str());
+    }
+}
+
+bool SharedMemoryFrameWriter::write(const cv::Mat& frame) {
+    if (header == nullptr || header->closed.load() ||
+        frame.type() != CV_8UC3 || frame.cols != static_cast<int>(header->width) ||
+        frame.rows != static_cast<int>(header->height)) {
+        return false;
+    }
+
+    uint64_t written = header->written.load(std::memory_order_relaxed);
+    if (header->flags & SharedMemoryRingHeader::BLOCKING) {
+        // Wait for a consumer, then for the slot's previous frame to be released
+        while (header->consumers.load(std::memory_order_acquire) == 0 ||
+               written - header->released.load(std::memory_order_acquire) >= header->slotCount) {
+            std::this_thread::sleep_for(POLL_INTERVAL);
+        }
+    }
+
+    // Announce the frame before touching its slot, so a non-blocking consumer
+    // copying the slot's previous frame can tell its copy may be torn
+    header->started.store(written + 1, std::memory_order_relaxed);
+    std::atomic_thread_fence(std::memory_order_release);
+
+    unsigned char* slot = mapping + header->dataOffset + (written % header->slotCount) * header->slotBytes;
+    cv::Mat view(static_cast<int>(header->height), static_cast<int>(header->width), CV_8UC3, slot,
+                 header->step);
+    frame.copyTo(view);
+    header->written.store(written + 1, std::memory_order_release);
+    return true;
+}
+
+void SharedMemoryFrameWriter::close() {
+    if (header != nullptr) {
+        header->closed.store(1, std::memory_order_release);
+    }
+}
@@ -0,0 +1,308 @@
+#include "SparseAssociator.h"
+#include "Metrics.h"
+#include "ScratchVector.h"
+#include <algorithm>
+#include <numeric>
+
+// Upper bound on grid cells; the cell size grows for very spread-out scenes
+static const long long MAX_GRID_CELLS = 1 << 16;
+
+// Smallest cell edge in pixels
+static const int MIN_CELL_SIZE = 8;
+
+float SparseAssociator::calculateIoU(const cv::Rect& box1, const cv::Rect& box2) {
+    int x1 = std::max(box1.x, box2.x);
+    int y1 = std::max(box1.y, box2.y);
+    int x2 = std::min(box1.x + box1.width, box2.x + box2.width);
+    int y2 = std::min(box1.y + box1.height, box2.y + box2.height);
+
+    int intersectionArea = std::max(0, x2 - x1) * std::max(0, y2 - y1);
+    int box1Area = box1.width * box1.height;
+    int box2Area = box2.width * box2.height;
+    int unionArea = box1Area + box2Area - intersectionArea;
+
+    return unionArea > 0 ? static_cast<float>(intersectionArea) / unionArea : 0.0f;
+}
+
+void SparseAssociator::findCandidates(const cv::Rect* trackBoxes, const int* trackClassIds,
+                                      int numTracks, const std::vector<Detection>& detections,
+                                      float maxCost, std::vector<Candidate>& candidates) {
+    candidates.clear();
+    const int numDetections = static_cast<int>(detections.size());
+    if (numTracks == 0 || numDetections == 0) {
+        return;
+    }
+
+    // Grid over the detections' extent, cell ~ mean box size
+    int minX = detections[0].bbox.x;
+    int minY = detections[0].bbox.y;
+    int maxX = minX;
+    int maxY = minY;
+    long long sizeSum = 0;
+    for (const Detection& det : detections) {
+        minX = std::min(minX, det.bbox.x);
+        minY = std::min(minY, det.bbox.y);
+        maxX = std::max(maxX, det.bbox.x + det.bbox.width);
+        maxY = std::max(maxY, det.bbox.y + det.bbox.height);
+        sizeSum += std::max(det.bbox.width, det.bbox.height);
+    }
+
+    int cellSize = std::max(MIN_CELL_SIZE, static_cast<int>(sizeSum / numDetections));
+    int gridCols = (maxX - minX) / cellSize + 1;
+    int gridRows = (maxY - minY) / cellSize + 1;
+    while (static_cast<long long>(gridCols) * gridRows > MAX_GRID_CELLS) {
+        cellSize *= 2;
+        gridCols = (maxX - minX) / cellSize + 1;
+        gridRows = (maxY - minY) / cellSize + 1;
+    }
+    const int numCells = gridCols * gridRows;
+
+    // Cell range covered by a box; false if it misses the grid entirely
+    auto cellRange = [&](const cv::Rect& box, int& cx0, int& cy0, int& cx1, int& cy1) {
+        if (box.width <= 0 || box.height <= 0 ||
+            box.x + box.width <= minX || box.y + box.height <= minY ||
+            box.x >= maxX || box.y >= maxY) {
+            return false;
+        }
+        cx0 = std::max(0, (box.x - minX) / cellSize);
+        cy0 = std::max(0, (box.y - minY) / cellSize);
+        cx1 = std::min(gridCols - 1, (box.x + box.width - 1 - minX) / cellSize);
+        cy1 = std::min(gridRows - 1, (box.y + box.height - 1 - minY) / cellSize);
+        return true;
+    };
+
+    // Bucket detections into every cell they cover (counting sort into CSR)
+    assignScratch(cellStart, numCells + 1, 0);
+    int cx0, cy0, cx1, cy1;
+    for (int j = 0; j < numDetections; ++j) {
+        if (cellRange(detections[j].bbox, cx0, cy0, cx1, cy1)) {
+            for (int cy = cy0; cy <= cy1; ++cy) {
+                for (int cx = cx0; cx <= cx1; ++cx) {
+                    cellStart[cy * gridCols + cx + 1]++;
+                }
+            }
+        }
+    }
+    std::partial_sum(cellStart.begin(), cellStart.end(), cellStart.begin());
+    cellItems.resize(cellStart[numCells]);
+    for (int j = numDetections - 1; j >= 0; --j) {
+        if (cellRange(detections[j].bbox, cx0, cy0, cx1, cy1)) {
+            for (int cy = cy0; cy <= cy1; ++cy) {
+                for (int cx = cx0; cx <= cx1; ++cx) {
+                    // Fill from the end of each bucket; ends up at the start
+                    cellItems[--cellStart[cy * gridCols + cx + 1]] = j;
+                }
+            }
+        }
+    }
+    // Each cellStart[c + 1] now points at the start of bucket c; shift back
+    for (int c = 0; c < numCells; ++c) {
+        cellStart[c] = cellStart[c + 1];
+    }
+    cellStart[numCells] = static_cast<int>(cellItems.size());
+
+    // Probe the cells under each predicted track box
+    assignScratch(visitStamp, numDetections, -1);
+    for (int i = 0; i < numTracks; ++i) {
+        const cv::Rect& box = trackBoxes[i];
+        if (!cellRange(box, cx0, cy0, cx1, cy1)) {
+            continue;
+        }
+        for (int cy = cy0; cy <= cy1; ++cy) {
+            for (int cx = cx0; cx <= cx1; ++cx) {
+                int cell = cy * gridCols + cx;
+                for (int k = cellStart[cell]; k < cellStart[cell + 1]; ++k) {
+                    int j = cellItems[k];
+                    if (visitStamp[j] == i) {
+                        continue;
+                    }
+                    visitStamp[j] = i;
+
+                    if (trackClassIds[i] != detections[j].classId) {
+                        continue;
+                    }
+                    float cost = 1.0f - calculateIoU(box, detections[j].bbox);
+                    if (cost < maxCost) {
+                        candidates.push_back({i, j, cost});
+                    }
+                }
+            }
+        }
+    }
+}
+
+int SparseAssociator::find(int node) {
+    while (parent[node] != node) {
+        parent[node] = parent[parent[node]];   // path halving
+        node = parent[node];
+    }
+    return node;
+}
+
+void SparseAssociator::unite(int a, int b) {
+    a = find(a);
+    b = find(b);
+    if (a != b) {
+        parent[std::max(a, b)] = std::min(a, b);
+    }
+}
+
+void SparseAssociator::associate(const cv::Rect* trackBoxes, const int* trackClassIds,
+                                 int numTracks, float* duals,
+                                 const std::vector<Detection>& detections, float maxCost,
+                                 std::vector<int>& matchedTracks,
+                                 std::vector<int>& matchedDetections,
+                                 std::vector<int>& unmatchedTracks,
+                                 std::vector<int>& unmatchedDetections) {
+    matchedTracks.clear();
+    matchedDetections.clear();
+    unmatchedTracks.clear();
+    unmatchedDetections.clear();
+    lastComponentCount = 0;
+
+    const int numDetections = static_cast<int>(detections.size());
+    const int numNodes = numTracks + numDetections;
+
+    ScopedTimer costTimer(Metrics::Stage::CostMatrix);
+    findCandidates(trackBoxes, trackClassIds, numTracks, detections, maxCost, candidates);
+    costTimer.stop();
+
+    ScopedTimer assignmentTimer(Metrics::Stage::Assignment);
+
+    // Connected components of the candidate graph
+    parent.resize(numNodes);
+    std::iota(parent.begin(), parent.end(), 0);
+    for (const Candidate& c : candidates) {
+        unite(c.track, numTracks + c.detection);
+    }
+
+    assignScratch(componentOf, numNodes, -1);
+    int numComponents = 0;
+    for (const Candidate& c : candidates) {
+        int root = find(c.track);
+        if (componentOf[root] < 0) {
+            componentOf[root] = numComponents++;
+        }
+    }
+    lastComponentCount = numComponents;
+
+    // Group nodes and edges by component (counting sort)
+    assignScratch(componentStart, numComponents + 1, 0);
+    for (int node = 0; node < numNodes; ++node) {
+        int component = componentOf[find(node)];
+        componentOf[node] = component;
+        if (component >= 0) {
+            componentStart[component + 1]++;
+        }
+    }
+    std::partial_sum(componentStart.begin(), componentStart.end(), componentStart.begin());
+    componentNodes.resize(componentStart[numComponents]);
+    assignScratch(localIndex, numNodes, -1);
+    {
+        std::vector<int>& cursor = localTracks;   // reused as scratch here
+        copyScratch(cursor, componentStart.begin(), componentStart.end() - 1);
+        for (int node = 0; node < numNodes; ++node) {
+            if (componentOf[node] >= 0) {
+                componentNodes[cursor[componentOf[node]]++] = node;
+            }
+        }
+    }
+
+    assignScratch(componentEdgeStart, numComponents + 1, 0);
+    for (const Candidate& c : candidates) {
+        componentEdgeStart[componentOf[c.track] + 1]++;
+    }
+    std::partial_sum(componentEdgeStart.begin(), componentEdgeStart.end(), componentEdgeStart.begin());
+    componentEdges.resize(candidates.size());
+    {
+        std::vector<int>& cursor = localTracks;
+        copyScratch(cursor, componentEdgeStart.begin(), componentEdgeStart.end() - 1);
+        for (size_t e = 0; e < candidates.size(); ++e) {
+            componentEdges[cursor[componentOf[candidates[e].track]]++] = static_cast<int>(e);
+        }
+    }
+
+    assignScratch(detectionMatched, numDetections, 0);
+
+    // Tracks without any admissible detection cannot match
+    for (int i = 0; i < numTracks; ++i) {
+        if (componentOf[i] < 0) {
+            unmatchedTracks.push_back(i);
+        }
+    }
+
+    // Solve each component on its own
+    for (int k = 0; k < numComponents; ++k) {
+        localTracks.clear();
+        localDetections.clear();
+        for (int n = componentStart[k]; n < componentStart[k + 1]; ++n) {
+            int node = componentNodes[n];
+            if (node < numTracks) {
+                localIndex[node] = static_cast<int>(localTracks.size());
+                localTracks.push_back(node);
+            } else {
+                localIndex[node] = static_cast<int>(localDetections.size());
+                localDetections.push_back(node - numTracks);
+            }
+        }
+
+        const int rows = static_cast<int>(localTracks.size());
+        const int cols = static_cast<int>(localDetections.size());
+
+        // Non-candidate pairs get the maximum cost and are rejected below
+        assignScratch(localCost, rows * cols, 1.0f);
+        for (int e = componentEdgeStart[k]; e < componentEdgeStart[k + 1]; ++e) {
+            const Candidate& c = candidates[componentEdges[e]];
+            localCost[localIndex[c.track] * cols + localIndex[numTracks + c.detection]] = c.cost;
+        }
+
+        // Warm start: rows are the same tracks as last frame, so their duals
+        // carry over. Detection indices do not (NMS order, changing counts),
+        // so each row is hinted with its cheapest candidate in this frame.
+        localDuals.resize(rows);
+        localAssignment.resize(rows);
+        for (int r = 0; r < rows; ++r) {
+            localDuals[r] = duals ? duals[localTracks[r]] : 0.0f;
+            localAssignment[r] = -1;
+        }
+        for (int e = componentEdgeStart[k]; e < componentEdgeStart[k + 1]; ++e) {
+            const Candidate& c = candidates[componentEdges[e]];
+            int r = localIndex[c.track];
+            int col = localIndex[numTracks + c.detection];
+            if (localAssignment[r] < 0 || c.cost < localCost[r * cols + localAssignment[r]]) {
+                localAssignment[r] = col;
+            }
+        }
+
+        if (rows == 1 && cols == 1) {
+            localAssignment[0] = 0;
+        } else {
+            solver.solve(localCost.data(), rows, cols, localAssignment.data(),
+                         localDuals.data(), duals != nullptr);
+        }
+
+        for (int r = 0; r < rows; ++r) {
+            int track = localTracks[r];
+            int col = localAssignment[r];
+            if (duals) {
+                duals[track] = localDuals[r];
+            }
+
+            if (col >= 0 && localCost[r * cols + col] < maxCost) {
+                int detection = localDetections[col];
+                matchedTracks.push_back(track);
+                matchedDetections.push_back(detection);
+                detectionMatched[detection] = 1;
+            } else {
+                unmatchedTracks.push_back(track);
+            }
+        }
+    }
+
+    // Find unmatched detections
+    for (int j = 0; j < numDetections; ++j) {
+        if (!detectionMatched[j]) {
+            unmatchedDetections.push_back(j);
+        }
+    }
+}
@@ -0,0 +1,276 @@
+#include "StreamServer.h"
+#include "Metrics.h"
+#include <algorithm>
+#include <iostream>
+
+StreamServer::StreamServer(const std::string& modelPath, const std::string& configPath,
+                           const std::string& classesPath, const Options& options)
+    : options(options),
+      latency(options.latency, options.inputSize, 1),
+      activeInputSize(options.inputSize),
+      activeStride(1) {
+    this->options.detectorWorkers = std::max(1, options.detectorWorkers);
+    this->options.batchSize = std::max(1, options.batchSize);
+    this->options.queueDepth = std::max(1, options.queueDepth);
+    if (latency.isEnabled()) {
+        activeInputSize = latency.getLevel().inputSize;
+        activeStride = latency.getLevel().stride;
+    }
+
+    for (int i = 0; i < this->options.detectorWorkers; ++i) {
+        detectors.push_back(std::unique_ptr<YOLODetector>(
+            new YOLODetector(modelPath, configPath, classesPath, this->options.batchSize,
+                             this->options.backend)));
+        detectors.back()->setClassFilter(options.trackClasses);
+        detectors.back()->setNmsOptions(options.nmsOptions);
+        detectors.back()->setLetterbox(options.letterbox);
+        detectors.back()->setInputSize(activeInputSize);
+        detectors.back()->setTiling(options.tiling);
+    }
+}
+
+StreamServer::~StreamServer() {
+    stop();
+    for (auto& stream : streams) {
+        if (stream->decodeThread.joinable()) {
+            stream->decodeThread.join();
+        }
+    }
+}
+
+bool StreamServer::isLoaded() const {
+    for (const auto& detector : detectors) {
+        if (!detector->isLoaded()) {
+            return false;
+        }
+    }
+    return !detectors.empty();
+}
+
+bool StreamServer::quantize(Int8Calibrator& calibrator) {
+    bool all = true;
+    for (auto& detector : detectors) {
+        all = calibrator.apply(*detector, options.confThreshold, options.nmsThreshold) && all;
+    }
+    return all && !detectors.empty();
+}
+
+int StreamServer::addStream(const std::string& source) {
+    std::unique_ptr<Stream> stream(new Stream(source, options));
+    stream->capture = FrameSource::open(source, options.sourceOptions);
+    if (!stream->capture->isOpened()) {
+        std::cerr << "Error: Could not open stream: " << source << std::endl;
+        return -1;
+    }
+    stream->fps = stream->capture->getFps();
+
+    streams.push_back(std::move(stream));
+    return static_cast<int>(streams.size()) - 1;
+}
+
+void StreamServer::run(const ResultCallback& onResult) {
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        stopping = false;
+    }
+
+    for (size_t i = 0; i < streams.size(); ++i) {
+        streams[i]->decodeThread = std::thread(&StreamServer::decodeLoop, this, static_cast<int>(i));
+    }
+
+    std::vector<std::thread> workers;
+    for (auto& detector : detectors) {
+        workers.emplace_back(&StreamServer::workerLoop, this, std::ref(*detector),
+                             std::cref(onResult));
+    }
+
+    for (auto& worker : workers) {
+        worker.join();
+    }
+    for (auto& stream : streams) {
+        stream->decodeThread.join();
+    }
+}
+
+void StreamServer::stop() {
+    std::lock_guard<std::mutex> lock(mutex);
+    for (auto& stream : streams) {
+        stream->capture->interrupt();
+    }
+    stopping = true;
+    workAvailable.notify_all();
+    spaceAvailable.notify_all();
+}
+
+StreamServer::StreamStats StreamServer::getStats(int stream) const {
+    StreamStats stats;
+    stats.decoded = streams[stream]->decoded;
+    stats.processed = streams[stream]->processed;
+    stats.dropped = streams[stream]->dropped;
+    stats.gate = streams[stream]->gate.getStats();
+    return stats;
+}
+
+void StreamServer::decodeLoop(int index) {
+    Stream& stream = *streams[index];
+    int frameIndex = 0;
+
+    while (true) {
+        Job job;
+        job.stream = index;
+        job.index = frameIndex++;
+        job.decodeStart = std::chrono::steady_clock::now();
+        ScopedTimer decodeTimer(Metrics::Stage::Decode);
+        if (!stream.capture->read(job.frame)) {
+            break;
+        }
+        decodeTimer.stop();
+        stream.decoded++;
+
+        std::unique_lock<std::mutex> lock(mutex);
+        if (!options.dropFrames) {
+            spaceAvailable.wait(lock, [&]() {
+                return stopping || static_cast<int>(stream.inbox.size()) < options.queueDepth;
+            });
+        }
+        if (stopping) {
+            break;
+        }
+        // Saturated: drop the oldest frame rather than fall behind
+        if (static_cast<int>(stream.inbox.size()) >= options.queueDepth) {
+            stream.inbox.pop_front();
+            stream.dropped++;
+            Metrics::global().add(Metrics::Counter::DroppedFrames);
+        }
+        stream.inbox.push_back(std::move(job));
+        workAvailable.notify_one();
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    stream.finished = true;
+    workAvailable.notify_all();
+}
+
+bool StreamServer::hasWork() const {
+    for (const auto& stream : streams) {
+        if (!stream->busy && !stream->inbox.empty()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+bool StreamServer::allFinished() const {
+    for (const auto& stream : streams) {
+        if (!stream->finished || !stream->inbox.empty()) {
+            return false;
+        }
+    }
+    return true;
+}
+
+void StreamServer::takeJobs(std::vector<Job>& jobs) {
+    const size_t count = streams.size();
+    size_t last = nextStream;
+    for (size_t k = 0; k < count && static_cast<int>(jobs.size()) < options.batchSize; ++k) {
+        size_t i = (nextStream + k) % count;
+        Stream& stream = *streams[i];
+        if (stream.busy || stream.inbox.empty()) {
+            continue;
+        }
+        jobs.push_back(std::move(stream.inbox.front()));
+        stream.inbox.pop_front();
+        spaceAvailable.notify_all();
+        stream.busy = true;
+        last = i;
+    }
+    // Next batch starts after the last stream served
+    nextStream = (last + 1) % count;
+}
+
+void StreamServer::workerLoop(YOLODetector& detector, const ResultCallback& onResult) {
+    std::vector<Job> jobs;
+    std::vector<cv::Mat> frames;
+    std::vector<std::vector<Detection>> results;
+    std::vector<std::vector<Detection>> regionResults;
+
+    while (true) {
+        jobs.clear();
+        {
+            std::unique_lock<std::mutex> lock(mutex);
+            workAvailable.wait(lock, [this]() { return stopping || hasWork() || allFinished(); });
+            if (stopping || (!hasWork() && allFinished())) {
+                return;
+            }
+            takeJobs(jobs);
+        }
+
+        if (detector.getInputSize() != activeInputSize) {
+            detector.setInputSize(activeInputSize);
+        }
+
+        // Streams are busy, so their gates and trackers are ours. Skipped
+        // jobs need no detector; region jobs run alone on a smaller input.
+        frames.clear();
+        regionResults.resize(jobs.size());
+        const int stride = activeStride;
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            Job& job = jobs[i];
+            Stream& stream = *streams[job.stream];
+            job.decision = job.index % stride != 0
+                ? MotionGate::Decision::Skip
+                : stream.gate.analyze(job.frame, stream.trackBoxes, false, job.regions);
+            if (job.decision == MotionGate::Decision::Regions &&
+                !detector.detectRegions(job.frame, job.regions, options.confThreshold,
+                                        options.nmsThreshold, regionResults[i])) {
+                job.decision = MotionGate::Decision::FullFrame;
+            }
+            if (job.decision == MotionGate::Decision::FullFrame) {
+                frames.push_back(job.frame);
+            }
+        }
+        if (frames.size() == 1) {
+            results.assign(1, detector.detect(frames[0], options.confThreshold,
+                                              options.nmsThreshold));
+        } else if (!frames.empty()) {
+            results = detector.detectBatch(frames, options.confThreshold, options.nmsThreshold);
+        }
+
+        size_t next = 0;
+        for (size_t i = 0; i < jobs.size(); ++i) {
+            Job& job = jobs[i];
+            Stream& stream = *streams[job.stream];
+
+            // Only this worker touches the stream's tracker while it is busy
+            const std::vector<Track>& tracks =
+                job.decision == MotionGate::Decision::Skip ? stream.tracker.propagate()
+                : stream.tracker.update(job.decision == MotionGate::Decision::Regions
+                                        ? regionResults[i] : results[next++]);
+            if (stream.gate.isEnabled()) {
+                stream.trackBoxes.clear();
+                for (const Track& track : tracks) {
+                    stream.trackBoxes.push_back(track.getCurrentBbox());
+                }
+            }
+            if (onResult) {
+                onResult(job.stream, job.index, job.frame, tracks);
+            }
+            stream.processed++;
+            auto endToEnd = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - job.decodeStart);
+            Metrics::global().recordLatency(Metrics::Stage::EndToEnd,
+                                            static_cast<uint64_t>(endToEnd.count()));
+            if (latency.isEnabled()) {
+                std::lock_guard<std::mutex> lock(latencyMutex);
+                if (latency.record(endToEnd.count() / 1e6)) {
+                    activeInputSize = latency.getLevel().inputSize;
+                    activeStride = latency.getLevel().stride;
+                }
+            }
+
+            std::lock_guard<std::mutex> lock(mutex);
+            stream.busy = false;
+            workAvailable.notify_all();
+        }
+    }
+}
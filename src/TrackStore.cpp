@@ -0,0 +1,244 @@
+#include "TrackStore.h"
+#include <algorithm>
+#include <cmath>
+
+TrackStore::TrackStore(float processNoise, float measurementNoise)
+    : processNoise(processNoise), measurementNoise(measurementNoise),
+      trajectoryCapacity(DEFAULT_TRAJECTORY_LENGTH), trajectorySampleInterval(1) {
+}
+
+void TrackStore::setTrajectoryPolicy(int length, int sampleInterval) {
+    int capacity = std::max(1, length);
+    trajectorySampleInterval = std::max(1, sampleInterval);
+    if (capacity == trajectoryCapacity) {
+        return;
+    }
+
+    // Re-lay out live rings, keeping the newest points (oldest at index 0)
+    std::vector<cv::Point> points(size() * capacity);
+    for (int slot = 0; slot < size(); ++slot) {
+        TrajectoryView trajectory = getTrajectory(slot);
+        int kept = std::min(trajectory.size(), capacity);
+        int skipped = trajectory.size() - kept;
+        for (int k = 0; k < kept; ++k) {
+            points[slot * capacity + k] = trajectory[skipped + k];
+        }
+        trajectoryHeads[slot] = 0;
+        trajectoryLengths[slot] = kept;
+    }
+    trajectoryPoints.swap(points);
+    trajectoryCapacity = capacity;
+}
+
+void TrackStore::reserve(size_t capacity) {
+    ids.reserve(capacity);
+    classIds.reserve(capacity);
+    states.reserve(capacity);
+    timeSinceUpdate.reserve(capacity);
+    hitStreaks.reserve(capacity);
+    ages.reserve(capacity);
+    predictedBoxes.reserve(capacity);
+    boxes.reserve(capacity);
+    means.reserve(capacity * KalmanFilter::MEAN_SIZE);
+    covariances.reserve(capacity * KalmanFilter::COV_SIZE);
+    trajectoryPoints.reserve(capacity * trajectoryCapacity);
+    trajectoryHeads.reserve(capacity);
+    trajectoryLengths.reserve(capacity);
+    trajectorySinceSample.reserve(capacity);
+    assignmentDuals.reserve(capacity);
+}
+
+int TrackStore::add(const cv::Rect& bbox, int classId, int id) {
+    int slot = size();
+    resize(slot + 1);
+
+    ids[slot] = id;
+    classIds[slot] = classId;
+    states[slot] = TrackState::Tentative;
+    timeSinceUpdate[slot] = 0;
+    hitStreaks[slot] = 0;
+    ages[slot] = 0;
+    assignmentDuals[slot] = 0.0f;
+
+    float measurement[4];
+    KalmanFilter::bboxToMeasurement(bbox, measurement);
+    KalmanFilter::initState(&means[slot * KalmanFilter::MEAN_SIZE],
+                            &covariances[slot * KalmanFilter::COV_SIZE], measurement);
+    refreshPrediction(slot);
+
+    // Initialize trajectory with center of bbox
+    trajectoryHeads[slot] = 0;
+    trajectoryLengths[slot] = 0;
+    trajectorySinceSample[slot] = 0;
+    pushTrajectory(slot, bbox);
+
+    return slot;
+}
+
+void TrackStore::pushTrajectory(int slot, const cv::Rect& bbox) {
+    cv::Point* ring = &trajectoryPoints[slot * trajectoryCapacity];
+    cv::Point center(bbox.x + bbox.width / 2, bbox.y + bbox.height / 2);
+    int& head = trajectoryHeads[slot];
+    int& length = trajectoryLengths[slot];
+    int& sinceSample = trajectorySinceSample[slot];
+
+    // Downsampling: between samples the newest point just moves
+    if (length > 0 && sinceSample < trajectorySampleInterval) {
+        ring[(head + length - 1) % trajectoryCapacity] = center;
+        sinceSample++;
+        return;
+    }
+    sinceSample = 1;
+
+    // Once full, overwrite the oldest point
+    if (length < trajectoryCapacity) {
+        ring[(head + length) % trajectoryCapacity] = center;
+        length++;
+    } else {
+        ring[head] = center;
+        head = (head + 1) % trajectoryCapacity;
+    }
+}
+
+void TrackStore::refreshBox(int slot) {
+    boxes[slot] = KalmanFilter::stateToBbox(&means[slot * KalmanFilter::MEAN_SIZE]);
+}
+
+void TrackStore::refreshPrediction(int slot) {
+    predictedBoxes[slot] = KalmanFilter::stateToBbox(&means[slot * KalmanFilter::MEAN_SIZE]);
+    boxes[slot] = predictedBoxes[slot];
+}
+
+void TrackStore::predictAll() {
+    KalmanFilter::predictBatch(means.data(), covariances.data(), size(), processNoise);
+
+    for (int i = 0; i < size(); ++i) {
+        refreshPrediction(i);
+        ages[i]++;
+        timeSinceUpdate[i]++;
+    }
+}
+
+void TrackStore::propagateAll() {
+    KalmanFilter::predictBatch(means.data(), covariances.data(), size(), processNoise);
+
+    for (int i = 0; i < size(); ++i) {
+        refreshPrediction(i);
+        ages[i]++;
+    }
+}
+
+void TrackStore::update(const std::vector<int>& slots, const std::vector<int>& detectionIndices,
+                        const std::vector<Detection>& detections) {
+    int count = static_cast<int>(slots.size());
+
+    // Pack measurements and correct all matched filters in one pass
+    measurements.resize(count * 4);
+    for (int i = 0; i < count; ++i) {
+        KalmanFilter::bboxToMeasurement(detections[detectionIndices[i]].bbox, &measurements[i * 4]);
+    }
+    KalmanFilter::updateBatch(means.data(), covariances.data(), slots.data(),
+                              measurements.data(), count, measurementNoise);
+
+    for (int i = 0; i < count; ++i) {
+        int slot = slots[i];
+        const cv::Rect& bbox = detections[detectionIndices[i]].bbox;
+
+        refreshBox(slot);
+        timeSinceUpdate[slot] = 0;
+        hitStreaks[slot]++;
+
+        // Update trajectory (bounded ring)
+        pushTrajectory(slot, bbox);
+
+        // Transition to confirmed state after enough hits
+        if (states[slot] == TrackState::Tentative && hitStreaks[slot] >= 3) {
+            states[slot] = TrackState::Confirmed;
+        }
+    }
+}
+
+void TrackStore::refine(int slot, const cv::Rect& bbox) {
+    float measurement[4];
+    KalmanFilter::bboxToMeasurement(bbox, measurement);
+    KalmanFilter::updateState(&means[slot * KalmanFilter::MEAN_SIZE],
+                              &covariances[slot * KalmanFilter::COV_SIZE],
+                              measurement, measurementNoise);
+    refreshBox(slot);
+}
+
+void TrackStore::markMissed(int slot) {
+    timeSinceUpdate[slot]++;
+    hitStreaks[slot] = 0;
+}
+
+float TrackStore::getDrift(int slot) const {
+    const cv::Rect& bbox = boxes[slot];
+    TrajectoryView trajectory = getTrajectory(slot);
+    float size = static_cast<float>(std::max(bbox.width, bbox.height));
+    if (trajectory.empty() || size <= 0.0f) {
+        return 0.0f;
+    }
+
+    const cv::Point& last = trajectory.back();
+    float dx = bbox.x + bbox.width / 2.0f - last.x;
+    float dy = bbox.y + bbox.height / 2.0f - last.y;
+    return std::sqrt(dx * dx + dy * dy) / size;
+}
+
+int TrackStore::removeStale(int maxAge) {
+    // Stable in-place compaction: survivors slide down over dead slots
+    int count = size();
+    int kept = 0;
+    for (int i = 0; i < count; ++i) {
+        if (timeSinceUpdate[i] > maxAge) {
+            continue;
+        }
+        if (kept != i) {
+            moveSlot(i, kept);
+        }
+        kept++;
+    }
+
+    resize(kept);
+    return count - kept;
+}
+
+void TrackStore::moveSlot(int from, int to) {
+    ids[to] = ids[from];
+    classIds[to] = classIds[from];
+    states[to] = states[from];
+    timeSinceUpdate[to] = timeSinceUpdate[from];
+    hitStreaks[to] = hitStreaks[from];
+    ages[to] = ages[from];
+    predictedBoxes[to] = predictedBoxes[from];
+    boxes[to] = boxes[from];
+    std::copy_n(&means[from * KalmanFilter::MEAN_SIZE], KalmanFilter::MEAN_SIZE,
+                &means[to * KalmanFilter::MEAN_SIZE]);
+    std::copy_n(&covariances[from * KalmanFilter::COV_SIZE], KalmanFilter::COV_SIZE,
+                &covariances[to * KalmanFilter::COV_SIZE]);
+    std::copy_n(&trajectoryPoints[from * trajectoryCapacity], trajectoryCapacity,
+                &trajectoryPoints[to * trajectoryCapacity]);
+    trajectoryHeads[to] = trajectoryHeads[from];
+    trajectoryLengths[to] = trajectoryLengths[from];
+    trajectorySinceSample[to] = trajectorySinceSample[from];
+    assignmentDuals[to] = assignmentDuals[from];
+}
+
+void TrackStore::resize(int count) {
+    ids.resize(count);
+    classIds.resize(count);
+    states.resize(count);
+    timeSinceUpdate.resize(count);
+    hitStreaks.resize(count);
+    ages.resize(count);
+    predictedBoxes.resize(count);
+    boxes.resize(count);
+    means.resize(count * KalmanFilter::MEAN_SIZE);
+    covariances.resize(count * KalmanFilter::COV_SIZE);
+    trajectoryPoints.resize(count * trajectoryCapacity);
+    trajectoryHeads.resize(count);
+    trajectoryLengths.resize(count);
+    trajectorySinceSample.resize(count);
+    assignmentDuals.resize(count);
+}
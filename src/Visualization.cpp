@@ -0,0 +1,40 @@
+#include "Visualization.h"
+#include <iomanip>
+#include <sstream>
+
+std::vector<cv::Scalar> generateColors(int n) {
+    std::vector<cv::Scalar> colors;
+    for (int i = 0; i < n; ++i) {
+        int hue = (i * 180 / n) % 180;
+        cv::Mat hsv(1, 1, CV_8UC3, cv::Scalar(hue, 255, 255));
+        cv::Mat bgr;
+        cv::cvtColor(hsv, bgr, cv::COLOR_HSV2BGR);
+        colors.push_back(cv::Scalar(bgr.at<cv::Vec3b>(0, 0)[0],
+                                     bgr.at<cv::Vec3b>(0, 0)[1],
+                                     bgr.at<cv::Vec3b>(0, 0)[2]));
+    }
+    return colors;
+}
+
+void drawTracks(cv::Mat& frame, const std::vector<TrackRecord>& tracks,
+                const std::vector<cv::Scalar>& colors) {
+    for (const auto& track : tracks) {
+        drawTrack(frame, track.id, track.bbox, track.className, track.trajectory, colors);
+    }
+}
+
+void displayStats(cv::Mat& frame, int frameCount, double fps, int trackCount) {
+    std::stringstream ss;
+    ss << "Frame: " << frameCount << " | FPS: " << std::fixed << std::setprecision(1) 
+       << fps << " | Tracks: " << trackCount;
+    
+    std::string text = ss.str();
+    int baseLine;
+    cv::Size textSize = cv::getTextSize(text, cv::FONT_HERSHEY_SIMPLEX, 0.7, 2, &baseLine);
+    
+    cv::rectangle(frame, cv::Point(10, 10),
+                 cv::Point(20 + textSize.width, 30 + textSize.height),
+                 cv::Scalar(0, 0, 0), cv::FILLED);
+    cv::putText(frame, text, cv::Point(15, 35),
+               cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(0, 255, 0), 2);
+}
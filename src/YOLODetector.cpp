@@ -1,28 +1,44 @@
 #include "YOLODetector.h"
+#include "Metrics.h"
 #include <fstream>
 #include <iostream>
+#include <algorithm>
+#include <cmath>
+#include <limits>
+#if defined(__SSE2__) || defined(_M_X64)
+#include <emmintrin.h>
+#elif defined(__ARM_NEON)
+#include <arm_neon.h>
+#endif
 
 YOLODetector::YOLODetector(const std::string& modelPath, const std::string& configPath, 
-                           const std::string& classesPath) 
-    : inputSize(416, 416) {
+                           const std::string& classesPath, int maxBatchSize,
+                           const InferenceBackend::Options& backendOptions) 
+    : inputSize(416, 416), maxBatchSize(std::max(1, maxBatchSize)), letterbox(false) {
     
-    try {
-        // Load YOLO network
-        net = cv::dnn::readNetFromDarknet(configPath, modelPath);
-        
-        // Set backend and target
-        net.setPreferableBackend(cv::dnn::DNN_BACKEND_OPENCV);
-        net.setPreferableTarget(cv::dnn::DNN_TARGET_CPU);
-        
-        // Load class names
-        loadClassNames(classesPath);
-        
-        std::cout << "YOLO model loaded successfully!" << std::endl;
-        std::cout << "Loaded " << classNames.size() << " classes" << std::endl;
+    backend = InferenceBackend::create(modelPath, configPath, backendOptions);
+    if (!isLoaded()) {
+        std::cerr << "Error loading YOLO model: " << modelPath << std::endl;
+        return;
     }
-    catch (const cv::Exception& e) {
-        std::cerr << "Error loading YOLO model: " << e.what() << std::endl;
+    
+    // A model exported for one input shape pins the input size and batch
+    InferenceBackend::InputShape shape = backend->getInputShape();
+    if (shape.height > 0 && shape.width > 0) {
+        inputSize = cv::Size(shape.width, shape.height);
     }
+    this->maxBatchSize = batchLimit(this->maxBatchSize);
+    
+    // Load class names
+    loadClassNames(classesPath);
+    
+    std::cout << "YOLO model loaded successfully! (" << backend->getName() << " backend)" << std::endl;
+    std::cout << "Loaded " << classNames.size() << " classes" << std::endl;
+}
+
+YOLODetector::YOLODetector(const std::string& classesPath)
+    : inputSize(416, 416), maxBatchSize(1), letterbox(false) {
+    loadClassNames(classesPath);
 }
 
 void YOLODetector::loadClassNames(const std::string& classesPath) {
@@ -40,79 +56,652 @@ void YOLODetector::loadClassNames(const std::string& classesPath) {
     }
 }
 
-std::vector<cv::String> YOLODetector::getOutputNames() {
-    static std::vector<cv::String> names;
-    if (names.empty()) {
-        std::vector<int> outLayers = net.getUnconnectedOutLayers();
-        std::vector<cv::String> layersNames = net.getLayerNames();
-        names.resize(outLayers.size());
-        for (size_t i = 0; i < outLayers.size(); ++i) {
-            names[i] = layersNames[outLayers[i] - 1];
-        }
-    }
-    return names;
+int YOLODetector::batchLimit(int requested) const {
+    int fixed = backend ? backend->getInputShape().batch : 0;
+    return std::max(1, fixed > 0 ? std::min(requested, fixed) : requested);
 }
 
 std::vector<Detection> YOLODetector::detect(const cv::Mat& frame, float confThreshold, 
                                              float nmsThreshold) {
     std::vector<Detection> detections;
     
-    if (net.empty()) {
+    if (!isLoaded()) {
         std::cerr << "Network not loaded!" << std::endl;
         return detections;
     }
+    if (tiling.enabled) {
+        layoutTiles(frame.size(), tileRects);
+        if (tileRects.size() > 1) {
+            return detectTiled(frame, confThreshold, nmsThreshold);
+        }
+    }
     
-    // Create blob from frame
-    cv::Mat blob;
-    cv::dnn::blobFromImage(frame, blob, 1/255.0, inputSize, cv::Scalar(), true, false);
-    
-    // Set input to network
-    net.setInput(blob);
+    // Fill the persistent input tensor straight from the frame
+    ScopedTimer preprocessTimer(Metrics::Stage::Preprocess);
+    allocateInput(1);
+    InputTransform transform;
+    preprocess(frame, blob.ptr<float>(), transform);
+    preprocessTimer.stop();
     
     // Forward pass
-    std::vector<cv::Mat> outs;
-    net.forward(outs, getOutputNames());
+    ScopedTimer forwardTimer(Metrics::Stage::Forward);
+    backend->forward(blob, outs);
+    forwardTimer.stop();
     
-    // Process outputs
-    std::vector<int> classIds;
-    std::vector<float> confidences;
-    std::vector<cv::Rect> boxes;
+    decodeOutputs(0, 1, transform, confThreshold, nmsThreshold, detections);
+    return detections;
+}
+
+std::vector<std::vector<Detection>> YOLODetector::detectBatch(const std::vector<cv::Mat>& frames,
+                                                              float confThreshold,
+                                                              float nmsThreshold) {
+    if (!tiling.enabled || !isLoaded()) {
+        return detectImages(frames, confThreshold, nmsThreshold, maxBatchSize);
+    }
     
-    for (size_t i = 0; i < outs.size(); ++i) {
-        float* data = (float*)outs[i].data;
-        for (int j = 0; j < outs[i].rows; ++j, data += outs[i].cols) {
-            cv::Mat scores = outs[i].row(j).colRange(5, outs[i].cols);
-            cv::Point classIdPoint;
-            double confidence;
+    // Large frames are tiled one at a time; the rest still share batches
+    std::vector<std::vector<Detection>> results(frames.size());
+    std::vector<cv::Mat> whole;
+    std::vector<size_t> wholeIndices;
+    for (size_t i = 0; i < frames.size(); ++i) {
+        layoutTiles(frames[i].size(), tileRects);
+        if (tileRects.size() > 1) {
+            results[i] = detectTiled(frames[i], confThreshold, nmsThreshold);
+        } else {
+            whole.push_back(frames[i]);
+            wholeIndices.push_back(i);
+        }
+    }
+    if (!whole.empty()) {
+        std::vector<std::vector<Detection>> wholeResults =
+            detectImages(whole, confThreshold, nmsThreshold, maxBatchSize);
+        for (size_t k = 0; k < whole.size(); ++k) {
+            results[wholeIndices[k]] = std::move(wholeResults[k]);
+        }
+    }
+    return results;
+}
+
+std::vector<std::vector<Detection>> YOLODetector::detectImages(const std::vector<cv::Mat>& frames,
+                                                               float confThreshold,
+                                                               float nmsThreshold, int chunkSize) {
+    std::vector<std::vector<Detection>> results(frames.size());
+    
+    if (!isLoaded()) {
+        std::cerr << "Network not loaded!" << std::endl;
+        return results;
+    }
+    
+    const size_t imageSize = 3 * static_cast<size_t>(inputSize.area());
+    const size_t chunk = static_cast<size_t>(batchLimit(chunkSize));
+    for (size_t first = 0; first < frames.size(); first += chunk) {
+        size_t count = std::min(frames.size() - first, chunk);
+        
+        // One NCHW tensor for the whole chunk
+        ScopedTimer preprocessTimer(Metrics::Stage::Preprocess);
+        allocateInput(static_cast<int>(count));
+        batchTransforms.resize(count);
+        for (size_t b = 0; b < count; ++b) {
+            preprocess(frames[first + b], blob.ptr<float>() + b * imageSize, batchTransforms[b]);
+        }
+        preprocessTimer.stop();
+        
+        ScopedTimer forwardTimer(Metrics::Stage::Forward);
+        backend->forward(blob, outs);
+        forwardTimer.stop();
+        
+        for (size_t b = 0; b < count; ++b) {
+            decodeOutputs(static_cast<int>(b), static_cast<int>(count), batchTransforms[b],
+                          confThreshold, nmsThreshold, results[first + b]);
+        }
+    }
+    
+    return results;
+}
+
+bool YOLODetector::detectRegions(const cv::Mat& frame, const std::vector<cv::Rect>& regions,
+                                 float confThreshold, float nmsThreshold,
+                                 std::vector<Detection>& detections) {
+    detections.clear();
+    if (!isLoaded() || regions.empty()) {
+        return false;
+    }
+    // The packed input has its own shape
+    if (backend->getInputShape().height > 0) {
+        return false;
+    }
+    
+    // Regions keep the scale of a full-frame (or tile) pass, so objects look
+    // the same to the network as they would on the whole frame
+    cv::Size contentSize;
+    InputTransform frameTransform = computeTransform(frame.size(), contentSize);
+    if (tiling.enabled) {
+        frameTransform.scaleX = frameTransform.scaleY = static_cast<float>(inputSize.width) / tileSide();
+    }
+    
+    // Shelf packing, tallest first: rows of tiles left to right, REGION_GAP
+    // of gray between tiles so objects cut at a region edge do not merge
+    // with a neighbour
+    tileOrder.resize(regions.size());
+    for (size_t i = 0; i < regions.size(); ++i) {
+        tileOrder[i] = static_cast<int>(i);
+    }
+    std::sort(tileOrder.begin(), tileOrder.end(), [&regions](int a, int b) {
+        return regions[a].height > regions[b].height;
+    });
+    
+    tiles.clear();
+    int rowX = 0;
+    int rowY = 0;
+    int rowHeight = 0;
+    int canvasWidth = 0;
+    for (int i : tileOrder) {
+        const cv::Rect& region = regions[i];
+        int width = std::max(1, static_cast<int>(std::ceil(region.width * frameTransform.scaleX)));
+        int height = std::max(1, static_cast<int>(std::ceil(region.height * frameTransform.scaleY)));
+        if (width > inputSize.width) {
+            return false;
+        }
+        if (rowX > 0 && rowX + width > inputSize.width) {
+            rowY += rowHeight + REGION_GAP;
+            rowX = 0;
+            rowHeight = 0;
+        }
+        tiles.push_back({region, cv::Rect(rowX, rowY, width, height)});
+        rowX += width + REGION_GAP;
+        rowHeight = std::max(rowHeight, height);
+        canvasWidth = std::max(canvasWidth, rowX - REGION_GAP);
+    }
+    
+    // Inputs are multiples of the YOLO stride; no gain unless smaller
+    cv::Size canvas((canvasWidth + 31) / 32 * 32, (rowY + rowHeight + 31) / 32 * 32);
+    if (canvas.height > inputSize.height || canvas.area() >= inputSize.area()) {
+        return false;
+    }
+    
+    ScopedTimer preprocessTimer(Metrics::Stage::Preprocess);
+    const cv::Mat& source = toBgr(frame);
+    int sizes[] = {1, 3, canvas.height, canvas.width};
+    regionBlob.create(4, sizes, CV_32F);
+    float* tensor = regionBlob.ptr<float>();
+    std::fill(tensor, tensor + 3 * static_cast<size_t>(canvas.area()), LETTERBOX_FILL);
+    for (const RegionTile& tile : tiles) {
+        resample(source(tile.region), tensor, canvas, tile.tile);
+    }
+    preprocessTimer.stop();
+    
+    // A new input shape makes OpenCV re-plan the network; canvas sizes are
+    // multiples of 32, so only a few shapes recur
+    ScopedTimer forwardTimer(Metrics::Stage::Forward);
+    backend->forward(regionBlob, outs);
+    forwardTimer.stop();
+    
+    // Decode in canvas pixels, then move each box from its tile back to
+    // its region; boxes centered in a gap are dropped
+    InputTransform canvasTransform;
+    canvasTransform.input = canvas;
+    decodeOutputs(0, 1, canvasTransform, confThreshold, nmsThreshold, detections);
+    
+    size_t kept = 0;
+    for (Detection& detection : detections) {
+        cv::Point center(detection.bbox.x + detection.bbox.width / 2,
+                         detection.bbox.y + detection.bbox.height / 2);
+        for (const RegionTile& tile : tiles) {
+            if (!tile.tile.contains(center)) {
+                continue;
+            }
+            float left = (detection.bbox.x - tile.tile.x) / frameTransform.scaleX + tile.region.x;
+            float top = (detection.bbox.y - tile.tile.y) / frameTransform.scaleY + tile.region.y;
+            cv::Rect box(static_cast<int>(left), static_cast<int>(top),
+                         static_cast<int>(detection.bbox.width / frameTransform.scaleX),
+                         static_cast<int>(detection.bbox.height / frameTransform.scaleY));
+            box &= tile.region;
+            if (!box.empty()) {
+                detection.bbox = box;
+                detections[kept++] = detection;
+            }
+            break;
+        }
+    }
+    detections.resize(kept);
+    return true;
+}
+
+int YOLODetector::tileSide() const {
+    return tiling.tileSize > 0 ? tiling.tileSize : inputSize.width;
+}
+
+void YOLODetector::layoutTiles(const cv::Size& frameSize, std::vector<cv::Rect>& tiles) const {
+    // Evenly spaced tiles per axis, overlapping by at least `overlap`; the
+    // first and last tiles touch the frame border
+    const int side = tileSide();
+    const int overlapPixels = std::min(side / 2, std::max(0, static_cast<int>(side * tiling.overlap)));
+    const int stride = std::max(1, side - overlapPixels);
+    auto tileCount = [&](int length) {
+        return length <= side ? 1 : 1 + (length - side + stride - 1) / stride;
+    };
+    const int columns = tileCount(frameSize.width);
+    const int rows = tileCount(frameSize.height);
+    const int width = std::min(side, frameSize.width);
+    const int height = std::min(side, frameSize.height);
+    
+    tiles.clear();
+    for (int r = 0; r < rows; ++r) {
+        int y = rows > 1 ? (frameSize.height - height) * r / (rows - 1) : 0;
+        for (int c = 0; c < columns; ++c) {
+            int x = columns > 1 ? (frameSize.width - width) * c / (columns - 1) : 0;
+            tiles.emplace_back(x, y, width, height);
+        }
+    }
+}
+
+std::vector<Detection> YOLODetector::detectTiled(const cv::Mat& frame, float confThreshold,
+                                                 float nmsThreshold) {
+    layoutTiles(frame.size(), tileRects);
+    tileFrames.clear();
+    for (const cv::Rect& tile : tileRects) {
+        tileFrames.push_back(frame(tile));
+    }
+    if (tiling.coarsePass) {
+        tileFrames.push_back(frame);
+    }
+    std::vector<std::vector<Detection>> results =
+        detectImages(tileFrames, confThreshold, nmsThreshold, tiling.batchSize);
+    
+    // Back to frame pixels. A box ending within TILE_EDGE of an inner tile
+    // edge may be the visible part of a larger object.
+    const int TILE_EDGE = 2;
+    tileDetections.clear();
+    for (size_t t = 0; t < tileRects.size(); ++t) {
+        const cv::Rect& tile = tileRects[t];
+        for (const Detection& detection : results[t]) {
+            cv::Rect box = detection.bbox;
+            box.x += tile.x;
+            box.y += tile.y;
+            box &= tile;
+            if (box.empty()) {
+                continue;
+            }
+            bool clipped = (tile.x > 0 && box.x <= tile.x + TILE_EDGE) ||
+                           (tile.y > 0 && box.y <= tile.y + TILE_EDGE) ||
+                           (tile.x + tile.width < frame.cols &&
+                            box.x + box.width >= tile.x + tile.width - TILE_EDGE) ||
+                           (tile.y + tile.height < frame.rows &&
+                            box.y + box.height >= tile.y + tile.height - TILE_EDGE);
+            tileDetections.push_back({Detection(box, detection.confidence, detection.classId), clipped});
+        }
+    }
+    if (tiling.coarsePass) {
+        for (const Detection& detection : results.back()) {
+            tileDetections.push_back({detection, false});
+        }
+    }
+    
+    std::vector<Detection> detections;
+    mergeTileDetections(nmsThreshold, detections);
+    return detections;
+}
+
+void YOLODetector::mergeTileDetections(float nmsThreshold, std::vector<Detection>& detections) {
+    std::sort(tileDetections.begin(), tileDetections.end(),
+              [](const TileDetection& a, const TileDetection& b) {
+                  if (a.clipped != b.clipped) {
+                      return !a.clipped;
+                  }
+                  return a.detection.confidence > b.detection.confidence;
+              });
+    
+    const bool perClass = nms.getOptions().mode == NonMaxSuppressor::Mode::PerClass;
+    mergedDetections.clear();
+    for (const TileDetection& candidate : tileDetections) {
+        const cv::Rect& box = candidate.detection.bbox;
+        bool duplicate = false;
+        for (TileDetection& kept : mergedDetections) {
+            if (perClass && kept.detection.classId != candidate.detection.classId) {
+                continue;
+            }
+            int intersection = (kept.detection.bbox & box).area();
+            if (intersection == 0) {
+                continue;
+            }
+            int smaller = std::min(kept.detection.bbox.area(), box.area());
+            float iou = static_cast<float>(intersection) /
+                        (kept.detection.bbox.area() + box.area() - intersection);
+            if (iou > nmsThreshold || intersection > tiling.mergeThreshold * smaller) {
+                // Pieces of one object cut by different seams add up
+                if (kept.clipped) {
+                    kept.detection.bbox |= box;
+                }
+                duplicate = true;
+                break;
+            }
+        }
+        if (!duplicate) {
+            mergedDetections.push_back(candidate);
+        }
+    }
+    
+    detections.clear();
+    detections.reserve(mergedDetections.size());
+    for (const TileDetection& merged : mergedDetections) {
+        detections.push_back(merged.detection);
+    }
+}
+
+void YOLODetector::setInputSize(int size) {
+    if (backend && backend->getInputShape().height > 0) {
+        return;
+    }
+    size = std::max(32, size / 32 * 32);
+    inputSize = cv::Size(size, size);
+}
+
+void YOLODetector::makeInputTensor(const std::vector<cv::Mat>& frames, cv::Mat& tensor) {
+    int sizes[] = {static_cast<int>(frames.size()), 3, inputSize.height, inputSize.width};
+    tensor.create(4, sizes, CV_32F);
+    const size_t imageSize = 3 * static_cast<size_t>(inputSize.area());
+    InputTransform transform;
+    for (size_t b = 0; b < frames.size(); ++b) {
+        preprocess(frames[b], tensor.ptr<float>() + b * imageSize, transform);
+    }
+}
+
+bool YOLODetector::quantize(const cv::Mat& calibration) {
+    if (!isLoaded() || quantized) {
+        return quantized;
+    }
+    quantized = backend->quantize(calibration);
+    return quantized;
+}
+
+void YOLODetector::allocateInput(int batchSize) {
+    // No-op when the shape is unchanged
+    int sizes[] = {batchSize, 3, inputSize.height, inputSize.width};
+    blob.create(4, sizes, CV_32F);
+}
+
+std::vector<Detection> YOLODetector::decode(const std::vector<cv::Mat>& outputs,
+                                            const cv::Size& frameSize,
+                                            float confThreshold, float nmsThreshold) {
+    std::vector<Detection> detections;
+    decode(outputs, frameSize, confThreshold, nmsThreshold, detections);
+    return detections;
+}
+
+void YOLODetector::decode(const std::vector<cv::Mat>& outputs, const cv::Size& frameSize,
+                          float confThreshold, float nmsThreshold,
+                          std::vector<Detection>& detections) {
+    detections.clear();
+    if (&outputs != &outs) {
+        outs = outputs;
+    }
+    
+    cv::Size contentSize;
+    InputTransform transform = computeTransform(frameSize, contentSize);
+    decodeOutputs(0, 1, transform, confThreshold, nmsThreshold, detections);
+}
+
+std::vector<std::vector<Detection>> YOLODetector::decodeBatch(const std::vector<cv::Mat>& outputs,
+                                                              const std::vector<cv::Size>& frameSizes,
+                                                              float confThreshold,
+                                                              float nmsThreshold) {
+    std::vector<std::vector<Detection>> results(frameSizes.size());
+    if (&outputs != &outs) {
+        outs = outputs;
+    }
+    
+    const int batchSize = static_cast<int>(frameSizes.size());
+    for (int b = 0; b < batchSize; ++b) {
+        cv::Size contentSize;
+        InputTransform transform = computeTransform(frameSizes[b], contentSize);
+        decodeOutputs(b, batchSize, transform, confThreshold, nmsThreshold, results[b]);
+    }
+    return results;
+}
+
+YOLODetector::InputTransform YOLODetector::computeTransform(const cv::Size& frameSize,
+                                                            cv::Size& contentSize) const {
+    InputTransform transform;
+    transform.input = inputSize;
+    transform.scaleX = static_cast<float>(inputSize.width) / frameSize.width;
+    transform.scaleY = static_cast<float>(inputSize.height) / frameSize.height;
+    contentSize = inputSize;
+    if (letterbox) {
+        float scale = std::min(transform.scaleX, transform.scaleY);
+        contentSize.width = std::max(1, std::min(inputSize.width,
+            static_cast<int>(std::lround(frameSize.width * scale))));
+        contentSize.height = std::max(1, std::min(inputSize.height,
+            static_cast<int>(std::lround(frameSize.height * scale))));
+        transform.padX = static_cast<float>((inputSize.width - contentSize.width) / 2);
+        transform.padY = static_cast<float>((inputSize.height - contentSize.height) / 2);
+        transform.scaleX = static_cast<float>(contentSize.width) / frameSize.width;
+        transform.scaleY = static_cast<float>(contentSize.height) / frameSize.height;
+    }
+    return transform;
+}
+
+const cv::Mat& YOLODetector::toBgr(const cv::Mat& frame) {
+    if (frame.type() == CV_8UC3) {
+        return frame;
+    }
+    cv::cvtColor(frame, converted, frame.channels() == 1 ? cv::COLOR_GRAY2BGR : cv::COLOR_BGRA2BGR);
+    return converted;
+}
+
+void YOLODetector::preprocess(const cv::Mat& frame, float* tensor, InputTransform& transform) {
+    const cv::Mat& source = toBgr(frame);
+    
+    // Content area inside the network input
+    cv::Size contentSize;
+    transform = computeTransform(source.size(), contentSize);
+    const cv::Rect content(static_cast<int>(transform.padX), static_cast<int>(transform.padY),
+                           contentSize.width, contentSize.height);
+    
+    // Letterbox border: rows above and below, then the sides of content rows
+    const int width = inputSize.width;
+    const size_t plane = static_cast<size_t>(width) * inputSize.height;
+    for (int c = 0; c < 3; ++c) {
+        float* channel = tensor + c * plane;
+        std::fill(channel, channel + content.y * width, LETTERBOX_FILL);
+        std::fill(channel + (content.y + content.height) * width, channel + plane, LETTERBOX_FILL);
+        if (content.width < width) {
+            for (int y = content.y; y < content.y + content.height; ++y) {
+                std::fill(channel + y * width, channel + y * width + content.x, LETTERBOX_FILL);
+                std::fill(channel + y * width + content.x + content.width, channel + (y + 1) * width,
+                          LETTERBOX_FILL);
+            }
+        }
+    }
+    
+    resample(source, tensor, inputSize, content);
+}
+
+void YOLODetector::resample(const cv::Mat& source, float* tensor, const cv::Size& tensorSize,
+                            const cv::Rect& target) {
+    const int srcWidth = source.cols;
+    const int srcHeight = source.rows;
+    const int dstWidth = tensorSize.width;
+    const int contentWidth = target.width;
+    const int contentHeight = target.height;
+    
+    // Horizontal bilinear taps (byte offsets of both neighbours + weight),
+    // pixel-center aligned like cv::resize INTER_LINEAR
+    const float invScaleX = static_cast<float>(srcWidth) / contentWidth;
+    columnTaps.resize(2 * contentWidth);
+    columnWeights.resize(contentWidth);
+    for (int x = 0; x < contentWidth; ++x) {
+        float sx = std::max(0.0f, (x + 0.5f) * invScaleX - 0.5f);
+        int x0 = std::min(static_cast<int>(sx), srcWidth - 1);
+        int x1 = std::min(x0 + 1, srcWidth - 1);
+        columnTaps[2 * x] = 3 * x0;
+        columnTaps[2 * x + 1] = 3 * x1;
+        columnWeights[x] = x1 > x0 ? sx - x0 : 0.0f;
+    }
+    
+    const float invScaleY = static_cast<float>(srcHeight) / contentHeight;
+    const size_t plane = static_cast<size_t>(dstWidth) * tensorSize.height;
+    const float norm = 1.0f / 255.0f;
+    const int* taps = columnTaps.data();
+    const float* weights = columnWeights.data();
+    
+    // Single pass: sample, swap BGR->RGB, scale and write the CHW planes
+    cv::parallel_for_(cv::Range(0, contentHeight), [&](const cv::Range& range) {
+        for (int contentY = range.start; contentY < range.end; ++contentY) {
+            float* r = tensor + (target.y + contentY) * dstWidth + target.x;
+            float* g = r + plane;
+            float* b = g + plane;
             
-            cv::minMaxLoc(scores, 0, &confidence, 0, &classIdPoint);
+            float sy = std::max(0.0f, (contentY + 0.5f) * invScaleY - 0.5f);
+            int y0 = std::min(static_cast<int>(sy), srcHeight - 1);
+            int y1 = std::min(y0 + 1, srcHeight - 1);
+            float wy = y1 > y0 ? sy - y0 : 0.0f;
+            const uchar* row0 = source.ptr<uchar>(y0);
+            const uchar* row1 = source.ptr<uchar>(y1);
             
-            if (confidence > confThreshold) {
-                int centerX = (int)(data[0] * frame.cols);
-                int centerY = (int)(data[1] * frame.rows);
-                int width = (int)(data[2] * frame.cols);
-                int height = (int)(data[3] * frame.rows);
-                int left = centerX - width / 2;
-                int top = centerY - height / 2;
+            for (int x = 0; x < contentWidth; ++x) {
+                const uchar* p00 = row0 + taps[2 * x];
+                const uchar* p01 = row0 + taps[2 * x + 1];
+                const uchar* p10 = row1 + taps[2 * x];
+                const uchar* p11 = row1 + taps[2 * x + 1];
+                float wx = weights[x];
                 
-                classIds.push_back(classIdPoint.x);
-                confidences.push_back((float)confidence);
-                boxes.push_back(cv::Rect(left, top, width, height));
+                float value[3];
+                for (int c = 0; c < 3; ++c) {
+                    float top = p00[c] + (p01[c] - p00[c]) * wx;
+                    float bottom = p10[c] + (p11[c] - p10[c]) * wx;
+                    value[c] = (top + (bottom - top) * wy) * norm;
+                }
+                b[x] = value[0];
+                g[x] = value[1];
+                r[x] = value[2];
             }
         }
+    });
+}
+
+const std::string& YOLODetector::getClassName(int classId) const {
+    static const std::string unknown = "unknown";
+    return classId >= 0 && classId < static_cast<int>(classNames.size()) ? classNames[classId] : unknown;
+}
+
+void YOLODetector::setClassFilter(const std::vector<int>& classIds) {
+    classAllowed.clear();
+    if (classIds.empty()) {
+        return;
+    }
+    int maxId = *std::max_element(classIds.begin(), classIds.end());
+    classAllowed.assign(std::max(maxId + 1, static_cast<int>(classNames.size())), 0);
+    for (int id : classIds) {
+        if (id >= 0) {
+            classAllowed[id] = 1;
+        }
     }
+}
+
+float YOLODetector::maxScore(const float* scores, int count, int& argmax) {
+    // Vector max first, then the first lane holding it
+    int i = 0;
+    float best = -std::numeric_limits<float>::max();
+#if defined(__SSE2__) || defined(_M_X64)
+    if (count >= 8) {
+        __m128 m0 = _mm_loadu_ps(scores);
+        __m128 m1 = _mm_loadu_ps(scores + 4);
+        for (i = 8; i + 8 <= count; i += 8) {
+            m0 = _mm_max_ps(m0, _mm_loadu_ps(scores + i));
+            m1 = _mm_max_ps(m1, _mm_loadu_ps(scores + i + 4));
+        }
+        m0 = _mm_max_ps(m0, m1);
+        m0 = _mm_max_ps(m0, _mm_shuffle_ps(m0, m0, _MM_SHUFFLE(1, 0, 3, 2)));
+        m0 = _mm_max_ps(m0, _mm_shuffle_ps(m0, m0, _MM_SHUFFLE(2, 3, 0, 1)));
+        best = _mm_cvtss_f32(m0);
+    }
+#elif defined(__ARM_NEON)
+    if (count >= 8) {
+        float32x4_t m0 = vld1q_f32(scores);
+        float32x4_t m1 = vld1q_f32(scores + 4);
+        for (i = 8; i + 8 <= count; i += 8) {
+            m0 = vmaxq_f32(m0, vld1q_f32(scores + i));
+            m1 = vmaxq_f32(m1, vld1q_f32(scores + i + 4));
+        }
+        m0 = vmaxq_f32(m0, m1);
+        float32x2_t m = vpmax_f32(vget_low_f32(m0), vget_high_f32(m0));
+        best = vget_lane_f32(vpmax_f32(m, m), 0);
+    }
+#endif
+    for (; i < count; ++i) {
+        best = std::max(best, scores[i]);
+    }
+    
+    argmax = 0;
+    while (argmax < count - 1 && scores[argmax] != best) {
+        argmax++;
+    }
+    return best;
+}
+
+void YOLODetector::decodeOutputs(int batchIndex, int batchSize, const InputTransform& transform,
+                                 float confThreshold, float nmsThreshold,
+                                 std::vector<Detection>& detections) {
+    // Survivors go into reused arrays; no per-row allocation
+    ScopedTimer decodeTimer(Metrics::Stage::OutputDecode);
+    candidateBoxes.clear();
+    candidateScores.clear();
+    candidateClassIds.clear();
+    
+    for (size_t i = 0; i < outs.size(); ++i) {
+        // 2-D [batch * rows, 5 + C] with the images stacked along the rows,
+        // or 3-D [batch, rows, 5 + C] as the Region layer returns for N > 1
+        const cv::Mat& out = outs[i];
+        const bool planar = out.dims == 3;
+        const int rowsPerImage = planar ? out.size[1] : out.rows / batchSize;
+        const int cols = planar ? out.size[2] : out.cols;
+        const int numClasses = cols - 5;
+        const float* data = planar ? out.ptr<float>(batchIndex)
+                                   : out.ptr<float>(batchIndex * rowsPerImage);
+        
+        for (int j = 0; j < rowsPerImage; ++j, data += cols) {
+            // Class scores are objectness * class probability, so a row
+            // with low objectness cannot pass the confidence threshold
+            if (data[4] <= confThreshold) {
+                continue;
+            }
+            
+            int classId;
+            float confidence = maxScore(data + 5, numClasses, classId);
+            if (confidence <= confThreshold) {
+                continue;
+            }
+            if (!classAllowed.empty() &&
+                (classId >= static_cast<int>(classAllowed.size()) || !classAllowed[classId])) {
+                continue;
+            }
+            
+            // Network coordinates are relative to the input tensor; undo the
+            // letterbox padding and scaling to get frame pixels
+            int centerX = (int)((data[0] * transform.input.width - transform.padX) / transform.scaleX);
+            int centerY = (int)((data[1] * transform.input.height - transform.padY) / transform.scaleY);
+            int width = (int)(data[2] * transform.input.width / transform.scaleX);
+            int height = (int)(data[3] * transform.input.height / transform.scaleY);
+            int left = centerX - width / 2;
+            int top = centerY - height / 2;
+            
+            candidateClassIds.push_back(classId);
+            candidateScores.push_back(confidence);
+            candidateBoxes.emplace_back(left, top, width, height);
+        }
+    }
+    
+    decodeTimer.stop();
     
     // Apply Non-Maximum Suppression
-    std::vector<int> indices;
-    cv::dnn::NMSBoxes(boxes, confidences, confThreshold, nmsThreshold, indices);
+    ScopedTimer nmsTimer(Metrics::Stage::Nms);
+    nms.run(candidateBoxes.data(), candidateScores.data(), candidateClassIds.data(),
+            static_cast<int>(candidateBoxes.size()), confThreshold, nmsThreshold, keptIndices);
     
     // Create Detection objects
-    for (size_t i = 0; i < indices.size(); ++i) {
-        int idx = indices[i];
-        std::string className = classIds[idx] < classNames.size() ? 
-                                classNames[classIds[idx]] : "unknown";
-        detections.emplace_back(boxes[idx], confidences[idx], classIds[idx], className);
+    detections.reserve(detections.size() + keptIndices.size());
+    for (size_t i = 0; i < keptIndices.size(); ++i) {
+        int idx = keptIndices[i];
+        detections.emplace_back(candidateBoxes[idx], candidateScores[idx], candidateClassIds[idx]);
     }
-    
-    return detections;
 }
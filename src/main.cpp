@@ -1,85 +1,586 @@
 #include <opencv2/opencv.hpp>
 #include <iostream>
-#include <iomanip>
+#include <thread>
+#include <atomic>
+#include <chrono>
+#include <fstream>
+#include <memory>
+#include <mutex>
+#include <sstream>
 #include "YOLODetector.h"
 #include "Tracker.h"
+#include "BoundedQueue.h"
+#include "Config.h"
+#include "OpticalFlowRefiner.h"
+#include "StreamServer.h"
+#include "OutputSink.h"
+#include "Visualization.h"
+#include "Metrics.h"
+#include "DetectionCache.h"
+#include "FrameSource.h"
+#include "MotionGate.h"
+#include "LatencyController.h"
+#include "Int8Calibrator.h"
 
-// Color palette for visualization
-std::vector<cv::Scalar> generateColors(int n) {
-    std::vector<cv::Scalar> colors;
-    for (int i = 0; i < n; ++i) {
-        int hue = (i * 180 / n) % 180;
-        cv::Mat hsv(1, 1, CV_8UC3, cv::Scalar(hue, 255, 255));
-        cv::Mat bgr;
-        cv::cvtColor(hsv, bgr, cv::COLOR_HSV2BGR);
-        colors.push_back(cv::Scalar(bgr.at<cv::Vec3b>(0, 0)[0],
-                                     bgr.at<cv::Vec3b>(0, 0)[1],
-                                     bgr.at<cv::Vec3b>(0, 0)[2]));
-    }
-    return colors;
-}
-
-void drawTracks(cv::Mat& frame, const std::vector<std::shared_ptr<Track>>& tracks,
-                const std::vector<cv::Scalar>& colors) {
-    for (const auto& track : tracks) {
-        int id = track->getId();
-        cv::Rect bbox = track->getCurrentBbox();
-        cv::Scalar color = colors[id % colors.size()];
+// Maximum number of frames buffered between two pipeline stages
+static const size_t PIPELINE_QUEUE_CAPACITY = 4;
+
+// Unit of work passed between pipeline stages
+struct FramePacket {
+    int index = 0;
+    cv::Mat frame;
+    bool detected = false;     // false: detector skipped, tracks propagated
+    std::vector<cv::Rect> regions;   // detector sees only these (empty = whole frame)
+    std::vector<Detection> detections;
+    std::vector<TrackRecord> tracks;
+    std::chrono::steady_clock::time_point decodeStart;
+};
+
+NonMaxSuppressor::Options readNmsOptions(const Config& settings) {
+    NonMaxSuppressor::Options options;
+    options.mode = NonMaxSuppressor::parseMode(settings.getString("Detection", "nms_mode", "per_class"));
+    options.topK = settings.getInt("Detection", "nms_top_k", 0);
+    options.maxDetections = settings.getInt("Detection", "max_detections", 0);
+    options.useGrid = settings.getBool("Detection", "nms_grid", false);
+    return options;
+}
+
+// [Detection] tiling: native-scale tiles for high-resolution frames
+YOLODetector::TileOptions readTileOptions(const Config& settings) {
+    YOLODetector::TileOptions options;
+    options.enabled = settings.getBool("Detection", "tiling", false);
+    options.tileSize = settings.getInt("Detection", "tile_size", 0);
+    options.overlap = settings.getFloat("Detection", "tile_overlap", 0.2f);
+    options.coarsePass = settings.getBool("Detection", "tile_coarse_pass", true);
+    options.mergeThreshold = settings.getFloat("Detection", "tile_merge_threshold", 0.6f);
+    options.batchSize = std::max(1, settings.getInt("Detection", "tile_batch_size", 8));
+    return options;
+}
+
+// [Detection] backend: inference runtime and its thread pools
+InferenceBackend::Options readBackendOptions(const Config& settings) {
+    InferenceBackend::Options options;
+    options.name = settings.getString("Detection", "backend", "opencv");
+    options.intraOpThreads = settings.getInt("Detection", "intra_op_threads", 0);
+    options.interOpThreads = settings.getInt("Detection", "inter_op_threads", 0);
+    return options;
+}
+
+// [Quantization]: INT8 inference calibrated on sample frames
+Int8Calibrator::Options readInt8Options(const Config& settings) {
+    Int8Calibrator::Options options;
+    options.enabled = settings.getBool("Quantization", "int8", false);
+    options.calibrationDir = settings.getString("Quantization", "calibration_dir", "data/calibration");
+    options.maxFrames = settings.getInt("Quantization", "calibration_frames", 16);
+    options.cacheDir = settings.getString("Quantization", "cache_dir", "");
+    options.matchIoU = settings.getFloat("Quantization", "match_iou", 0.5f);
+    return options;
+}
+
+// [Input]: frame size of raw BGR files and the shared-memory hold window
+FrameSource::Options readSourceOptions(const Config& settings) {
+    FrameSource::Options options;
+    options.rawWidth = settings.getInt("Input", "raw_width", 0);
+    options.rawHeight = settings.getInt("Input", "raw_height", 0);
+    options.rawFps = settings.getFloat("Input", "raw_fps", 0.0f);
+    options.holdFrames = settings.getInt("Input", "shm_hold_frames", 32);
+    return options;
+}
+
+// [MotionGate]: skip or crop detection on mostly static cameras
+MotionGate::Options readMotionGateOptions(const Config& settings) {
+    MotionGate::Options options;
+    options.enabled = settings.getBool("MotionGate", "enabled", false);
+    options.analysisWidth = settings.getInt("MotionGate", "analysis_width", 160);
+    options.pixelThreshold = settings.getInt("MotionGate", "pixel_threshold", 25);
+    options.minArea = settings.getFloat("MotionGate", "min_area", 0.001f);
+    options.backgroundRate = settings.getFloat("MotionGate", "background_rate", 0.05f);
+    options.margin = settings.getFloat("MotionGate", "margin", 0.25f);
+    options.maxCoverage = settings.getFloat("MotionGate", "max_coverage", 0.5f);
+    options.maxRegions = settings.getInt("MotionGate", "max_regions", 8);
+    options.refreshInterval = settings.getInt("MotionGate", "refresh_interval", 150);
+    return options;
+}
+
+// [Latency]: adapt input size and detection stride to a latency budget
+LatencyController::Options readLatencyOptions(const Config& settings) {
+    LatencyController::Options options;
+    options.enabled = settings.getBool("Latency", "enabled", false);
+    options.budgetMs = settings.getFloat("Latency", "budget_ms", 33.0f);
+    options.inputSizes = settings.getIntList("Latency", "input_sizes");
+    options.strides = settings.getIntList("Latency", "strides");
+    if (options.inputSizes.empty()) {
+        options.inputSizes = {608, 416, 320};
+    }
+    if (options.strides.empty()) {
+        options.strides = {1, 2, 3};
+    }
+    options.window = settings.getInt("Latency", "window", 30);
+    options.upgradeHeadroom = settings.getFloat("Latency", "upgrade_headroom", 0.8f);
+    options.cooldown = settings.getInt("Latency", "cooldown", 90);
+    return options;
+}
+
+// "out.avi" -> "out_3.avi"
+std::string streamOutputPath(const std::string& outputPath, int stream) {
+    size_t dot = outputPath.find_last_of('.');
+    size_t slash = outputPath.find_last_of("/\\");
+    if (dot == std::string::npos || (slash != std::string::npos && dot < slash)) {
+        return outputPath + "_" + std::to_string(stream);
+    }
+    return outputPath.substr(0, dot) + "_" + std::to_string(stream) + outputPath.substr(dot);
+}
+
+// [Metrics]: enables the stage timers and, with export_path set, a periodic
+// JSON / Prometheus export. Returns the exporter, if any.
+std::unique_ptr<MetricsExporter> startMetrics(const Config& settings) {
+    if (!settings.getBool("Metrics", "enabled", false)) {
+        return nullptr;
+    }
+    Metrics::global().setEnabled(true);
+    
+    std::string path = settings.getString("Metrics", "export_path", "");
+    if (path.empty()) {
+        return nullptr;
+    }
+    return std::unique_ptr<MetricsExporter>(new MetricsExporter(
+        path, MetricsExporter::parseFormat(settings.getString("Metrics", "format", "json")),
+        settings.getFloat("Metrics", "export_interval", 5.0f)));
+}
+
+// Final export and per-stage summary
+void finishMetrics(std::unique_ptr<MetricsExporter>& exporter) {
+    if (exporter) {
+        exporter->stop();
+    }
+    if (Metrics::global().isEnabled()) {
+        std::cout << "\n=== Stage Latencies (ms) ===" << std::endl;
+        Metrics::global().printSummary(std::cout);
+    }
+}
+
+// Sinks from the [Output] section. stream >= 0 gives every file a per-stream
+// suffix (multi-stream mode).
+std::vector<std::unique_ptr<OutputSink>> openSinks(const Config& settings,
+                                                   const std::string& videoPath,
+                                                   double fps, int stream) {
+    auto outputName = [stream](const std::string& path) {
+        return stream >= 0 ? streamOutputPath(path, stream) : path;
+    };
+    
+    std::vector<std::unique_ptr<OutputSink>> sinks;
+    if (settings.getBool("Output", "video", true) && !videoPath.empty()) {
+        sinks.emplace_back(new VideoSink(outputName(videoPath), fps,
+                                         settings.getFloat("Output", "video_scale", 1.0f),
+                                         settings.getInt("Output", "video_every_nth", 1)));
+    }
+    std::string motFile = settings.getString("Output", "mot_file", "");
+    if (!motFile.empty()) {
+        sinks.emplace_back(new MotTextSink(outputName(motFile)));
+    }
+    std::string trackLog = settings.getString("Output", "track_log", "");
+    if (!trackLog.empty()) {
+        sinks.emplace_back(new BinaryTrackSink(outputName(trackLog)));
+    }
+    return sinks;
+}
+
+bool sinksWantTrajectories(const std::vector<std::unique_ptr<OutputSink>>& sinks) {
+    for (const auto& sink : sinks) {
+        if (sink->wantsTrajectories()) {
+            return true;
+        }
+    }
+    return false;
+}
+
+// Copies the tracker's output for consumers on other threads; className maps
+// a class id to its name
+template <typename ClassNameLookup>
+void copyTracks(const std::vector<Track>& tracks, const ClassNameLookup& className,
+                bool withTrajectories, std::vector<TrackRecord>& records) {
+    records.resize(tracks.size());
+    for (size_t i = 0; i < tracks.size(); ++i) {
+        TrackRecord& record = records[i];
+        record.id = tracks[i].getId();
+        record.classId = tracks[i].getClassId();
+        record.bbox = tracks[i].getCurrentBbox();
+        record.className = className(record.classId);
+        if (withTrajectories) {
+            tracks[i].getTrajectory().copyTo(record.trajectory);
+        } else {
+            record.trajectory.clear();
+        }
+    }
+}
+
+// The model files (by size and modification time) and the [Detection] and
+// class filter settings: everything but the input that determines the
+// detector's output
+std::string detectorIdentity(const std::string& modelPath, const std::string& configPath,
+                             const Config& settings) {
+    NonMaxSuppressor::Options nms = readNmsOptions(settings);
+    std::ostringstream identity;
+    identity << "weights=" << DetectionCache::fileFingerprint(modelPath)
+             << "\ncfg=" << DetectionCache::fileFingerprint(configPath)
+             << "\nconf=" << settings.getFloat("Detection", "confidence_threshold", 0.5f)
+             << "\nnms=" << settings.getFloat("Detection", "nms_threshold", 0.4f)
+             << "\nnms_mode=" << static_cast<int>(nms.mode) << "," << nms.topK << ","
+             << nms.maxDetections << "," << nms.useGrid
+             << "\nletterbox=" << settings.getBool("Detection", "letterbox", false)
+             << "\ninput_size=" << settings.getInt("Detection", "input_size", 416);
+    YOLODetector::TileOptions tiling = readTileOptions(settings);
+    if (tiling.enabled) {
+        identity << "\ntiling=" << tiling.tileSize << "," << tiling.overlap << ","
+                 << tiling.coarsePass << "," << tiling.mergeThreshold;
+    }
+    // Runtimes differ in the last bits of their outputs; threads do not matter
+    std::string backend = readBackendOptions(settings).name;
+    if (backend != "opencv") {
+        identity << "\nbackend=" << backend;
+    }
+    identity << "\nclasses=";
+    for (int classId : settings.getIntList("Classes", "track_classes")) {
+        identity << classId << ",";
+    }
+    return identity.str();
+}
+
+// Everything that determines the detector's output for a video: the video,
+// the detector and, in INT8 mode, the calibration frames. Tracker settings
+// are deliberately left out so that one cache serves any tracker
+// configuration.
+std::string detectionIdentity(const std::string& videoPath, const std::string& modelPath,
+                              const std::string& configPath, const Config& settings) {
+    std::string identity = "video=" + DetectionCache::fileFingerprint(videoPath) + "\n" +
+                           detectorIdentity(modelPath, configPath, settings);
+    Int8Calibrator::Options int8 = readInt8Options(settings);
+    if (int8.enabled) {
+        identity += "\nint8=" + Int8Calibrator(int8, "").getIdentity();
+    }
+    return identity;
+}
+
+// Multi-stream mode: one source per line of sourcesPath (files, URLs, or
+// camera indices; '#' starts a comment). All streams share the detector
+// workers; each writes its own annotated video.
+int runStreams(const std::string& sourcesPath, const std::string& modelPath,
+               const std::string& configPath, const std::string& classesPath,
+               const std::string& outputPath, const Config& settings) {
+    StreamServer::Options options;
+    options.confThreshold = settings.getFloat("Detection", "confidence_threshold", 0.5f);
+    options.nmsThreshold = settings.getFloat("Detection", "nms_threshold", 0.4f);
+    options.maxIoUDistance = settings.getFloat("Tracking", "max_iou_distance", 0.7f);
+    options.maxAge = settings.getInt("Tracking", "max_age", 30);
+    options.minHits = settings.getInt("Tracking", "min_hits", 3);
+    options.trackClasses = settings.getIntList("Classes", "track_classes");
+    options.nmsOptions = readNmsOptions(settings);
+    options.letterbox = settings.getBool("Detection", "letterbox", false);
+    options.inputSize = settings.getInt("Detection", "input_size", 416);
+    options.tiling = readTileOptions(settings);
+    options.backend = readBackendOptions(settings);
+    options.sourceOptions = readSourceOptions(settings);
+    options.motionGate = readMotionGateOptions(settings);
+    options.latency = readLatencyOptions(settings);
+    options.trajectoryLength = settings.getInt("Visualization", "trajectory_length", 30);
+    options.trajectorySampleInterval = settings.getInt("Visualization", "trajectory_sample_interval", 1);
+    // [Server] batch_size; settings files without it keep [Performance] batch_size
+    options.batchSize = settings.getInt("Server", "batch_size",
+                                        settings.getInt("Performance", "batch_size", 1));
+    options.detectorWorkers = settings.getInt("Server", "detector_workers", 1);
+    options.queueDepth = settings.getInt("Server", "stream_queue_depth", 2);
+    options.dropFrames = settings.getBool("Server", "drop_frames", true);
+    
+    std::ifstream sourcesFile(sourcesPath);
+    if (!sourcesFile.is_open()) {
+        std::cerr << "Error: Could not open stream list: " << sourcesPath << std::endl;
+        return -1;
+    }
+    
+    std::unique_ptr<MetricsExporter> metricsExporter = startMetrics(settings);
+    StreamServer server(modelPath, configPath, classesPath, options);
+    if (!server.isLoaded()) {
+        std::cerr << "Error: Failed to load YOLO model!" << std::endl;
+        return -1;
+    }
+    Int8Calibrator::Options int8 = readInt8Options(settings);
+    if (int8.enabled) {
+        Int8Calibrator calibrator(int8, detectorIdentity(modelPath, configPath, settings));
+        if (server.quantize(calibrator)) {
+            calibrator.printReport(std::cout);
+        } else {
+            std::cerr << "INT8 quantization unavailable; running in FP32" << std::endl;
+        }
+    }
+    
+    std::string line;
+    while (std::getline(sourcesFile, line)) {
+        line = line.substr(0, line.find('#'));
+        line.erase(0, line.find_first_not_of(" \t\r"));
+        line.erase(line.find_last_not_of(" \t\r") + 1);
+        if (!line.empty()) {
+            server.addStream(line);
+        }
+    }
+    
+    int streamCount = server.getStreamCount();
+    if (streamCount == 0) {
+        std::cerr << "Error: No stream could be opened" << std::endl;
+        return -1;
+    }
+    
+    std::cout << "=== Multi-Stream Tracking ===" << std::endl;
+    std::cout << "Streams: " << streamCount << std::endl;
+    std::cout << "Detector workers: " << std::max(1, options.detectorWorkers)
+              << ", batch size: " << std::max(1, options.batchSize) << std::endl;
+    std::cout << "=============================" << std::endl;
+    if (options.detectorWorkers > 1 && options.batchSize <= 1) {
+        std::cout << "Note: each detector worker loads its own network; one worker with "
+                  << "[Server] batch_size > 1 usually serves the same streams in less memory"
+                  << std::endl;
+    }
+    
+    // Indexed by stream; the server never runs two callbacks for one stream
+    // at once, so per-stream state needs no lock
+    std::vector<std::vector<std::unique_ptr<OutputSink>>> sinks(streamCount);
+    std::vector<bool> withTrajectories(streamCount);
+    std::vector<FrameResult> results(streamCount);
+    std::vector<int64_t> lastTicks(streamCount, cv::getTickCount());
+    for (int i = 0; i < streamCount; ++i) {
+        sinks[i] = openSinks(settings, outputPath, server.getInputFps(i), i);
+        withTrajectories[i] = sinksWantTrajectories(sinks[i]);
+    }
+    auto className = [&server](int classId) -> const std::string& {
+        return server.getClassName(classId);
+    };
+    std::mutex logMutex;
+    
+    auto startTime = cv::getTickCount();
+    
+    server.run([&](int stream, int frameIndex, cv::Mat& frame, const std::vector<Track>& tracks) {
+        if (!sinks[stream].empty()) {
+            int64_t now = cv::getTickCount();
+            double frameTime = (now - lastTicks[stream]) / cv::getTickFrequency();
+            lastTicks[stream] = now;
+            
+            FrameResult& result = results[stream];
+            result.index = frameIndex;
+            result.frame = frame;
+            result.fps = frameTime > 0.0 ? 1.0 / frameTime : 0.0;
+            copyTracks(tracks, className, withTrajectories[stream], result.tracks);
+            for (auto& sink : sinks[stream]) {
+                sink->write(result);
+            }
+            result.frame.release();
+        }
         
-        // Draw bounding box
-        cv::rectangle(frame, bbox, color, 2);
+        if ((frameIndex + 1) % 300 == 0) {
+            std::lock_guard<std::mutex> lock(logMutex);
+            std::cout << "Stream " << stream << ": frame " << frameIndex + 1
+                      << ", " << tracks.size() << " tracks" << std::endl;
+        }
+    });
+    
+    // Drain the sink queues before reporting
+    for (auto& streamSinks : sinks) {
+        for (auto& sink : streamSinks) {
+            sink->close();
+        }
+    }
+    
+    double totalTime = (cv::getTickCount() - startTime) / cv::getTickFrequency();
+    
+    std::cout << "\n=== Processing Complete ===" << std::endl;
+    int totalProcessed = 0;
+    for (int i = 0; i < streamCount; ++i) {
+        StreamServer::StreamStats stats = server.getStats(i);
+        totalProcessed += stats.processed;
+        std::cout << "Stream " << i << " (" << server.getSource(i) << "): "
+                  << stats.processed << " processed, " << stats.dropped << " dropped, "
+                  << server.getTotalTracks(i) - 1 << " tracks" << std::endl;
+        if (options.motionGate.enabled) {
+            std::cout << "  motion gate: " << stats.gate.skipped << " skipped, "
+                      << stats.gate.regions << " region, " << stats.gate.fullFrames
+                      << " full-frame detections" << std::endl;
+        }
+    }
+    const LatencyController& latency = server.getLatencyController();
+    if (latency.isEnabled()) {
+        std::cout << "Latency controller: " << latency.getChanges()
+                  << " level changes, ending at input " << latency.getLevel().inputSize
+                  << ", stride " << latency.getLevel().stride << std::endl;
+    }
+    std::cout << "Total time: " << totalTime << " seconds" << std::endl;
+    std::cout << "Aggregate FPS: " << (totalProcessed / totalTime) << std::endl;
+    finishMetrics(metricsExporter);
+    
+    return 0;
+}
+
+// Replay mode: feeds cached detections (.motd) or a MOTChallenge det.txt
+// into the tracker with the [Tracking] and [Performance] settings. No video
+// is decoded and no network is loaded, so only the text and binary sinks
+// are available.
+int runReplay(const std::string& detectionsPath, const Config& settings) {
+    DetectionCache cache;
+    MotDetectionFile motDetections;
+    const DetectionSequence* sequence = nullptr;
+    bool isCache = detectionsPath.size() > 5 &&
+                   detectionsPath.compare(detectionsPath.size() - 5, 5, ".motd") == 0;
+    if (isCache ? cache.open(detectionsPath)
+                : motDetections.load(detectionsPath,
+                                     settings.getFloat("Cache", "mot_det_min_confidence", 0.0f))) {
+        sequence = isCache ? static_cast<const DetectionSequence*>(&cache) : &motDetections;
+    } else {
+        std::cerr << "Error: Could not read detections: " << detectionsPath << std::endl;
+        return -1;
+    }
+    
+    int detectionStride = std::max(1, settings.getInt("Performance", "skip_frames", 1));
+    bool adaptiveDetection = settings.getBool("Performance", "adaptive_detection", true);
+    float maxTrackDrift = settings.getFloat("Performance", "max_track_drift", 0.5f);
+    
+    Tracker tracker(settings.getFloat("Tracking", "max_iou_distance", 0.7f),
+                    settings.getInt("Tracking", "max_age", 30),
+                    settings.getInt("Tracking", "min_hits", 3));
+    tracker.setTrajectoryPolicy(settings.getInt("Visualization", "trajectory_length", 30),
+                                settings.getInt("Visualization", "trajectory_sample_interval", 1));
+    
+    std::cout << "=== Detection Replay ===" << std::endl;
+    std::cout << "Detections: " << detectionsPath << " (" << sequence->getFrameCount()
+              << " frames)" << std::endl;
+    std::cout << "Detection stride: " << detectionStride
+              << (adaptiveDetection ? " (adaptive)" : "") << std::endl;
+    std::cout << "========================" << std::endl;
+    
+    std::unique_ptr<MetricsExporter> metricsExporter = startMetrics(settings);
+    std::vector<std::unique_ptr<OutputSink>> sinks = openSinks(settings, "", 0.0, -1);
+    bool withTrajectories = sinksWantTrajectories(sinks);
+    auto className = [](int) -> const std::string& {
+        static const std::string unknown;
+        return unknown;
+    };
+    
+    std::vector<Detection> detections;
+    FrameResult result;
+    bool detectionRequested = false;
+    int frameCount = sequence->getFrameCount();
+    auto startTime = cv::getTickCount();
+    
+    for (int index = 0; index < frameCount; ++index) {
+        // Frames the cache has no detections for are propagated
+        bool detected = (index % detectionStride == 0 || detectionRequested) &&
+                        sequence->getFrame(index, detections);
+        detectionRequested = false;
         
-        // Draw track ID and class
-        std::string label = "ID:" + std::to_string(id) + " " + track->getClassName();
-        int baseLine;
-        cv::Size labelSize = cv::getTextSize(label, cv::FONT_HERSHEY_SIMPLEX, 
-                                             0.5, 1, &baseLine);
+        const std::vector<Track>& tracks = detected ? tracker.update(detections)
+                                                    : tracker.propagate(nullptr);
         
-        int top = std::max(bbox.y, labelSize.height);
-        cv::rectangle(frame, 
-                     cv::Point(bbox.x, top - labelSize.height - 5),
-                     cv::Point(bbox.x + labelSize.width, top + baseLine),
-                     color, cv::FILLED);
-        cv::putText(frame, label, cv::Point(bbox.x, top - 2),
-                   cv::FONT_HERSHEY_SIMPLEX, 0.5, cv::Scalar(255, 255, 255), 1);
+        if (detectionStride > 1 && adaptiveDetection && tracker.isUncertain(maxTrackDrift)) {
+            detectionRequested = true;
+        }
         
-        // Draw trajectory
-        std::vector<cv::Point> trajectory = track->getTrajectory();
-        for (size_t i = 1; i < trajectory.size(); ++i) {
-            cv::line(frame, trajectory[i-1], trajectory[i], color, 2);
+        if (!sinks.empty()) {
+            result.index = index;
+            copyTracks(tracks, className, withTrajectories, result.tracks);
+            for (auto& sink : sinks) {
+                sink->write(result);
+            }
         }
     }
-}
-
-void displayStats(cv::Mat& frame, int frameCount, double fps, int trackCount) {
-    std::stringstream ss;
-    ss << "Frame: " << frameCount << " | FPS: " << std::fixed << std::setprecision(1) 
-       << fps << " | Tracks: " << trackCount;
     
-    std::string text = ss.str();
-    int baseLine;
-    cv::Size textSize = cv::getTextSize(text, cv::FONT_HERSHEY_SIMPLEX, 0.7, 2, &baseLine);
+    for (auto& sink : sinks) {
+        sink->close();
+    }
+    double totalTime = (cv::getTickCount() - startTime) / cv::getTickFrequency();
     
-    cv::rectangle(frame, cv::Point(10, 10),
-                 cv::Point(20 + textSize.width, 30 + textSize.height),
-                 cv::Scalar(0, 0, 0), cv::FILLED);
-    cv::putText(frame, text, cv::Point(15, 35),
-               cv::FONT_HERSHEY_SIMPLEX, 0.7, cv::Scalar(0, 255, 0), 2);
+    std::cout << "\n=== Replay Complete ===" << std::endl;
+    std::cout << "Total frames: " << frameCount << std::endl;
+    std::cout << "Total time: " << totalTime << " seconds" << std::endl;
+    std::cout << "Average FPS: " << (totalTime > 0.0 ? frameCount / totalTime : 0.0) << std::endl;
+    std::cout << "Total unique tracks: " << tracker.getTotalTracks() - 1 << std::endl;
+    finishMetrics(metricsExporter);
+    return 0;
 }
 
 int main(int argc, char** argv) {
+    // Multi-stream mode: mot_tracker --streams <sources.txt> [model] [cfg]
+    //                    [classes] [output] [settings]
+    bool multiStream = argc >= 2 && std::string(argv[1]) == "--streams";
+    if (multiStream) {
+        argc--;
+        argv++;
+    }
+    
+    // Replay mode: mot_tracker --replay <detections.motd | det.txt> [settings]
+    if (argc >= 3 && std::string(argv[1]) == "--replay") {
+        Config replaySettings;
+        std::string replaySettingsPath = argc >= 4 ? argv[3] : "config.txt";
+        if (!replaySettings.load(replaySettingsPath)) {
+            std::cout << "Settings file not found, using defaults: " << replaySettingsPath << std::endl;
+        }
+        return runReplay(argv[2], replaySettings);
+    }
+    
     // Parse command line arguments
     std::string videoPath = "input.mp4";
     std::string modelPath = "models/yolov4-tiny.weights";
     std::string configPath = "models/yolov4-tiny.cfg";
     std::string classesPath = "models/coco.names";
     std::string outputPath = "output.avi";
+    std::string settingsPath = "config.txt";
     
     if (argc >= 2) videoPath = argv[1];
     if (argc >= 3) modelPath = argv[2];
     if (argc >= 4) configPath = argv[3];
     if (argc >= 5) classesPath = argv[4];
     if (argc >= 6) outputPath = argv[5];
+    if (argc >= 7) settingsPath = argv[6];
+    
+    // Tunable parameters (config.txt); built-in defaults if it is missing
+    Config settings;
+    if (!settings.load(settingsPath)) {
+        std::cout << "Settings file not found, using defaults: " << settingsPath << std::endl;
+    }
+    
+    if (multiStream) {
+        return runStreams(videoPath, modelPath, configPath, classesPath, outputPath, settings);
+    }
+    
+    float confThreshold = settings.getFloat("Detection", "confidence_threshold", 0.5f);
+    float nmsThreshold = settings.getFloat("Detection", "nms_threshold", 0.4f);
+    float maxIoUDistance = settings.getFloat("Tracking", "max_iou_distance", 0.7f);
+    int maxAge = settings.getInt("Tracking", "max_age", 30);
+    int minHits = settings.getInt("Tracking", "min_hits", 3);
+    std::vector<int> trackClasses = settings.getIntList("Classes", "track_classes");
+    int trajectoryLength = settings.getInt("Visualization", "trajectory_length", 30);
+    int trajectorySampleInterval = settings.getInt("Visualization", "trajectory_sample_interval", 1);
+    
+    // Detection stride: run the detector on every Nth frame and propagate
+    // tracks in between (1 = detect on every frame)
+    int detectionStride = std::max(1, settings.getInt("Performance", "skip_frames", 1));
+    bool adaptiveDetection = settings.getBool("Performance", "adaptive_detection", true);
+    float maxTrackDrift = settings.getFloat("Performance", "max_track_drift", 0.5f);
+    bool useOpticalFlow = settings.getBool("Performance", "optical_flow_refinement", false);
+    
+    // Batched inference: up to batchSize detector frames share one forward
+    // pass; a partial batch is flushed after batchTimeoutMs without new frames
+    int batchSize = std::max(1, settings.getInt("Performance", "batch_size", 1));
+    int batchTimeoutMs = std::max(0, settings.getInt("Performance", "batch_timeout_ms", 20));
+    
+    // Motion gate: on frames due for detection, skip the detector when
+    // nothing moved and detect only around motion and tracks otherwise
+    MotionGate motionGate(readMotionGateOptions(settings));
+    
+    // Latency budget: the detector's time per frame (amortized over
+    // stride-skipped frames) is held below budget_ms by switching the input
+    // size and the stride
+    int inputSize = settings.getInt("Detection", "input_size", 416);
+    LatencyController latencyController(readLatencyOptions(settings), inputSize, detectionStride);
+    if (latencyController.isEnabled()) {
+        inputSize = latencyController.getLevel().inputSize;
+        detectionStride = latencyController.getLevel().stride;
+    }
     
     std::cout << "=== Multi-Object Tracking System ===" << std::endl;
     std::cout << "Video: " << videoPath << std::endl;
@@ -87,71 +588,318 @@ int main(int argc, char** argv) {
     std::cout << "Config: " << configPath << std::endl;
     std::cout << "Classes: " << classesPath << std::endl;
     std::cout << "Output: " << outputPath << std::endl;
+    std::cout << "Detection stride: " << detectionStride
+              << (adaptiveDetection ? " (adaptive)" : "") << std::endl;
+    std::cout << "Detection batch size: " << batchSize << std::endl;
+    std::cout << "Motion gate: " << (motionGate.isEnabled() ? "on" : "off") << std::endl;
+    if (latencyController.isEnabled()) {
+        std::cout << "Latency budget: " << readLatencyOptions(settings).budgetMs
+                  << " ms (starting at input " << inputSize << ", stride " << detectionStride
+                  << ")" << std::endl;
+    }
     std::cout << "====================================" << std::endl;
     
-    // Initialize video capture
-    cv::VideoCapture cap(videoPath);
-    if (!cap.isOpened()) {
-        std::cerr << "Error: Could not open video file: " << videoPath << std::endl;
+    // Video file, camera, memory-mapped raw video or shared-memory ring
+    std::unique_ptr<FrameSource> source = FrameSource::open(videoPath, readSourceOptions(settings));
+    if (!source->isOpened()) {
+        std::cerr << "Error: Could not open video source: " << videoPath << std::endl;
         return -1;
     }
     
-    int frameWidth = static_cast<int>(cap.get(cv::CAP_PROP_FRAME_WIDTH));
-    int frameHeight = static_cast<int>(cap.get(cv::CAP_PROP_FRAME_HEIGHT));
-    double inputFps = cap.get(cv::CAP_PROP_FPS);
+    int frameWidth = source->getFrameSize().width;
+    int frameHeight = source->getFrameSize().height;
+    double inputFps = source->getFps();
     
     std::cout << "Video resolution: " << frameWidth << "x" << frameHeight << std::endl;
     std::cout << "Input FPS: " << inputFps << std::endl;
     
-    // Initialize video writer
-    cv::VideoWriter writer(outputPath, cv::VideoWriter::fourcc('M','J','P','G'),
-                          inputFps, cv::Size(frameWidth, frameHeight));
+    std::unique_ptr<MetricsExporter> metricsExporter = startMetrics(settings);
     
-    // Initialize detector and tracker
-    YOLODetector detector(modelPath, configPath, classesPath);
-    if (!detector.isLoaded()) {
+    // Output sinks encode and write on their own threads
+    std::vector<std::unique_ptr<OutputSink>> sinks = openSinks(settings, outputPath, inputFps, -1);
+    bool display = settings.getBool("Output", "display", true);
+    bool withTrajectories = display || sinksWantTrajectories(sinks);
+    
+    // Detection cache: reuse the detections of an earlier run on the same
+    // video, model and [Detection] settings, or record them for the next one
+    DetectionCache detectionCache;
+    std::unique_ptr<DetectionCacheWriter> cacheWriter;
+    std::string cacheDirectory = settings.getString("Cache", "detection_dir", "");
+    if (!cacheDirectory.empty() && !source->isLive()) {
+        std::string identity = detectionIdentity(videoPath, modelPath, configPath, settings);
+        uint64_t key = DetectionCache::hashIdentity(identity);
+        std::string cachePath = DetectionCache::cachePath(cacheDirectory, videoPath, key);
+        if (detectionCache.open(cachePath, key)) {
+            std::cout << "Using cached detections: " << cachePath << std::endl;
+        } else if (motionGate.isEnabled() || latencyController.isEnabled()) {
+            std::cout << "Detection cache is not recorded with the motion gate or latency "
+                         "controller on" << std::endl;
+        } else if (detectionStride == 1) {
+            cacheWriter.reset(new DetectionCacheWriter(cachePath, key, identity));
+            std::cout << "Recording detections to: " << cachePath << std::endl;
+        } else {
+            std::cout << "Detection cache is only recorded with skip_frames = 1" << std::endl;
+        }
+    }
+    bool useCache = detectionCache.isOpen();
+    
+    // Initialize detector and tracker; with cached detections the detector
+    // only provides class names
+    std::unique_ptr<YOLODetector> detectorPtr(
+        useCache ? new YOLODetector(classesPath)
+                 : new YOLODetector(modelPath, configPath, classesPath, batchSize,
+                                    readBackendOptions(settings)));
+    YOLODetector& detector = *detectorPtr;
+    if (!useCache && !detector.isLoaded()) {
         std::cerr << "Error: Failed to load YOLO model!" << std::endl;
         return -1;
     }
+    detector.setClassFilter(trackClasses);
+    detector.setNmsOptions(readNmsOptions(settings));
+    detector.setLetterbox(settings.getBool("Detection", "letterbox", false));
+    detector.setInputSize(inputSize);
+    detector.setTiling(readTileOptions(settings));
     
-    Tracker tracker(0.7f, 30, 3);
+    // INT8: calibrate (or reuse the cached calibration) and report the
+    // accuracy cost against FP32
+    Int8Calibrator::Options int8 = readInt8Options(settings);
+    if (int8.enabled && !useCache) {
+        Int8Calibrator calibrator(int8, detectorIdentity(modelPath, configPath, settings));
+        if (calibrator.apply(detector, confThreshold, nmsThreshold)) {
+            calibrator.printReport(std::cout);
+        } else {
+            std::cerr << "INT8 quantization unavailable; running in FP32" << std::endl;
+        }
+    }
+    
+    Tracker tracker(maxIoUDistance, maxAge, minHits);
+    tracker.setTrajectoryPolicy(trajectoryLength, trajectorySampleInterval);
+    OpticalFlowRefiner flowRefiner;
     
     // Generate color palette
     std::vector<cv::Scalar> colors = generateColors(100);
     
-    // Processing loop
-    cv::Mat frame;
-    int frameCount = 0;
-    double totalTime = 0.0;
+    // Pipeline: decode -> detect -> track -> output.
+    // Each stage runs on its own thread (output stays on the main thread for
+    // imshow) and stages are linked by bounded queues, so throughput is set by
+    // the slowest stage and a slow consumer stalls its producers instead of
+    // buffering frames without limit. Every stage is a single FIFO worker, so
+    // frames leave the pipeline in decode order. The output stage only hands
+    // frames to the asynchronous sinks and skips the preview window while
+    // frames are waiting, so encoding and display cannot stall tracking.
+    BoundedQueue<FramePacket> decodedQueue(PIPELINE_QUEUE_CAPACITY);
+    BoundedQueue<FramePacket> detectedQueue(PIPELINE_QUEUE_CAPACITY);
+    BoundedQueue<FramePacket> trackedQueue(PIPELINE_QUEUE_CAPACITY);
+    
+    // Set by the track stage when propagated tracks become unreliable; the
+    // detect stage then runs the detector on the next frame it sees
+    std::atomic<bool> detectionRequested(false);
+    
+    // Current detection stride; the detect stage changes it under a latency budget
+    std::atomic<int> activeStride(detectionStride);
+    
+    // Latest tracked boxes, published by the track stage for the motion
+    // gate. They lag the detect stage by the queued frames, which the
+    // gate's margin covers.
+    std::mutex trackBoxesMutex;
+    std::vector<cv::Rect> latestTrackBoxes;
     
     std::cout << "\nProcessing video..." << std::endl;
     
-    while (cap.read(frame)) {
-        auto startTime = cv::getTickCount();
-        
-        // Detect objects
-        std::vector<Detection> detections = detector.detect(frame, 0.5f, 0.4f);
+    std::thread decodeThread([&]() {
+        int index = 0;
+        while (true) {
+            FramePacket packet;
+            packet.decodeStart = std::chrono::steady_clock::now();
+            ScopedTimer decodeTimer(Metrics::Stage::Decode);
+            if (!source->read(packet.frame)) {
+                break;
+            }
+            decodeTimer.stop();
+            packet.index = index++;
+            if (!decodedQueue.push(std::move(packet))) {
+                break;
+            }
+        }
+        decodedQueue.close();
+    });
+    
+    std::thread detectThread([&]() {
+        // Frames waiting for the current batch, in decode order. Frames that
+        // skip the detector queue up behind pending detector frames so the
+        // output order is preserved.
+        std::vector<FramePacket> pending;
+        std::vector<cv::Mat> batchFrames;
+        std::vector<cv::Rect> trackBoxes;
+        int pendingDetections = 0;
+        bool open = true;
         
-        // Update tracker
-        std::vector<std::shared_ptr<Track>> tracks = tracker.update(detections);
+        // Detector and motion gate time since the last frame, for the
+        // latency controller
+        double workMs = 0.0;
+        auto workSince = [](std::chrono::steady_clock::time_point start) {
+            return std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() - start).count();
+        };
         
-        // Draw results
-        drawTracks(frame, tracks, colors);
+        auto flush = [&]() {
+            // Region frames run on their own, smaller input; the rest (and
+            // regions that would not pack smaller) share the batch
+            auto workStart = std::chrono::steady_clock::now();
+            batchFrames.clear();
+            for (FramePacket& p : pending) {
+                if (p.detected && (p.regions.empty() ||
+                                   !detector.detectRegions(p.frame, p.regions, confThreshold,
+                                                           nmsThreshold, p.detections))) {
+                    p.regions.clear();
+                    batchFrames.push_back(p.frame);
+                }
+            }
+            std::vector<std::vector<Detection>> results;
+            if (batchFrames.size() == 1) {
+                results.push_back(detector.detect(batchFrames[0], confThreshold, nmsThreshold));
+            } else if (!batchFrames.empty()) {
+                results = detector.detectBatch(batchFrames, confThreshold, nmsThreshold);
+            }
+            workMs += workSince(workStart);
+            
+            size_t next = 0;
+            bool ok = true;
+            for (FramePacket& p : pending) {
+                if (p.detected && p.regions.empty()) {
+                    p.detections = std::move(results[next++]);
+                }
+                ok = ok && detectedQueue.push(std::move(p));
+            }
+            pending.clear();
+            pendingDetections = 0;
+            return ok;
+        };
         
-        // Calculate FPS
-        auto endTime = cv::getTickCount();
-        double frameTime = (endTime - startTime) / cv::getTickFrequency();
-        totalTime += frameTime;
-        double fps = 1.0 / frameTime;
+        while (open) {
+            FramePacket packet;
+            bool got = pending.empty()
+                       ? decodedQueue.pop(packet)
+                       : decodedQueue.popFor(packet, std::chrono::milliseconds(batchTimeoutMs));
+            if (!got) {
+                // Timeout with a partial batch, or end of stream
+                open = !pending.empty() && flush();
+                continue;
+            }
+            
+            if (latencyController.isEnabled() && !useCache && latencyController.record(workMs)) {
+                // Frames already batched are detected at the new size
+                const LatencyController::Level& level = latencyController.getLevel();
+                detector.setInputSize(level.inputSize);
+                activeStride = level.stride;
+                std::cout << "Latency controller: input " << level.inputSize << ", stride "
+                          << level.stride << std::endl;
+            }
+            workMs = 0.0;
+            
+            bool requested = detectionRequested.exchange(false);
+            packet.detected = packet.index % activeStride == 0 || requested;
+            if (packet.detected && motionGate.isEnabled() && !useCache) {
+                {
+                    std::lock_guard<std::mutex> lock(trackBoxesMutex);
+                    trackBoxes = latestTrackBoxes;
+                }
+                auto workStart = std::chrono::steady_clock::now();
+                packet.detected = motionGate.analyze(packet.frame, trackBoxes, requested,
+                                                     packet.regions) != MotionGate::Decision::Skip;
+                workMs += workSince(workStart);
+            }
+            if (useCache) {
+                // Frames past the end of the cache are propagated
+                packet.detected = packet.detected &&
+                                  detectionCache.getFrame(packet.index, packet.detections);
+                open = detectedQueue.push(std::move(packet));
+                continue;
+            }
+            if (!packet.detected && pending.empty()) {
+                open = detectedQueue.push(std::move(packet));
+                continue;
+            }
+            
+            pendingDetections += packet.detected ? 1 : 0;
+            pending.push_back(std::move(packet));
+            if (pendingDetections >= batchSize) {
+                open = flush();
+            }
+        }
+        detectedQueue.close();
+    });
+    
+    std::thread trackThread([&]() {
+        FramePacket packet;
+        auto className = [&detector](int classId) -> const std::string& {
+            return detector.getClassName(classId);
+        };
+        BoxRefiner refiner = [&flowRefiner](const cv::Rect& previous, cv::Rect& refined) {
+            return flowRefiner.refine(previous, refined);
+        };
         
-        // Display stats
-        displayStats(frame, frameCount + 1, fps, tracks.size());
+        while (detectedQueue.pop(packet)) {
+            if (cacheWriter) {
+                cacheWriter->append(packet.detected, packet.detections);
+            }
+            if (useOpticalFlow) {
+                flowRefiner.setFrame(packet.frame);
+            }
+            
+            const std::vector<Track>& tracks = packet.detected
+                ? tracker.update(packet.detections)
+                : tracker.propagate(useOpticalFlow ? refiner : nullptr);
+            
+            if ((activeStride > 1 || motionGate.isEnabled()) && adaptiveDetection &&
+                tracker.isUncertain(maxTrackDrift)) {
+                detectionRequested = true;
+            }
+            if (motionGate.isEnabled()) {
+                std::lock_guard<std::mutex> lock(trackBoxesMutex);
+                latestTrackBoxes.clear();
+                for (const Track& track : tracks) {
+                    latestTrackBoxes.push_back(track.getCurrentBbox());
+                }
+            }
+            
+            // The output stage needs its own copy of the tracks
+            copyTracks(tracks, className, withTrajectories, packet.tracks);
+            
+            if (!trackedQueue.push(std::move(packet))) {
+                break;
+            }
+        }
+        trackedQueue.close();
+    });
+    
+    // Output stage
+    FramePacket packet;
+    FrameResult result;
+    cv::Mat preview;
+    int frameCount = 0;
+    auto startTime = cv::getTickCount();
+    auto lastTime = startTime;
+    double totalTime = 0.0;
+    bool userExit = false;
+    
+    while (trackedQueue.pop(packet)) {
+        // Pipeline throughput: time between consecutive output frames
+        auto now = cv::getTickCount();
+        double frameTime = (now - lastTime) / cv::getTickFrequency();
+        lastTime = now;
+        totalTime = (now - startTime) / cv::getTickFrequency();
         
-        // Write frame
-        writer.write(frame);
+        result.index = packet.index;
+        result.frame = packet.frame;
+        result.tracks = std::move(packet.tracks);
+        result.fps = frameTime > 0.0 ? 1.0 / frameTime : 0.0;
         
-        // Display frame
-        cv::imshow("Multi-Object Tracking", frame);
+        for (auto& sink : sinks) {
+            sink->write(result);
+        }
+        Metrics::global().recordLatency(Metrics::Stage::EndToEnd, static_cast<uint64_t>(
+            std::chrono::duration_cast<std::chrono::nanoseconds>(
+                std::chrono::steady_clock::now() - packet.decodeStart).count()));
         
         frameCount++;
         
@@ -161,17 +909,51 @@ int main(int argc, char** argv) {
                      << "Average FPS: " << frameCount / totalTime << std::endl;
         }
         
-        // Exit on 'q' key
-        if (cv::waitKey(1) == 'q') {
-            std::cout << "User requested exit." << std::endl;
-            break;
+        // Preview only when caught up; the frame is shared with the sinks
+        if (display && trackedQueue.size() == 0) {
+            ScopedTimer renderTimer(Metrics::Stage::Render);
+            result.frame.copyTo(preview);
+            drawTracks(preview, result.tracks, colors);
+            displayStats(preview, result.index + 1, result.fps, result.tracks.size());
+            renderTimer.stop();
+            cv::imshow("Multi-Object Tracking", preview);
+            
+            // Exit on 'q' key
+            if (cv::waitKey(1) == 'q') {
+                std::cout << "User requested exit." << std::endl;
+                userExit = true;
+                break;
+            }
         }
     }
     
-    // Cleanup
-    cap.release();
-    writer.release();
-    cv::destroyAllWindows();
+    // Unblock and stop the upstream stages
+    source->interrupt();
+    decodedQueue.close();
+    detectedQueue.close();
+    trackedQueue.close();
+    decodeThread.join();
+    detectThread.join();
+    trackThread.join();
+    
+    // Only a run that saw the whole video leaves a complete cache; otherwise
+    // the writer deletes its partial file
+    if (cacheWriter && !userExit) {
+        cacheWriter->finish();
+    }
+    cacheWriter.reset();
+    
+    // Cleanup: closing a sink drains its queue
+    for (auto& sink : sinks) {
+        sink->close();
+    }
+    // Frames may be views of the source's memory; release it last
+    result.frame.release();
+    int64_t droppedFrames = source->getDropped();
+    source.reset();
+    if (display) {
+        cv::destroyAllWindows();
+    }
     
     // Print final statistics
     std::cout << "\n=== Processing Complete ===" << std::endl;
@@ -179,7 +961,23 @@ int main(int argc, char** argv) {
     std::cout << "Total time: " << totalTime << " seconds" << std::endl;
     std::cout << "Average FPS: " << (frameCount / totalTime) << std::endl;
     std::cout << "Total unique tracks: " << tracker.getTotalTracks() - 1 << std::endl;
-    std::cout << "Output saved to: " << outputPath << std::endl;
+    if (droppedFrames > 0) {
+        std::cout << "Frames skipped by the source: " << droppedFrames << std::endl;
+    }
+    if (latencyController.isEnabled()) {
+        std::cout << "Latency controller: " << latencyController.getChanges()
+                  << " level changes, ending at input " << latencyController.getLevel().inputSize
+                  << ", stride " << latencyController.getLevel().stride << std::endl;
+    }
+    if (motionGate.isEnabled()) {
+        const MotionGate::Stats& gateStats = motionGate.getStats();
+        std::cout << "Motion gate: " << gateStats.skipped << " skipped, " << gateStats.regions
+                  << " region, " << gateStats.fullFrames << " full-frame detections" << std::endl;
+    }
+    finishMetrics(metricsExporter);
+    if (settings.getBool("Output", "video", true)) {
+        std::cout << "Output saved to: " << outputPath << std::endl;
+    }
     
     return 0;
 }
@@ -0,0 +1,86 @@
+#include <opencv2/opencv.hpp>
+#include <chrono>
+#include <cstdlib>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <thread>
+#include "FrameSource.h"
+#include "SharedMemoryRing.h"
+
+// Reference producer for mot_tracker's shared-memory input: decodes a video
+// (or camera) once and publishes the frames to a ring that mot_tracker reads
+// with source "shm:<name>".
+//
+//   frame_producer data/test.mp4 mot_ring --blocking &
+//   ./build/mot_tracker shm:mot_ring
+//
+// --blocking: wait for the consumer, lose no frames (offline files)
+// --realtime: publish at the source frame rate (emulates a camera)
+
+static void printUsage() {
+    std::cerr << "Usage: frame_producer <source> <ring name> [--slots <n>] [--blocking]\n"
+                 "                      [--realtime]\n";
+}
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        printUsage();
+        return 1;
+    }
+    std::string sourcePath = argv[1];
+    std::string ringName = argv[2];
+    int slots = 64;
+    bool blocking = false;
+    bool realtime = false;
+
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        if (arg == "--slots" && i + 1 < argc) {
+            slots = std::atoi(argv[++i]);
+        } else if (arg == "--blocking") {
+            blocking = true;
+        } else if (arg == "--realtime") {
+            realtime = true;
+        } else {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    std::unique_ptr<FrameSource> source = FrameSource::open(sourcePath);
+    if (!source->isOpened()) {
+        std::cerr << "Error: Could not open video source: " << sourcePath << std::endl;
+        return 1;
+    }
+    double fps = source->getFps();
+
+    SharedMemoryFrameWriter ring(ringName, source->getFrameSize(), fps, slots, blocking);
+    if (!ring.isOpen()) {
+        return 1;
+    }
+    cv::Size size = source->getFrameSize();
+    std::cerr << "Publishing " << size.width << "x" << size.height << " frames to shm:" << ringName
+              << " (" << slots << " slots" << (blocking ? ", blocking" : "") << ")" << std::endl;
+
+    auto period = std::chrono::duration<double>(realtime && fps > 0.0 ? 1.0 / fps : 0.0);
+    auto nextFrame = std::chrono::steady_clock::now();
+    cv::Mat frame;
+    int64_t frames = 0;
+    while (source->read(frame)) {
+        if (!ring.write(frame)) {
+            std::cerr << "Error: Frame does not match the ring format" << std::endl;
+            break;
+        }
+        frames++;
+        if (realtime) {
+            nextFrame += std::chrono::duration_cast<std::chrono::steady_clock::duration>(period);
+            std::this_thread::sleep_until(nextFrame);
+        }
+    }
+    ring.close();
+    // An attached consumer keeps its mapping and drains the ring after the
+    // name is removed on exit
+    std::cerr << "Published " << frames << " frames" << std::endl;
+    return 0;
+}
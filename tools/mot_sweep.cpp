@@ -0,0 +1,443 @@
+#include <opencv2/opencv.hpp>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <fstream>
+#include <iomanip>
+#include <iostream>
+#include <memory>
+#include <string>
+#include <vector>
+#include "Config.h"
+#include "FrameSource.h"
+#include "Metrics.h"
+#include "MotEvaluator.h"
+#include "Tracker.h"
+#include "YOLODetector.h"
+
+// Speed/accuracy sweep over a labelled sequence.
+//
+// The grid comes from the [Sweep] section of the settings file; every other
+// section is read as in config.txt and supplies the fixed settings:
+//
+//   [Sweep]
+//   input_size = [320, 416, 608]
+//   confidence_threshold = [0.3, 0.5]
+//   nms_threshold = [0.4]
+//   skip_frames = [1, 2, 4]
+//   max_iou_distance = [0.7]
+//   max_age = [30]
+//   min_hits = [3]
+//   gt_classes = [1]          # gt.txt classes scored (MOTChallenge: 1 = pedestrian)
+//
+// The video is decoded and run through the network once per input size. The
+// raw outputs of each frame are decoded for every (confidence, NMS)
+// combination, and each resulting detection sequence is replayed through the
+// tracker for every stride and tracker setting. Frame rates are therefore
+// modeled from measured stage latencies rather than timed end to end:
+//
+//   serial ms/frame = decode + detected fraction x (preprocess + forward +
+//                     post-processing) + tracking
+//   pipeline fps    = 1000 / slowest of those three stages (the threaded
+//                     pipeline overlaps them)
+
+namespace {
+
+using Clock = std::chrono::steady_clock;
+
+struct SweepGrid {
+    std::vector<int> inputSizes;
+    std::vector<float> confThresholds;
+    std::vector<float> nmsThresholds;
+    std::vector<int> strides;
+    std::vector<float> maxIoUDistances;
+    std::vector<int> maxAges;
+    std::vector<int> minHits;
+};
+
+struct SweepResult {
+    int inputSize = 0;
+    float confThreshold = 0.0f;
+    float nmsThreshold = 0.0f;
+    int stride = 1;
+    float maxIoUDistance = 0.0f;
+    int maxAge = 0;
+    int minHits = 0;
+
+    // Milliseconds per frame; detector stages per detected frame
+    double decodeMs = 0.0;
+    double preprocessMs = 0.0;
+    double forwardMs = 0.0;
+    double forwardP95Ms = 0.0;
+    double postprocessMs = 0.0;
+    double trackMs = 0.0;
+    double trackP95Ms = 0.0;
+    double detectedFraction = 0.0;
+    double serialFps = 0.0;
+    double pipelineFps = 0.0;
+
+    MotEvaluator::Summary accuracy;
+    bool pareto = false;
+};
+
+double toMs(uint64_t nanoseconds) {
+    return nanoseconds * 1e-6;
+}
+
+uint64_t elapsedNs(Clock::time_point start) {
+    return static_cast<uint64_t>(
+        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - start).count());
+}
+
+template <typename T>
+std::vector<T> orDefault(std::vector<T> values, T fallback) {
+    if (values.empty()) {
+        values.push_back(fallback);
+    }
+    return values;
+}
+
+SweepGrid readGrid(const Config& settings) {
+    SweepGrid grid;
+    grid.inputSizes = orDefault(settings.getIntList("Sweep", "input_size"),
+                                settings.getInt("Detection", "input_size", 416));
+    grid.confThresholds = orDefault(settings.getFloatList("Sweep", "confidence_threshold"),
+                                    settings.getFloat("Detection", "confidence_threshold", 0.5f));
+    grid.nmsThresholds = orDefault(settings.getFloatList("Sweep", "nms_threshold"),
+                                   settings.getFloat("Detection", "nms_threshold", 0.4f));
+    grid.strides = orDefault(settings.getIntList("Sweep", "skip_frames"),
+                             settings.getInt("Performance", "skip_frames", 1));
+    grid.maxIoUDistances = orDefault(settings.getFloatList("Sweep", "max_iou_distance"),
+                                     settings.getFloat("Tracking", "max_iou_distance", 0.7f));
+    grid.maxAges = orDefault(settings.getIntList("Sweep", "max_age"),
+                             settings.getInt("Tracking", "max_age", 30));
+    grid.minHits = orDefault(settings.getIntList("Sweep", "min_hits"),
+                             settings.getInt("Tracking", "min_hits", 3));
+    return grid;
+}
+
+// Replays one detection sequence through a tracker and scores it
+void replay(const std::vector<std::vector<Detection>>& detections, const Config& settings,
+            MotEvaluator& evaluator, SweepResult& result) {
+    bool adaptiveDetection = settings.getBool("Performance", "adaptive_detection", true);
+    float maxTrackDrift = settings.getFloat("Performance", "max_track_drift", 0.5f);
+
+    Tracker tracker(result.maxIoUDistance, result.maxAge, result.minHits);
+    evaluator.reset();
+    Histogram trackTimes;
+    int detectedFrames = 0;
+    bool detectionRequested = false;
+
+    for (size_t index = 0; index < detections.size(); ++index) {
+        bool detected = index % result.stride == 0 || detectionRequested;
+        detectionRequested = false;
+
+        Clock::time_point start = Clock::now();
+        const std::vector<Track>& tracks = detected ? tracker.update(detections[index])
+                                                    : tracker.propagate(nullptr);
+        if (result.stride > 1 && adaptiveDetection && tracker.isUncertain(maxTrackDrift)) {
+            detectionRequested = true;
+        }
+        trackTimes.record(elapsedNs(start));
+
+        detectedFrames += detected ? 1 : 0;
+        evaluator.addFrame(static_cast<int>(index), tracks);
+    }
+
+    Histogram::Summary track = trackTimes.summarize();
+    result.trackMs = toMs(static_cast<uint64_t>(track.mean()));
+    result.trackP95Ms = toMs(track.p95);
+    result.detectedFraction = detections.empty() ? 0.0
+                              : static_cast<double>(detectedFrames) / detections.size();
+    result.accuracy = evaluator.summarize();
+
+    double detectMs = result.preprocessMs + result.forwardMs + result.postprocessMs;
+    double serialMs = result.decodeMs + result.detectedFraction * detectMs + result.trackMs;
+    double slowestMs = std::max({result.decodeMs, result.detectedFraction * detectMs, result.trackMs});
+    result.serialFps = serialMs > 0.0 ? 1000.0 / serialMs : 0.0;
+    result.pipelineFps = slowestMs > 0.0 ? 1000.0 / slowestMs : 0.0;
+}
+
+// Runs the grid; returns false if the video or model cannot be opened
+bool runSweep(const std::string& videoPath, const std::string& modelPath,
+              const std::string& configPath, const std::string& classesPath,
+              const Config& settings, int maxFrames, MotEvaluator& evaluator,
+              std::vector<SweepResult>& results) {
+    SweepGrid grid = readGrid(settings);
+
+    InferenceBackend::Options backendOptions;
+    backendOptions.name = settings.getString("Detection", "backend", "opencv");
+    backendOptions.intraOpThreads = settings.getInt("Detection", "intra_op_threads", 0);
+    backendOptions.interOpThreads = settings.getInt("Detection", "inter_op_threads", 0);
+    YOLODetector detector(modelPath, configPath, classesPath, 1, backendOptions);
+    if (!detector.isLoaded()) {
+        std::cerr << "Error: Failed to load YOLO model!" << std::endl;
+        return false;
+    }
+    detector.setClassFilter(settings.getIntList("Classes", "track_classes"));
+    NonMaxSuppressor::Options nmsOptions;
+    nmsOptions.mode = NonMaxSuppressor::parseMode(settings.getString("Detection", "nms_mode", "per_class"));
+    nmsOptions.topK = settings.getInt("Detection", "nms_top_k", 0);
+    nmsOptions.maxDetections = settings.getInt("Detection", "max_detections", 0);
+    nmsOptions.useGrid = settings.getBool("Detection", "nms_grid", false);
+    detector.setNmsOptions(nmsOptions);
+    detector.setLetterbox(settings.getBool("Detection", "letterbox", false));
+
+    // The detector's stage timers report through the global metrics
+    Metrics& metrics = Metrics::global();
+    metrics.setEnabled(true);
+
+    FrameSource::Options sourceOptions;
+    sourceOptions.rawWidth = settings.getInt("Input", "raw_width", 0);
+    sourceOptions.rawHeight = settings.getInt("Input", "raw_height", 0);
+    sourceOptions.rawFps = settings.getFloat("Input", "raw_fps", 0.0f);
+
+    size_t combinations = grid.confThresholds.size() * grid.nmsThresholds.size();
+    for (int inputSize : grid.inputSizes) {
+        std::unique_ptr<FrameSource> capture = FrameSource::open(videoPath, sourceOptions);
+        if (!capture->isOpened() || capture->isLive()) {
+            std::cerr << "Error: Could not open video (live sources cannot be swept): " << videoPath << std::endl;
+            return false;
+        }
+        detector.setInputSize(inputSize);
+        metrics.reset();
+
+        std::vector<std::vector<std::vector<Detection>>> sequences(combinations);
+        std::vector<Histogram> postprocessTimes(combinations);
+        Histogram decodeTimes;
+        cv::Mat frame;
+        int frames = 0;
+
+        while (maxFrames <= 0 || frames < maxFrames) {
+            Clock::time_point start = Clock::now();
+            if (!capture->read(frame)) {
+                break;
+            }
+            decodeTimes.record(elapsedNs(start));
+
+            // One forward pass; every threshold combination decodes its outputs
+            detector.detect(frame, grid.confThresholds[0], grid.nmsThresholds[0]);
+            size_t combination = 0;
+            for (float conf : grid.confThresholds) {
+                for (float nms : grid.nmsThresholds) {
+                    start = Clock::now();
+                    sequences[combination].push_back(
+                        detector.decode(detector.getLastOutputs(), frame.size(), conf, nms));
+                    postprocessTimes[combination].record(elapsedNs(start));
+                    combination++;
+                }
+            }
+
+            frames++;
+            if (frames % 100 == 0) {
+                std::cerr << "input " << detector.getInputSize() << ": " << frames << " frames\r"
+                          << std::flush;
+            }
+        }
+        std::cerr << "input " << detector.getInputSize() << ": " << frames << " frames" << std::endl;
+
+        Histogram::Summary forward = metrics.getLatency(Metrics::Stage::Forward).summarize();
+        SweepResult base;
+        base.inputSize = detector.getInputSize();
+        base.decodeMs = toMs(static_cast<uint64_t>(decodeTimes.summarize().mean()));
+        base.preprocessMs = toMs(static_cast<uint64_t>(
+            metrics.getLatency(Metrics::Stage::Preprocess).summarize().mean()));
+        base.forwardMs = toMs(static_cast<uint64_t>(forward.mean()));
+        base.forwardP95Ms = toMs(forward.p95);
+
+        size_t combination = 0;
+        for (float conf : grid.confThresholds) {
+            for (float nms : grid.nmsThresholds) {
+                SweepResult detectorResult = base;
+                detectorResult.confThreshold = conf;
+                detectorResult.nmsThreshold = nms;
+                detectorResult.postprocessMs = toMs(static_cast<uint64_t>(
+                    postprocessTimes[combination].summarize().mean()));
+
+                for (int stride : grid.strides) {
+                    for (float maxIoUDistance : grid.maxIoUDistances) {
+                        for (int maxAge : grid.maxAges) {
+                            for (int minHits : grid.minHits) {
+                                SweepResult result = detectorResult;
+                                result.stride = std::max(1, stride);
+                                result.maxIoUDistance = maxIoUDistance;
+                                result.maxAge = maxAge;
+                                result.minHits = minHits;
+                                replay(sequences[combination], settings, evaluator, result);
+                                results.push_back(result);
+                            }
+                        }
+                    }
+                }
+                combination++;
+            }
+        }
+    }
+    return true;
+}
+
+// True if a is at least as good as b in speed, MOTA and IDF1 and better in one
+bool dominates(const SweepResult& a, const SweepResult& b) {
+    bool noWorse = a.serialFps >= b.serialFps && a.accuracy.mota >= b.accuracy.mota &&
+                   a.accuracy.idf1 >= b.accuracy.idf1;
+    bool better = a.serialFps > b.serialFps || a.accuracy.mota > b.accuracy.mota ||
+                  a.accuracy.idf1 > b.accuracy.idf1;
+    return noWorse && better;
+}
+
+void markPareto(std::vector<SweepResult>& results) {
+    for (auto& candidate : results) {
+        candidate.pareto = std::none_of(results.begin(), results.end(),
+            [&candidate](const SweepResult& other) { return dominates(other, candidate); });
+    }
+}
+
+void writeCsv(std::ostream& out, const std::vector<SweepResult>& results) {
+    out << "input_size,confidence_threshold,nms_threshold,skip_frames,max_iou_distance,max_age,"
+           "min_hits,decode_ms,preprocess_ms,forward_ms,forward_p95_ms,postprocess_ms,track_ms,"
+           "track_p95_ms,detected_fraction,serial_fps,pipeline_fps,mota,motp,idf1,idp,idr,"
+           "id_switches,false_positives,misses,pareto\n";
+    out << std::fixed << std::setprecision(4);
+    for (const auto& r : results) {
+        const MotEvaluator::Summary& a = r.accuracy;
+        out << r.inputSize << "," << r.confThreshold << "," << r.nmsThreshold << "," << r.stride
+            << "," << r.maxIoUDistance << "," << r.maxAge << "," << r.minHits << ","
+            << r.decodeMs << "," << r.preprocessMs << "," << r.forwardMs << "," << r.forwardP95Ms
+            << "," << r.postprocessMs << "," << r.trackMs << "," << r.trackP95Ms << ","
+            << r.detectedFraction << "," << r.serialFps << "," << r.pipelineFps << ","
+            << a.mota << "," << a.motp << "," << a.idf1 << "," << a.idPrecision << ","
+            << a.idRecall << "," << a.idSwitches << "," << a.falsePositives << "," << a.misses
+            << "," << (r.pareto ? 1 : 0) << "\n";
+    }
+    out << std::defaultfloat;
+}
+
+// Markdown table of the Pareto front, fastest first
+void printParetoTable(std::ostream& out, const std::vector<SweepResult>& results) {
+    out << "| input | conf | nms | stride | iou | age | hits | fwd ms | fwd p95 | track ms "
+           "| fps | pipeline fps | MOTA | IDF1 | IDSW |\n"
+        << "|---:|---:|---:|---:|---:|---:|---:|---:|---:|---:|---:|---:|---:|---:|---:|\n";
+    out << std::fixed;
+    for (const auto& r : results) {
+        if (!r.pareto) {
+            continue;
+        }
+        out << "| " << r.inputSize << std::setprecision(2) << " | " << r.confThreshold
+            << " | " << r.nmsThreshold << " | " << r.stride << " | " << r.maxIoUDistance
+            << " | " << r.maxAge << " | " << r.minHits << " | " << r.forwardMs << " | "
+            << r.forwardP95Ms << " | " << std::setprecision(3) << r.trackMs << " | "
+            << std::setprecision(1) << r.serialFps << " | " << r.pipelineFps << " | "
+            << std::setprecision(3) << r.accuracy.mota << " | " << r.accuracy.idf1 << " | "
+            << r.accuracy.idSwitches << " |\n";
+    }
+    out << std::defaultfloat;
+}
+
+void printUsage() {
+    std::cerr << "Usage: mot_sweep <video> <gt.txt> [--settings <file>] [--model <weights>]\n"
+                 "                 [--cfg <cfg>] [--classes <names>] [--frames <n>]\n"
+                 "                 [--csv <file>] [--min-mota <x>] [--min-idf1 <x>]\n"
+                 "The grid is read from the [Sweep] section of the settings file\n"
+                 "(default: config.txt).\n";
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    if (argc < 3) {
+        printUsage();
+        return 1;
+    }
+    std::string videoPath = argv[1];
+    std::string groundTruthPath = argv[2];
+    std::string settingsPath = "config.txt";
+    std::string modelPath = "models/yolov4-tiny.weights";
+    std::string configPath = "models/yolov4-tiny.cfg";
+    std::string classesPath = "models/coco.names";
+    std::string csvPath;
+    int maxFrames = 0;
+    double minMota = -1e9;
+    double minIdf1 = -1e9;
+
+    for (int i = 3; i < argc; ++i) {
+        std::string arg = argv[i];
+        bool hasValue = i + 1 < argc;
+        if (arg == "--settings" && hasValue) {
+            settingsPath = argv[++i];
+        } else if (arg == "--model" && hasValue) {
+            modelPath = argv[++i];
+        } else if (arg == "--cfg" && hasValue) {
+            configPath = argv[++i];
+        } else if (arg == "--classes" && hasValue) {
+            classesPath = argv[++i];
+        } else if (arg == "--frames" && hasValue) {
+            maxFrames = std::atoi(argv[++i]);
+        } else if (arg == "--csv" && hasValue) {
+            csvPath = argv[++i];
+        } else if (arg == "--min-mota" && hasValue) {
+            minMota = std::atof(argv[++i]);
+        } else if (arg == "--min-idf1" && hasValue) {
+            minIdf1 = std::atof(argv[++i]);
+        } else {
+            printUsage();
+            return arg == "--help" ? 0 : 1;
+        }
+    }
+
+    Config settings;
+    if (!settings.load(settingsPath)) {
+        std::cerr << "Settings file not found, using defaults: " << settingsPath << std::endl;
+    }
+
+    MotEvaluator evaluator;
+    std::vector<int> groundTruthClasses = settings.getIntList("Sweep", "gt_classes");
+    if (!evaluator.loadGroundTruth(groundTruthPath,
+                                   groundTruthClasses.empty() ? std::vector<int>{1} : groundTruthClasses)) {
+        std::cerr << "Error: Could not read ground truth: " << groundTruthPath << std::endl;
+        return 1;
+    }
+
+    std::vector<SweepResult> results;
+    if (!runSweep(videoPath, modelPath, configPath, classesPath, settings, maxFrames,
+                  evaluator, results)) {
+        return 1;
+    }
+
+    markPareto(results);
+    std::stable_sort(results.begin(), results.end(), [](const SweepResult& a, const SweepResult& b) {
+        return a.serialFps > b.serialFps;
+    });
+
+    std::cout << "\n=== Pareto Front (" << results.size() << " configurations) ===\n\n";
+    printParetoTable(std::cout, results);
+
+    // Fastest configuration meeting the accuracy floor (results are sorted)
+    if (minMota > -1e9 || minIdf1 > -1e9) {
+        auto best = std::find_if(results.begin(), results.end(), [&](const SweepResult& r) {
+            return r.accuracy.mota >= minMota && r.accuracy.idf1 >= minIdf1;
+        });
+        if (best == results.end()) {
+            std::cout << "\nNo configuration meets the accuracy floor." << std::endl;
+        } else {
+            std::cout << "\nFastest configuration meeting the floor: input_size = " << best->inputSize
+                      << ", confidence_threshold = " << best->confThreshold
+                      << ", nms_threshold = " << best->nmsThreshold
+                      << ", skip_frames = " << best->stride
+                      << ", max_iou_distance = " << best->maxIoUDistance
+                      << ", max_age = " << best->maxAge << ", min_hits = " << best->minHits
+                      << " (" << best->serialFps << " fps, MOTA " << best->accuracy.mota
+                      << ", IDF1 " << best->accuracy.idf1 << ")" << std::endl;
+        }
+    }
+
+    if (!csvPath.empty()) {
+        std::ofstream csv(csvPath);
+        if (!csv.is_open()) {
+            std::cerr << "Error: Could not write " << csvPath << std::endl;
+            return 1;
+        }
+        writeCsv(csv, results);
+        std::cerr << "All configurations written to " << csvPath << std::endl;
+    }
+    return 0;
+}